@@ -101,6 +101,13 @@ ADCSensor::~ADCSensor()
     objServer.remove_interface(association);
 }
 
+void ADCSensor::updateScaleFactor(double newScaleFactor, double maxReading,
+                                  double minReading)
+{
+    scaleFactor = newScaleFactor;
+    updateRange(maxReading / scaleFactor, minReading / scaleFactor);
+}
+
 void ADCSensor::setupRead()
 {
     std::shared_ptr<boost::asio::streambuf> buffer =
@@ -127,6 +134,7 @@ void ADCSensor::setupRead()
 
             if (self)
             {
+                self->markReadStarted();
                 boost::asio::async_read_until(
                     self->inputDev, *buffer, '\n',
                     [weakRef, buffer](const boost::system::error_code& ec,
@@ -143,6 +151,7 @@ void ADCSensor::setupRead()
     }
     else
     {
+        markReadStarted();
         boost::asio::async_read_until(
             inputDev, *buffer, '\n',
             [weakRef, buffer](const boost::system::error_code& ec,
@@ -205,7 +214,8 @@ void ADCSensor::handleResponse(const boost::system::error_code& err)
         return; // we're no longer valid
     }
     inputDev.assign(fd);
-    waitTimer.expires_after(std::chrono::milliseconds(sensorPollMs));
+    waitTimer.expires_after(
+        std::chrono::milliseconds(nextPollMs(sensorPollMs)));
     waitTimer.async_wait([weakRef](const boost::system::error_code& ec) {
         std::shared_ptr<ADCSensor> self = weakRef.lock();
         if (ec == boost::asio::error::operation_aborted)
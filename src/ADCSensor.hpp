@@ -1,5 +1,6 @@
 #pragma once
 
+#include "PollScheduler.hpp"
 #include "Thresholds.hpp"
 #include "sensor.hpp"
 
@@ -78,10 +79,15 @@ class ADCSensor : public Sensor, public std::enable_shared_from_this<ADCSensor>
     ~ADCSensor() override;
     void setupRead();
 
+    // Takes a new scale factor, with the unscaled reading range it applies
+    // to, without rebuilding the sensor
+    void updateScaleFactor(double newScaleFactor, double maxReading,
+                           double minReading);
+
   private:
     sdbusplus::asio::object_server& objServer;
     boost::asio::posix::stream_descriptor inputDev;
-    boost::asio::steady_timer waitTimer;
+    PollTimer waitTimer;
     std::shared_ptr<boost::asio::streambuf> readBuf;
     std::string path;
     double scaleFactor;
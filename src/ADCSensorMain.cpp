@@ -15,6 +15,10 @@
 */
 
 #include "ADCSensor.hpp"
+#include "AdaptivePoll.hpp"
+#include "ConfigReconcile.hpp"
+#include "ConfigurationMirror.hpp"
+#include "SensorHost.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
 #include "VariantVisitors.hpp"
@@ -64,6 +68,10 @@ static std::regex inputRegex(R"(in(\d+)_input)");
 
 static boost::container::flat_map<size_t, bool> cpuPresence;
 
+// Configuration the sensors were last built from. A new ScaleFactor is
+// applied to the running sensor.
+static ConfigReconciler configReconciler({"ScaleFactor"});
+
 enum class UpdateType
 {
     init,
@@ -71,7 +79,7 @@ enum class UpdateType
 };
 
 // filter out adc from any other voltage sensor
-bool isAdc(const fs::path& parentPath)
+static bool isAdc(const fs::path& parentPath)
 {
     fs::path namePath = parentPath / "name";
 
@@ -88,7 +96,53 @@ bool isAdc(const fs::path& parentPath)
     return name == "iio_hwmon" || name == "tps53679";
 }
 
-void createSensors(
+static double getScaleFactor(const SensorBaseConfigMap& baseConfigMap)
+{
+    auto findScaleFactor = baseConfigMap.find("ScaleFactor");
+    float scaleFactor = 1.0;
+    if (findScaleFactor != baseConfigMap.end())
+    {
+        scaleFactor = std::visit(VariantToFloatVisitor(),
+                                 findScaleFactor->second);
+        // scaleFactor is used in division
+        if (scaleFactor == 0.0F)
+        {
+            scaleFactor = 1.0;
+        }
+    }
+    return scaleFactor;
+}
+
+static void getReadingRange(const SensorData& sensorData, double& maxValue,
+                            double& minValue)
+{
+    maxValue = maxVoltageReading;
+    minValue = minVoltageReading;
+    paramMap sensorParamMap;
+    parseSensorParamFromConfig(sensorData, sensorParamMap);
+    getSensorParamMapValues(maxValue, minValue, sensorParamMap);
+}
+
+// Applies a configuration that only changed in the thresholds or the scale
+// factor of sensor, see ConfigReconciler::canUpdate(). False if the sensor
+// has to be rebuilt after all.
+static bool updateSensor(ADCSensor& sensor, const SensorData& sensorData,
+                         const SensorBaseConfigMap& baseConfigMap)
+{
+    std::vector<thresholds::Threshold> sensorThresholds;
+    if (!parseThresholdsFromConfig(sensorData, sensorThresholds))
+    {
+        return false;
+    }
+    double maxValue = 0;
+    double minValue = 0;
+    getReadingRange(sensorData, maxValue, minValue);
+    sensor.updateScaleFactor(getScaleFactor(baseConfigMap), maxValue,
+                             minValue);
+    return sensor.updateThresholds(std::move(sensorThresholds));
+}
+
+static void createSensors(
     boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
     boost::container::flat_map<std::string, std::shared_ptr<ADCSensor>>&
         sensors,
@@ -100,8 +154,18 @@ void createSensors(
     auto getter = std::make_shared<GetSensorConfiguration>(
         dbusConnection,
         [&io, &objectServer, &sensors, &dbusConnection, sensorsChanged,
-         updateType](const ManagedObjectType& sensorConfigurations) {
+         updateType](const ManagedObjectType& sensorConfigurations,
+                     bool incomplete) {
         bool firstScan = sensorsChanged == nullptr;
+
+        // Which sensors to rebuild or remove follows from the configuration
+        // itself, the signalled paths only triggered the rescan
+        configReconciler.update(sensorConfigurations, incomplete);
+        configReconciler.removeSensors(sensors);
+        if (!firstScan)
+        {
+            sensorsChanged->clear();
+        }
         std::vector<fs::path> paths;
         if (!findFiles(fs::path("/sys/class/hwmon"), R"(in\d+_input)", paths))
         {
@@ -196,27 +260,19 @@ void createSensors(
             std::string sensorName =
                 std::get<std::string>(findSensorName->second);
 
-            // on rescans, only update sensors we were signaled by
+            // on rescans, only rebuild sensors whose configuration changed
             auto findSensor = sensors.find(sensorName);
             if (!firstScan && findSensor != sensors.end())
             {
-                bool found = false;
-                for (auto it = sensorsChanged->begin();
-                     it != sensorsChanged->end(); it++)
-                {
-                    if (findSensor->second &&
-                        it->ends_with(findSensor->second->name))
-                    {
-                        sensorsChanged->erase(it);
-                        findSensor->second = nullptr;
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found)
+                if (findSensor->second != nullptr &&
+                    (!configReconciler.needsRebuild(*interfacePath) ||
+                     (configReconciler.canUpdate(*interfacePath) &&
+                      updateSensor(*findSensor->second, *sensorData,
+                                   baseConfiguration->second))))
                 {
                     continue;
                 }
+                findSensor->second = nullptr;
             }
 
             auto findCPU = baseConfiguration->second.find("CPURequired");
@@ -246,27 +302,17 @@ void createSensors(
                           << "\n";
             }
 
-            auto findScaleFactor =
-                baseConfiguration->second.find("ScaleFactor");
-            float scaleFactor = 1.0;
-            if (findScaleFactor != baseConfiguration->second.end())
-            {
-                scaleFactor = std::visit(VariantToFloatVisitor(),
-                                         findScaleFactor->second);
-                // scaleFactor is used in division
-                if (scaleFactor == 0.0F)
-                {
-                    scaleFactor = 1.0;
-                }
-            }
-            double maxValue = maxVoltageReading;
-            double minValue = minVoltageReading;
-            paramMap sensorParamMap;
-            parseSensorParamFromConfig(*sensorData, sensorParamMap);
-            getSensorParamMapValues(maxValue, minValue, sensorParamMap);
+            double scaleFactor = getScaleFactor(baseConfiguration->second);
+            double maxValue = 0;
+            double minValue = 0;
+            getReadingRange(*sensorData, maxValue, minValue);
             float pollRate = getPollRate(baseConfiguration->second,
                                          pollRateDefault);
             PowerState readState = getPowerState(baseConfiguration->second);
+            PublishPolicy publishPolicy =
+                getPublishPolicy(baseConfiguration->second);
+            std::optional<AdaptivePoll> adaptivePoll =
+                getAdaptivePoll(baseConfiguration->second, pollRate);
 
             auto& sensor = sensors[sensorName];
             sensor = nullptr;
@@ -313,6 +359,8 @@ void createSensors(
                 path.string(), objectServer, dbusConnection, io, sensorName,
                 std::move(sensorThresholds), scaleFactor, pollRate, readState,
                 *interfacePath, std::move(bridgeGpio), maxValue, minValue);
+            sensor->publishPolicy = publishPolicy;
+            sensor->adaptivePoll = adaptivePoll;
             sensor->setupRead();
         }
     });
@@ -321,15 +369,16 @@ void createSensors(
         std::vector<std::string>{sensorTypes.begin(), sensorTypes.end()});
 }
 
-int main()
+static void startADCSensor(SensorHost& host)
 {
-    boost::asio::io_context io;
-    auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
-    sdbusplus::asio::object_server objectServer(systemBus, true);
-    objectServer.add_manager("/xyz/openbmc_project/sensors");
-
-    systemBus->request_name("xyz.openbmc_project.ADCSensor");
-    boost::container::flat_map<std::string, std::shared_ptr<ADCSensor>> sensors;
+    boost::asio::io_context& io = host.io;
+    std::shared_ptr<sdbusplus::asio::connection>& systemBus = host.systemBus;
+    sdbusplus::asio::object_server& objectServer = host.objectServer;
+    host.addManager("/xyz/openbmc_project/sensors");
+
+    host.requestName("xyz.openbmc_project.ADCSensor");
+    auto& sensors = host.make<
+        boost::container::flat_map<std::string, std::shared_ptr<ADCSensor>>>();
     auto sensorsChanged =
         std::make_shared<boost::container::flat_set<std::string>>();
 
@@ -338,9 +387,15 @@ int main()
                       UpdateType::init);
     });
 
-    boost::asio::steady_timer filterTimer(io);
+    ConfigurationMirror::get(systemBus).onReconcileRescan(
+        [&, sensorsChanged]() {
+        createSensors(io, objectServer, sensors, systemBus, sensorsChanged,
+                      UpdateType::init);
+    });
+
+    auto& filterTimer = host.make<boost::asio::steady_timer>(io);
     std::function<void(sdbusplus::message_t&)> eventHandler =
-        [&](sdbusplus::message_t& message) {
+        [&, sensorsChanged](sdbusplus::message_t& message) {
         if (message.is_method_error())
         {
             std::cerr << "callback method error\n";
@@ -366,7 +421,7 @@ int main()
         });
     };
 
-    boost::asio::steady_timer cpuFilterTimer(io);
+    auto& cpuFilterTimer = host.make<boost::asio::steady_timer>(io);
     std::function<void(sdbusplus::message_t&)> cpuPresenceHandler =
         [&](sdbusplus::message_t& message) {
         std::string path = message.get_path();
@@ -417,8 +472,10 @@ int main()
         });
     };
 
-    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches =
-        setupPropertiesChangedMatches(*systemBus, sensorTypes, eventHandler);
+    auto& matches =
+        host.make<std::vector<std::unique_ptr<sdbusplus::bus::match_t>>>(
+            setupPropertiesChangedMatches(*systemBus, sensorTypes,
+                                          eventHandler));
     matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
         static_cast<sdbusplus::bus_t&>(*systemBus),
         "type='signal',member='PropertiesChanged',path_namespace='" +
@@ -435,5 +492,7 @@ int main()
             << "Successfully registered TAL namespaceInit for ADC Sensor\n";
     }
 #endif
-    io.run();
 }
+
+[[maybe_unused]] static const bool registered =
+    registerSensorClass("adcsensor", startADCSensor);
@@ -0,0 +1,102 @@
+#include "AdaptivePoll.hpp"
+
+#include "Thresholds.hpp"
+#include "Utils.hpp"
+#include "VariantVisitors.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <variant>
+#include <vector>
+
+AdaptivePoll::AdaptivePoll(std::chrono::milliseconds fast,
+                           std::chrono::milliseconds slow,
+                           std::chrono::milliseconds nominal) :
+    fast(fast), slow(std::max(fast, slow)),
+    nominal(std::clamp(nominal, fast, this->slow)), current(this->nominal)
+{}
+
+std::chrono::milliseconds
+    AdaptivePoll::next(double value,
+                       const std::vector<thresholds::Threshold>& thresholds,
+                       double band)
+{
+    double previous = lastValue;
+    lastValue = value;
+    if (std::isnan(value))
+    {
+        // Nothing to judge by, e.g. the sensor is off or failing
+        stableCount = 0;
+        current = nominal;
+        return current;
+    }
+
+    bool excursion = !std::isnan(previous) &&
+                     std::abs(value - previous) > band;
+    for (const thresholds::Threshold& threshold : thresholds)
+    {
+        if (excursion)
+        {
+            break;
+        }
+        excursion = !std::isnan(threshold.value) &&
+                    std::abs(value - threshold.value) <= band * nearBands;
+    }
+
+    if (excursion)
+    {
+        stableCount = 0;
+        current = fast;
+    }
+    else if (++stableCount >= stableReadings)
+    {
+        stableCount = 0;
+        current = std::min(current * 2, slow);
+    }
+    return current;
+}
+
+static std::optional<std::chrono::milliseconds>
+    getPollInterval(const SensorBaseConfigMap& cfg, const char* key)
+{
+    auto find = cfg.find(key);
+    if (find == cfg.end())
+    {
+        return std::nullopt;
+    }
+    float seconds = std::visit(VariantToFloatVisitor(), find->second);
+    if (!std::isfinite(seconds) || seconds <= 0.0F)
+    {
+        std::cerr << "Ignoring invalid " << key << " " << seconds << "\n";
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000));
+}
+
+std::optional<AdaptivePoll> getAdaptivePoll(const SensorBaseConfigMap& cfg,
+                                            float pollRate)
+{
+    std::optional<std::chrono::milliseconds> fast =
+        getPollInterval(cfg, "FastPollRate");
+    std::optional<std::chrono::milliseconds> slow =
+        getPollInterval(cfg, "SlowPollRate");
+    if (!fast && !slow)
+    {
+        return std::nullopt;
+    }
+
+    auto nominal = std::chrono::milliseconds(
+        static_cast<int64_t>(pollRate * 1000));
+    if (fast && slow && *slow < *fast)
+    {
+        std::cerr << "SlowPollRate shorter than FastPollRate, ignoring it\n";
+        slow = std::nullopt;
+    }
+    std::chrono::milliseconds fastest = fast ? *fast : std::min(nominal, *slow);
+    std::chrono::milliseconds slowest = slow ? *slow : std::max(nominal, *fast);
+    return AdaptivePoll(fastest, slowest, nominal);
+}
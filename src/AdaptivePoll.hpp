@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Thresholds.hpp"
+#include "Utils.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// Poll interval of a sensor in adaptive mode. A reading close to one of the
+// sensor's thresholds, or one that moved quickly since the previous reading,
+// switches to the fast interval; after a run of stable readings the interval
+// doubles, up to the slow one.
+class AdaptivePoll
+{
+  public:
+    // Stable readings needed before each backoff step
+    static constexpr size_t stableReadings = 4;
+    // A reading this many hysteresis bands from a threshold counts as close
+    static constexpr double nearBands = 5.0;
+
+    AdaptivePoll(std::chrono::milliseconds fast, std::chrono::milliseconds slow,
+                 std::chrono::milliseconds nominal);
+
+    // Interval to wait before the next reading, given the current one. band
+    // is the sensor's hysteresis, a change larger than it is a fast move.
+    std::chrono::milliseconds
+        next(double value, const std::vector<thresholds::Threshold>& thresholds,
+             double band);
+
+    std::chrono::milliseconds fastInterval() const
+    {
+        return fast;
+    }
+    std::chrono::milliseconds slowInterval() const
+    {
+        return slow;
+    }
+
+  private:
+    std::chrono::milliseconds fast;
+    std::chrono::milliseconds slow;
+    std::chrono::milliseconds nominal;
+    std::chrono::milliseconds current;
+    double lastValue = std::numeric_limits<double>::quiet_NaN();
+    size_t stableCount = 0;
+};
+
+// Adaptive mode is enabled by FastPollRate and/or SlowPollRate, in seconds
+// like PollRate, which stays the starting interval. A missing bound
+// defaults to pollRate.
+std::optional<AdaptivePoll> getAdaptivePoll(const SensorBaseConfigMap& cfg,
+                                            float pollRate);
@@ -0,0 +1,210 @@
+#include "BindingCache.hpp"
+
+#include "Utils.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// The directory a file sits in, with all symlinks resolved. For hwmon and
+// iio attributes this includes the path of the device in the device tree.
+static std::string deviceOf(const fs::path& path)
+{
+    std::error_code ec;
+    fs::path device = fs::canonical(path.parent_path(), ec);
+    if (ec)
+    {
+        return {};
+    }
+    return device.string();
+}
+
+// Whether a configuration object carries one of the daemon's types
+static bool hasType(const SensorData& interfaces,
+                    std::span<const std::string> types)
+{
+    return std::any_of(types.begin(), types.end(),
+                       [&interfaces](const std::string& type) {
+        return interfaces.contains(configInterfaceName(type));
+    });
+}
+
+BindingCache::BindingCache(fs::path file) : file(std::move(file)) {}
+
+fs::path BindingCache::defaultFile(std::string_view daemon)
+{
+    fs::path path(bindingCacheDir);
+    path /= std::string(daemon) + ".json";
+    return path;
+}
+
+// {"<configuration path>": [{"path": "<file>", "device": "<dir>"}, ...]}
+void BindingCache::load()
+{
+    loaded = true;
+    std::ifstream input(file);
+    if (!input.good())
+    {
+        return;
+    }
+    nlohmann::json data = nlohmann::json::parse(input, nullptr, false);
+    if (data.is_discarded() || !data.is_object())
+    {
+        std::cerr << "Ignoring malformed binding cache " << file << "\n";
+        return;
+    }
+    for (const auto& [configurationPath, entries] : data.items())
+    {
+        if (!entries.is_array())
+        {
+            continue;
+        }
+        std::vector<Binding>& bound = bindings[configurationPath];
+        for (const nlohmann::json& entry : entries)
+        {
+            auto path = entry.find("path");
+            auto device = entry.find("device");
+            if (path == entry.end() || !path->is_string() ||
+                device == entry.end() || !device->is_string())
+            {
+                continue;
+            }
+            bound.emplace_back(path->get<std::string>(),
+                               device->get<std::string>());
+        }
+    }
+}
+
+std::optional<std::vector<fs::path>>
+    BindingCache::warmStart(const ManagedObjectType& configs,
+                            std::span<const std::string> types)
+{
+    if (consulted)
+    {
+        return std::nullopt;
+    }
+    consulted = true;
+    if (!loaded)
+    {
+        load();
+    }
+
+    std::vector<fs::path> paths;
+    for (const auto& [configurationPath, cfg] : configs)
+    {
+        if (!hasType(cfg, types))
+        {
+            continue;
+        }
+        auto bound = bindings.find(configurationPath.str);
+        if (bound == bindings.end() || bound->second.empty())
+        {
+            continue;
+        }
+        bool valid = std::all_of(bound->second.begin(), bound->second.end(),
+                                 [](const Binding& binding) {
+            std::error_code ec;
+            return fs::exists(binding.path, ec) &&
+                   deviceOf(binding.path) == binding.device;
+        });
+        if (!valid)
+        {
+            continue;
+        }
+        for (const Binding& binding : bound->second)
+        {
+            paths.emplace_back(binding.path);
+        }
+    }
+    if (paths.empty())
+    {
+        return std::nullopt;
+    }
+    return paths;
+}
+
+void BindingCache::bind(const std::string& configurationPath,
+                        const fs::path& path)
+{
+    if (!loaded)
+    {
+        load();
+    }
+    std::vector<Binding>& bound = bindings[configurationPath];
+    if (boundThisRun.insert(configurationPath).second)
+    {
+        bound.clear();
+        // Unless it comes back the same the file has to be written
+        dirty = true;
+    }
+    Binding binding{path.string(), deviceOf(path)};
+    if (std::find(bound.begin(), bound.end(), binding) == bound.end())
+    {
+        bound.emplace_back(std::move(binding));
+    }
+}
+
+ManagedObjectType BindingCache::unbound(
+    const ManagedObjectType& configs, std::span<const std::string> types) const
+{
+    ManagedObjectType missing;
+    for (const auto& config : configs)
+    {
+        if (hasType(config.second, types) &&
+            !boundThisRun.contains(config.first.str))
+        {
+            missing.emplace(config);
+        }
+    }
+    return missing;
+}
+
+void BindingCache::save(const ManagedObjectType& configs,
+                        std::span<const std::string> types, bool incomplete)
+{
+    if (!loaded)
+    {
+        load();
+    }
+    if (!incomplete)
+    {
+        size_t pruned = std::erase_if(
+            bindings, [&configs, types](const auto& entry) {
+            auto config =
+                configs.find(sdbusplus::message::object_path(entry.first));
+            return config == configs.end() || !hasType(config->second, types);
+        });
+        dirty = dirty || pruned != 0;
+    }
+    if (!dirty)
+    {
+        return;
+    }
+    dirty = false;
+
+    nlohmann::json data = nlohmann::json::object();
+    for (const auto& [configurationPath, bound] : bindings)
+    {
+        nlohmann::json& entries = data[configurationPath];
+        entries = nlohmann::json::array();
+        for (const Binding& binding : bound)
+        {
+            entries.push_back(
+                {{"path", binding.path}, {"device", binding.device}});
+        }
+    }
+    replaceFileIfChanged(file, data.dump());
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const constexpr char* bindingCacheDir = "/var/cache/dbus-sensors";
+
+// Sysfs files a daemon bound its configuration objects to in its previous
+// run. A restart binds straight to them instead of walking sysfs for every
+// device, which keeps sensors dark for less time across firmware updates.
+//
+// Each file is kept with the canonical directory it was found in, which
+// names the device. An entry only counts while the file still resolves to
+// that same device; the configuration objects left without a valid entry
+// go through discovery.
+//
+// Only the bindings are cached, not the scale factors or the PSU label to
+// sensor name mapping. Those come from the configuration and from the label
+// files next to the bound files, both of which a warm start still reads; a
+// cached copy would only save a few small reads, and could go stale.
+class BindingCache
+{
+  public:
+    explicit BindingCache(std::filesystem::path file);
+
+    // <bindingCacheDir>/<daemon>.json
+    static std::filesystem::path defaultFile(std::string_view daemon);
+
+    // The files that the configuration objects of the daemon's types were
+    // bound to, for the objects whose bindings all still resolve to the same
+    // devices. Nothing if there are none. Only the first call answers, later
+    // scans discover as before.
+    std::optional<std::vector<std::filesystem::path>>
+        warmStart(const ManagedObjectType& configs,
+                  std::span<const std::string> types);
+
+    // Records a file bound to a configuration object. The first binding of
+    // an object in this run replaces those of the previous run.
+    void bind(const std::string& configurationPath,
+              const std::filesystem::path& path);
+
+    // The configuration objects of the daemon's types not bound in this run,
+    // which discovery still has to find the devices of
+    ManagedObjectType unbound(const ManagedObjectType& configs,
+                              std::span<const std::string> types) const;
+
+    // Drops the bindings of objects that are no longer in configs as one of
+    // the daemon's types, then writes the bindings out if they changed. An
+    // incomplete configuration may just have missed an object, so it drops
+    // nothing.
+    void save(const ManagedObjectType& configs,
+              std::span<const std::string> types, bool incomplete = false);
+
+  private:
+    struct Binding
+    {
+        std::string path;
+        std::string device;
+
+        bool operator==(const Binding&) const = default;
+    };
+
+    void load();
+
+    std::filesystem::path file;
+    std::map<std::string, std::vector<Binding>> bindings;
+    std::set<std::string> boundThisRun;
+    bool loaded = false;
+    bool consulted = false;
+    bool dirty = false;
+};
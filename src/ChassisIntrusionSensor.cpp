@@ -16,6 +16,9 @@
 
 #include "ChassisIntrusionSensor.hpp"
 
+#include "FileHandle.hpp"
+#include "I2CExecutor.hpp"
+
 #include <fcntl.h>
 #include <linux/i2c.h>
 #include <sys/ioctl.h>
@@ -30,9 +33,11 @@
 #include <gpiod.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
+#include <cerrno>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -124,9 +129,9 @@ void ChassisIntrusionSensor::updateValue(const size_t& value)
 int ChassisIntrusionPchSensor::readSensor()
 {
     int32_t statusMask = pchRegMaskIntrusion;
-    int32_t statusReg = pchStatusRegIntrusion;
 
-    int32_t value = i2c_smbus_read_byte_data(mBusFd, statusReg);
+    // Read from the I2C worker by pollSensorStatus()
+    int32_t value = mStatusRead;
     if constexpr (debug)
     {
         std::cout << "Pch type: raw value is " << value << "\n";
@@ -134,7 +139,8 @@ int ChassisIntrusionPchSensor::readSensor()
 
     if (value < 0)
     {
-        std::cerr << "i2c_smbus_read_byte_data failed \n";
+        std::cerr << "i2c_smbus_read_byte_data failed: " << strerror(-value)
+                  << "\n";
         return -1;
     }
 
@@ -170,19 +176,31 @@ void ChassisIntrusionPchSensor::pollSensorStatus()
             return;
         }
 
-        int value = self->readSensor();
-        if (value < 0)
-        {
-            intrusionSensorPollSec = sensorFailedPollSec;
-        }
-        else
-        {
-            intrusionSensorPollSec = defaultPollSec;
-            self->updateValue(value);
-        }
+        self->mI2C.submit([slaveAddr{self->mSlaveAddr}](
+                              I2CBus& bus, std::vector<uint8_t>& /*data*/) {
+            return bus.readByteData(slaveAddr, pchStatusRegIntrusion, true);
+        },
+                          [weakRef](int rc, std::vector<uint8_t>& /*data*/) {
+            std::shared_ptr<ChassisIntrusionPchSensor> self = weakRef.lock();
+            if (!self)
+            {
+                return;
+            }
+            self->mStatusRead = rc;
+            int value = self->readSensor();
+            if (value < 0)
+            {
+                intrusionSensorPollSec = sensorFailedPollSec;
+            }
+            else
+            {
+                intrusionSensorPollSec = defaultPollSec;
+                self->updateValue(value);
+            }
 
-        // trigger next polling
-        self->pollSensorStatus();
+            // trigger next polling
+            self->pollSensorStatus();
+        });
     });
 }
 
@@ -368,9 +386,10 @@ ChassisIntrusionSensor::ChassisIntrusionSensor(
 
 ChassisIntrusionPchSensor::ChassisIntrusionPchSensor(
     bool autoRearm, boost::asio::io_context& io,
-    sdbusplus::asio::object_server& objServer, int busId, int slaveAddr) :
+    sdbusplus::asio::object_server& objServer, int busId, int slaveAddr,
+    const I2CPolicy& i2cPolicy) :
     ChassisIntrusionSensor(autoRearm, objServer),
-    mPollTimer(io)
+    mPollTimer(io), mI2C(io, static_cast<unsigned>(busId), i2cPolicy)
 {
     if (busId < 0 || slaveAddr <= 0)
     {
@@ -382,15 +401,17 @@ ChassisIntrusionPchSensor::ChassisIntrusionPchSensor(
     mSlaveAddr = slaveAddr;
 
     std::string devPath = "/dev/i2c-" + std::to_string(busId);
+    // The device is only probed here, reads go through the I2C executor
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    mBusFd = open(devPath.c_str(), O_RDWR | O_CLOEXEC);
-    if (mBusFd < 0)
+    int busFd = open(devPath.c_str(), O_RDWR | O_CLOEXEC);
+    if (busFd < 0)
     {
         throw std::invalid_argument("Unable to open " + devPath + "\n");
     }
+    FileHandle bus(busFd);
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(mBusFd, I2C_SLAVE_FORCE, mSlaveAddr) < 0)
+    if (ioctl(bus.handle(), I2C_SLAVE_FORCE, mSlaveAddr) < 0)
     {
         throw std::runtime_error("Unable to set device address\n");
     }
@@ -398,7 +419,7 @@ ChassisIntrusionPchSensor::ChassisIntrusionPchSensor(
     unsigned long funcs = 0;
 
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(mBusFd, I2C_FUNCS, &funcs) < 0)
+    if (ioctl(bus.handle(), I2C_FUNCS, &funcs) < 0)
     {
         throw std::runtime_error("Don't support I2C_FUNCS\n");
     }
@@ -479,10 +500,6 @@ ChassisIntrusionSensor::~ChassisIntrusionSensor()
 ChassisIntrusionPchSensor::~ChassisIntrusionPchSensor()
 {
     mPollTimer.cancel();
-    if (close(mBusFd) < 0)
-    {
-        std::cerr << "Failed to close fd " << std::to_string(mBusFd);
-    }
 }
 
 ChassisIntrusionGpioSensor::~ChassisIntrusionGpioSensor()
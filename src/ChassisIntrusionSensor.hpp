@@ -1,5 +1,7 @@
 #pragma once
 
+#include "I2CExecutor.hpp"
+
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <gpiod.hpp>
@@ -45,14 +47,17 @@ class ChassisIntrusionPchSensor :
   public:
     ChassisIntrusionPchSensor(bool autoRearm, boost::asio::io_context& io,
                               sdbusplus::asio::object_server& objServer,
-                              int busId, int slaveAddr);
+                              int busId, int slaveAddr,
+                              const I2CPolicy& i2cPolicy);
 
     ~ChassisIntrusionPchSensor() override;
 
   private:
-    int mBusFd{-1};
     int mSlaveAddr{-1};
+    // Status register value or negative errno of the last read
+    int mStatusRead{-1};
     boost::asio::steady_timer mPollTimer;
+    I2CChannel mI2C;
     int readSensor() override;
     void pollSensorStatus() override;
 };
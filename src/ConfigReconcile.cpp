@@ -0,0 +1,154 @@
+#include "ConfigReconcile.hpp"
+
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Both maps are sorted by object path, so a single merge walk does
+ConfigDiff diffConfiguration(const ManagedObjectType& before,
+                             const ManagedObjectType& after)
+{
+    ConfigDiff diff;
+    auto old = before.begin();
+    auto now = after.begin();
+    while (old != before.end() || now != after.end())
+    {
+        if (now == after.end() ||
+            (old != before.end() && old->first < now->first))
+        {
+            diff.removed.emplace_back(old->first.str);
+            ++old;
+        }
+        else if (old == before.end() || now->first < old->first)
+        {
+            diff.added.emplace_back(now->first.str);
+            ++now;
+        }
+        else
+        {
+            if (old->second != now->second)
+            {
+                diff.changed.emplace_back(now->first.str);
+            }
+            ++old;
+            ++now;
+        }
+    }
+    return diff;
+}
+
+// Thresholds interfaces are recognized the way parseThresholdsFromConfig()
+// does
+static bool isThresholdInterface(const std::string& interface)
+{
+    return interface.find("Thresholds") != std::string::npos;
+}
+
+// Whether the two sets of properties differ in nothing but ignored ones
+static bool sameExcept(const SensorBaseConfigMap& before,
+                       const SensorBaseConfigMap& after,
+                       const std::vector<std::string>& ignored)
+{
+    auto differs = [&ignored](const SensorBaseConfigMap& one,
+                              const SensorBaseConfigMap& other) {
+        return std::ranges::any_of(one, [&](const auto& property) {
+            if (std::ranges::find(ignored, property.first) != ignored.end())
+            {
+                return false;
+            }
+            auto found = other.find(property.first);
+            return found == other.end() || found->second != property.second;
+        });
+    };
+    return !differs(before, after) && !differs(after, before);
+}
+
+// Whether an object went from before to after in nothing but its
+// thresholds and the inPlace properties
+static bool changedInPlace(const SensorData& before, const SensorData& after,
+                           const std::vector<std::string>& inPlace)
+{
+    auto sameIn = [&inPlace](const SensorData& one, const SensorData& other) {
+        return std::ranges::all_of(one, [&](const auto& interface) {
+            if (isThresholdInterface(interface.first))
+            {
+                return true;
+            }
+            auto found = other.find(interface.first);
+            return found != other.end() &&
+                   sameExcept(interface.second, found->second, inPlace);
+        });
+    };
+    return sameIn(before, after) && sameIn(after, before);
+}
+
+const ConfigDiff& ConfigReconciler::update(const ManagedObjectType& newConfigs,
+                                          bool incomplete)
+{
+    lastDiff = diffConfiguration(configs, newConfigs);
+    if (incomplete)
+    {
+        lastDiff.removed.clear();
+        // An object read without some of its interfaces is kept as it was
+        std::erase_if(lastDiff.changed,
+                      [this, &newConfigs](const std::string& path) {
+            sdbusplus::message::object_path objectPath(path);
+            const auto& before = configs.find(objectPath)->second;
+            const auto& after = newConfigs.find(objectPath)->second;
+            return std::ranges::any_of(before,
+                                       [&after](const auto& interface) {
+                return !after.contains(interface.first);
+            });
+        });
+    }
+
+    updatable.clear();
+    for (const std::string& path : lastDiff.changed)
+    {
+        sdbusplus::message::object_path objectPath(path);
+        if (changedInPlace(configs.find(objectPath)->second,
+                           newConfigs.find(objectPath)->second,
+                           inPlaceProperties))
+        {
+            updatable.emplace_back(path);
+        }
+    }
+
+    if (!incomplete)
+    {
+        configs = newConfigs;
+        return lastDiff;
+    }
+    // Objects read in full are taken over, so the next rescan does not
+    // report them again; the rest stays as it was
+    for (const auto* paths : {&lastDiff.added, &lastDiff.changed})
+    {
+        for (const std::string& path : *paths)
+        {
+            sdbusplus::message::object_path objectPath(path);
+            configs[objectPath] = newConfigs.find(objectPath)->second;
+        }
+    }
+    return lastDiff;
+}
+
+bool ConfigReconciler::needsRebuild(const std::string& path) const
+{
+    return std::binary_search(lastDiff.added.begin(), lastDiff.added.end(),
+                              path) ||
+           std::binary_search(lastDiff.changed.begin(), lastDiff.changed.end(),
+                              path);
+}
+
+bool ConfigReconciler::canUpdate(const std::string& path) const
+{
+    return std::binary_search(updatable.begin(), updatable.end(), path);
+}
+
+bool ConfigReconciler::isRemoved(const std::string& path) const
+{
+    return std::binary_search(lastDiff.removed.begin(), lastDiff.removed.end(),
+                              path);
+}
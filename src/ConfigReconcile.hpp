@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Configuration object paths that differ between two sets of entity-manager
+// configuration, as returned by GetSensorConfiguration
+struct ConfigDiff
+{
+    std::vector<std::string> added;
+    std::vector<std::string> changed;
+    std::vector<std::string> removed;
+
+    bool empty() const
+    {
+        return added.empty() && changed.empty() && removed.empty();
+    }
+};
+
+ConfigDiff diffConfiguration(const ManagedObjectType& before,
+                             const ManagedObjectType& after);
+
+// Remembers the configuration a daemon last built its sensors from, so a
+// rescan only rebuilds the sensors whose configuration object really changed.
+// The others keep their D-Bus objects, open files and threshold state, even
+// when entity-manager signalled their object without changing it.
+//
+// Objects that only changed in their thresholds, or in properties the daemon
+// can apply to a running sensor, are reported by canUpdate(), so the daemon
+// can update their sensors in place instead of tearing down and recreating
+// their D-Bus objects.
+class ConfigReconciler
+{
+  public:
+    ConfigReconciler() = default;
+
+    // inPlaceProperties are properties of the sensor's own configuration
+    // interface that the daemon applies to running sensors, like ScaleFactor
+    explicit ConfigReconciler(std::vector<std::string> inPlaceProperties) :
+        inPlaceProperties(std::move(inPlaceProperties))
+    {}
+
+    // Diffs the configuration of a rescan against the previous one, which it
+    // then replaces. An incomplete fetch can miss objects or interfaces that
+    // still exist, so it removes nothing and only counts an object as changed
+    // when it kept all of its interfaces. Of its configuration, only the
+    // objects added or changed are taken over for the next rescan.
+    const ConfigDiff& update(const ManagedObjectType& configs,
+                             bool incomplete = false);
+
+    const ConfigDiff& diff() const
+    {
+        return lastDiff;
+    }
+
+    // The configuration the sensors were last built from
+    const ManagedObjectType& configuration() const
+    {
+        return configs;
+    }
+
+    // Whether the sensors built from the object at path are out of date
+    bool needsRebuild(const std::string& path) const;
+
+    // Whether the object at path changed in nothing but its Thresholds
+    // interfaces and the inPlaceProperties. Its sensors keep their names and
+    // so their D-Bus object paths; a daemon that manages to update them
+    // skips rebuilding them.
+    bool canUpdate(const std::string& path) const;
+
+    // Destroys the sensors whose configuration object went away, returns how
+    // many were
+    template <typename SensorMap>
+    size_t removeSensors(SensorMap& sensors) const
+    {
+        size_t count = 0;
+        auto sensorIt = sensors.begin();
+        while (sensorIt != sensors.end())
+        {
+            if (sensorIt->second != nullptr &&
+                isRemoved(sensorIt->second->configurationPath))
+            {
+                sensorIt = sensors.erase(sensorIt);
+                ++count;
+            }
+            else
+            {
+                sensorIt++;
+            }
+        }
+        return count;
+    }
+
+  private:
+    bool isRemoved(const std::string& path) const;
+
+    ManagedObjectType configs;
+    ConfigDiff lastDiff;
+    std::vector<std::string> inPlaceProperties;
+    // Sorted subset of lastDiff.changed, see canUpdate()
+    std::vector<std::string> updatable;
+};
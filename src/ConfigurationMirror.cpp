@@ -0,0 +1,550 @@
+#include "ConfigurationMirror.hpp"
+
+#include "dbus-sensor_config.h"
+
+#include "BindingCache.hpp"
+#include "ConfigReconcile.hpp"
+#include "Utils.hpp"
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <nlohmann/json.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <sdbusplus/message/native_types.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+boost::asio::execution_context::id ConfigurationMirror::id;
+
+ConfigurationMirror::ConfigurationMirror(boost::asio::io_context& io) :
+    boost::asio::execution_context::service(io), retryTimer(io),
+    snapshotFile(std::filesystem::path(bindingCacheDir) /
+                 (std::string(program_invocation_short_name) +
+                  "-configuration.json"))
+{}
+
+ConfigurationMirror& ConfigurationMirror::get(
+    const std::shared_ptr<sdbusplus::asio::connection>& conn)
+{
+    ConfigurationMirror& mirror =
+        boost::asio::use_service<ConfigurationMirror>(conn->get_io_context());
+    if (!mirror.conn)
+    {
+        mirror.start(conn);
+    }
+    return mirror;
+}
+
+void ConfigurationMirror::shutdown()
+{
+    retryTimer.cancel();
+    matches.clear();
+    conn.reset();
+}
+
+void ConfigurationMirror::start(
+    const std::shared_ptr<sdbusplus::asio::connection>& newConn)
+{
+    namespace rules = sdbusplus::bus::match::rules;
+
+    conn = newConn;
+    auto& bus = static_cast<sdbusplus::bus_t&>(*conn);
+    std::string sender = rules::sender(entityManagerName);
+
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus, rules::interfacesAdded() + sender,
+        [this](sdbusplus::message_t& msg) { interfacesAdded(msg); }));
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus, rules::interfacesRemoved() + sender,
+        [this](sdbusplus::message_t& msg) { interfacesRemoved(msg); }));
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus,
+        "type='signal',member='PropertiesChanged',path_namespace='" +
+            std::string(inventoryPath) +
+            "',arg0namespace='xyz.openbmc_project.Configuration'," + sender,
+        [this](sdbusplus::message_t& msg) { propertiesChanged(msg); }));
+    matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
+        bus, rules::nameOwnerChanged(entityManagerName),
+        [this](sdbusplus::message_t& msg) { ownerChanged(msg); }));
+}
+
+// Converts a snapshot property, nullopt for types the sensors never use
+static std::optional<BasicVariantType>
+    snapshotValue(const nlohmann::json& value)
+{
+    if (value.is_string())
+    {
+        return value.get<std::string>();
+    }
+    if (value.is_boolean())
+    {
+        return value.get<bool>();
+    }
+    if (value.is_number_unsigned())
+    {
+        return value.get<uint64_t>();
+    }
+    if (value.is_number_integer())
+    {
+        return value.get<int64_t>();
+    }
+    if (value.is_number_float())
+    {
+        return value.get<double>();
+    }
+    if (value.is_array() &&
+        std::all_of(value.begin(), value.end(),
+                    [](const nlohmann::json& item) {
+        return item.is_string();
+    }))
+    {
+        return value.get<std::vector<std::string>>();
+    }
+    return std::nullopt;
+}
+
+// The snapshot has the layout of entity-manager's GetManagedObjects reply:
+// {"<object path>": {"<interface>": {"<property>": <value>, ...}, ...}, ...}
+void ConfigurationMirror::loadSnapshot()
+{
+    std::ifstream file(snapshotFile);
+    if (!file.good())
+    {
+        return;
+    }
+    nlohmann::json data = nlohmann::json::parse(file, nullptr, false, true);
+    if (data.is_discarded() || !data.is_object())
+    {
+        std::cerr << "Ignoring malformed configuration snapshot "
+                  << snapshotFile << "\n";
+        return;
+    }
+
+    for (const auto& [path, interfaces] : data.items())
+    {
+        if (!interfaces.is_object())
+        {
+            continue;
+        }
+        SensorData& object = snapshot[sdbusplus::message::object_path(path)];
+        for (const auto& [intf, properties] : interfaces.items())
+        {
+            if (!properties.is_object())
+            {
+                continue;
+            }
+            SensorBaseConfigMap& config = object[intf];
+            for (const auto& [name, value] : properties.items())
+            {
+                std::optional<BasicVariantType> converted =
+                    snapshotValue(value);
+                if (converted)
+                {
+                    config.emplace(name, std::move(*converted));
+                }
+            }
+        }
+    }
+    servingSnapshot = !snapshot.empty();
+}
+
+void ConfigurationMirror::serveSnapshot()
+{
+    objects.clear();
+    for (const auto& object : snapshot)
+    {
+        if (isWatched(object.second))
+        {
+            objects.emplace(object);
+        }
+    }
+    ready = true;
+}
+
+void ConfigurationMirror::saveSnapshot() const
+{
+    nlohmann::json data = nlohmann::json::object();
+    for (const auto& [path, interfaces] : objects)
+    {
+        nlohmann::json& object = data[path.str];
+        object = nlohmann::json::object();
+        for (const auto& [intf, properties] : interfaces)
+        {
+            nlohmann::json& config = object[intf];
+            config = nlohmann::json::object();
+            for (const auto& [name, value] : properties)
+            {
+                std::visit([&config, &name](const auto& v) {
+                    config[name] = v;
+                }, value);
+            }
+        }
+    }
+    replaceFileIfChanged(snapshotFile, data.dump());
+}
+
+void ConfigurationMirror::onReconcileRescan(std::function<void()>&& rescan)
+{
+    onReconcile([rescan{std::move(rescan)}](
+                    const std::vector<std::string>& changed,
+                    const std::vector<std::string>& removed) {
+        if (changed.empty() && removed.empty())
+        {
+            return;
+        }
+        rescan();
+    });
+}
+
+void ConfigurationMirror::onReconcile(ReconcileHandler&& handler)
+{
+    reconcileHandlers.emplace_back(std::move(handler));
+    if constexpr (fastBoot != 0)
+    {
+        // Nothing was answered yet, so the snapshot can still stand in for
+        // entity-manager
+        if (reconcileHandlers.size() == 1 && !ready)
+        {
+            loadSnapshot();
+            if (servingSnapshot && !watched.empty())
+            {
+                serveSnapshot();
+            }
+        }
+    }
+}
+
+void ConfigurationMirror::reconcile(const ManagedObjectType& live)
+{
+    ConfigDiff diff = diffConfiguration(objects, live);
+    std::vector<std::string> changed = std::move(diff.added);
+    changed.insert(changed.end(), diff.changed.begin(), diff.changed.end());
+
+    std::cerr << "Configuration snapshot reconciled, " << changed.size()
+              << " objects changed, " << diff.removed.size() << " removed\n";
+    for (const ReconcileHandler& handler : reconcileHandlers)
+    {
+        handler(changed, diff.removed);
+    }
+}
+
+void ConfigurationMirror::watch(std::span<const std::string> types)
+{
+    bool added = false;
+    for (const std::string& type : types)
+    {
+        // An empty type would watch every configuration interface
+        if (type.empty())
+        {
+            continue;
+        }
+        std::string interface = configInterfaceName(type);
+        if (std::find(watched.begin(), watched.end(), interface) ==
+            watched.end())
+        {
+            watched.emplace_back(std::move(interface));
+            added = true;
+        }
+    }
+    if (added)
+    {
+        if (servingSnapshot)
+        {
+            serveSnapshot();
+        }
+        sync();
+    }
+}
+
+bool ConfigurationMirror::getConfiguration(std::span<const std::string> types,
+                                           ManagedObjectType& resp) const
+{
+    if (!ready)
+    {
+        return false;
+    }
+    std::vector<std::string> interfaces;
+    interfaces.reserve(types.size());
+    for (const std::string& type : types)
+    {
+        if (type.empty())
+        {
+            continue;
+        }
+        std::string interface = configInterfaceName(type);
+        if (std::find(watched.begin(), watched.end(), interface) ==
+            watched.end())
+        {
+            return false;
+        }
+        interfaces.emplace_back(std::move(interface));
+    }
+
+    // Like GetSensorConfiguration, only the requested interfaces and those
+    // under them are handed out, not the rest of the object
+    for (const auto& [path, object] : objects)
+    {
+        SensorData requested;
+        for (const auto& interface : object)
+        {
+            if (std::any_of(interfaces.begin(), interfaces.end(),
+                            [&interface](const std::string& possible) {
+                return interface.first.starts_with(possible);
+            }))
+            {
+                requested.emplace(interface);
+            }
+        }
+        if (!requested.empty())
+        {
+            resp.emplace(path, std::move(requested));
+        }
+    }
+    return true;
+}
+
+void ConfigurationMirror::sync()
+{
+    if (!conn)
+    {
+        return;
+    }
+    // The snapshot keeps being served until entity-manager answers
+    ready = servingSnapshot;
+    retryTimer.cancel();
+    uint64_t sequence = ++syncSequence;
+    conn->async_method_call(
+        [this, sequence](const boost::system::error_code& ec,
+                         ManagedObjectType& managedObjects) {
+        if (sequence != syncSequence)
+        {
+            return; // superseded by a later sync
+        }
+        if (ec)
+        {
+            std::cerr << "Error mirroring " << entityManagerName
+                      << " configuration: " << ec.message() << "\n";
+            retryTimer.expires_after(std::chrono::seconds(10));
+            retryTimer.async_wait(
+                [this](const boost::system::error_code& timerEc) {
+                if (timerEc != boost::asio::error::operation_aborted)
+                {
+                    sync();
+                }
+            });
+            return;
+        }
+
+        // Signals received before this reply are already reflected in it,
+        // later ones are applied on top as they arrive.
+        ManagedObjectType live;
+        for (auto& object : managedObjects)
+        {
+            if (isWatched(object.second))
+            {
+                live.emplace(std::move(object));
+            }
+        }
+        if (servingSnapshot)
+        {
+            servingSnapshot = false;
+            snapshot.clear();
+            reconcile(live);
+        }
+        objects = std::move(live);
+        ready = true;
+        ++changes;
+        if constexpr (fastBoot != 0)
+        {
+            saveSnapshot();
+        }
+    },
+        entityManagerName, inventoryPath, "org.freedesktop.DBus.ObjectManager",
+        "GetManagedObjects");
+}
+
+bool ConfigurationMirror::isWatched(const std::string& interface) const
+{
+    return std::any_of(watched.begin(), watched.end(),
+                       [&interface](const std::string& prefix) {
+        return interface.starts_with(prefix);
+    });
+}
+
+bool ConfigurationMirror::isWatched(const SensorData& interfaces) const
+{
+    return std::any_of(interfaces.begin(), interfaces.end(),
+                       [this](const auto& intf) {
+        return isWatched(intf.first);
+    });
+}
+
+void ConfigurationMirror::interfacesAdded(sdbusplus::message_t& msg)
+{
+    sdbusplus::message::object_path path;
+    SensorData added;
+    try
+    {
+        msg.read(path, added);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Unreadable InterfacesAdded, resyncing configuration: "
+                  << e.what() << "\n";
+        sync();
+        return;
+    }
+
+    auto object = objects.find(path);
+    if (object != objects.end())
+    {
+        for (auto& [intf, cfg] : added)
+        {
+            object->second[intf] = std::move(cfg);
+        }
+    }
+    else if (isWatched(added))
+    {
+        objects.emplace(std::move(path), std::move(added));
+    }
+    else
+    {
+        return;
+    }
+    ++changes;
+}
+
+void ConfigurationMirror::interfacesRemoved(sdbusplus::message_t& msg)
+{
+    sdbusplus::message::object_path path;
+    std::vector<std::string> removed;
+    try
+    {
+        msg.read(path, removed);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Unreadable InterfacesRemoved, resyncing configuration: "
+                  << e.what() << "\n";
+        sync();
+        return;
+    }
+
+    auto object = objects.find(path);
+    if (object == objects.end())
+    {
+        return;
+    }
+    for (const std::string& intf : removed)
+    {
+        object->second.erase(intf);
+    }
+    if (!isWatched(object->second))
+    {
+        objects.erase(object);
+    }
+    ++changes;
+}
+
+void ConfigurationMirror::propertiesChanged(sdbusplus::message_t& msg)
+{
+    auto object = objects.find(sdbusplus::message::object_path(msg.get_path()));
+    if (object == objects.end())
+    {
+        return;
+    }
+
+    std::string intf;
+    SensorBaseConfigMap changed;
+    std::vector<std::string> invalidated;
+    try
+    {
+        msg.read(intf, changed, invalidated);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Unreadable PropertiesChanged, resyncing configuration: "
+                  << e.what() << "\n";
+        sync();
+        return;
+    }
+
+    auto interface = object->second.find(intf);
+    if (interface == object->second.end())
+    {
+        return;
+    }
+    for (auto& [name, value] : changed)
+    {
+        interface->second[name] = std::move(value);
+    }
+    for (const std::string& name : invalidated)
+    {
+        interface->second.erase(name);
+    }
+    ++changes;
+}
+
+void ConfigurationMirror::ownerChanged(sdbusplus::message_t& msg)
+{
+    std::string name;
+    std::string oldOwner;
+    std::string newOwner;
+    try
+    {
+        msg.read(name, oldOwner, newOwner);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Unreadable NameOwnerChanged, resyncing configuration: "
+                  << e.what() << "\n";
+        sync();
+        return;
+    }
+
+    if (servingSnapshot)
+    {
+        // entity-manager starting up after us, as it does at boot. Keep the
+        // snapshot until it can be reconciled.
+        if (!newOwner.empty())
+        {
+            sync();
+        }
+        return;
+    }
+
+    // entity-manager restarted or went away, what we have is stale either way
+    objects.clear();
+    ready = false;
+    ++changes;
+    if (!newOwner.empty())
+    {
+        sync();
+    }
+}
+
+bool getMirroredConfiguration(
+    const std::shared_ptr<sdbusplus::asio::connection>& conn,
+    std::span<const std::string> types, ManagedObjectType& resp)
+{
+    ConfigurationMirror& mirror = ConfigurationMirror::get(conn);
+    mirror.watch(types);
+    return mirror.getConfiguration(types, resp);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Per io_context copy of the entity-manager objects carrying one of the
+// configuration types a daemon asked for. It is fetched with one asynchronous
+// GetManagedObjects and then kept current from entity-manager's
+// InterfacesAdded, InterfacesRemoved and PropertiesChanged signals, so a
+// configuration change no longer means walking the mapper and calling GetAll
+// on every object again.
+//
+// Objects are mirrored whole, with all their interfaces, as soon as one of
+// their interfaces starts with a watched configuration interface name. They
+// are handed out with only the interfaces of the types asked for.
+//
+// Built with fast-boot, the mirror saves the objects it has after every sync
+// with entity-manager. When the daemon registers a reconcile handler before
+// the first sync, the mirror answers from that snapshot until the sync has
+// completed, and then reports the objects whose configuration turned out
+// different to its reconcile handlers.
+class ConfigurationMirror : public boost::asio::execution_context::service
+{
+  public:
+    using key_type = ConfigurationMirror;
+
+    static boost::asio::execution_context::id id;
+
+    explicit ConfigurationMirror(boost::asio::io_context& io);
+    ~ConfigurationMirror() override = default;
+
+    ConfigurationMirror(const ConfigurationMirror&) = delete;
+    ConfigurationMirror(ConfigurationMirror&&) = delete;
+    ConfigurationMirror& operator=(const ConfigurationMirror&) = delete;
+    ConfigurationMirror& operator=(ConfigurationMirror&&) = delete;
+
+    // The mirror of the connection's io_context, listening on that
+    // connection from the first call on.
+    static ConfigurationMirror&
+        get(const std::shared_ptr<sdbusplus::asio::connection>& conn);
+
+    // Starts mirroring the given configuration types, e.g. "TMP75". Adding a
+    // type that is not mirrored yet triggers a new sync.
+    void watch(std::span<const std::string> types);
+
+    // Adds the objects of the given types to resp, as GetSensorConfiguration
+    // would. Returns false, leaving resp alone, while the mirror is not in
+    // sync or does not watch all of the types.
+    bool getConfiguration(std::span<const std::string> types,
+                          ManagedObjectType& resp) const;
+
+    // Called after the first sync when the snapshot was served before it.
+    // changed lists the objects that entity-manager has with a different
+    // configuration, including new ones, and removed those it does not have.
+    // Registering the first handler before the first sync puts the snapshot
+    // in service, a daemon without one never builds sensors from it.
+    using ReconcileHandler =
+        std::function<void(const std::vector<std::string>& changed,
+                           const std::vector<std::string>& removed)>;
+    void onReconcile(ReconcileHandler&& handler);
+
+    // Reconciles a daemon's sensors: rescan runs when entity-manager
+    // disagrees with the snapshot in any object. The rescan rebuilds or
+    // removes the sensors of those objects and leaves the others alone.
+    void onReconcileRescan(std::function<void()>&& rescan);
+
+    // Incremented whenever the mirrored objects change
+    uint64_t generation() const
+    {
+        return changes;
+    }
+
+  private:
+    void shutdown() override;
+
+    void start(const std::shared_ptr<sdbusplus::asio::connection>& newConn);
+    void loadSnapshot();
+    void serveSnapshot();
+    void saveSnapshot() const;
+    void sync();
+    void reconcile(const ManagedObjectType& live);
+    bool isWatched(const std::string& interface) const;
+    bool isWatched(const SensorData& interfaces) const;
+
+    void interfacesAdded(sdbusplus::message_t& msg);
+    void interfacesRemoved(sdbusplus::message_t& msg);
+    void propertiesChanged(sdbusplus::message_t& msg);
+    void ownerChanged(sdbusplus::message_t& msg);
+
+    std::shared_ptr<sdbusplus::asio::connection> conn;
+    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches;
+    boost::asio::steady_timer retryTimer;
+
+    // Full configuration interface names, matched as prefixes
+    std::vector<std::string> watched;
+    ManagedObjectType objects;
+    bool ready = false;
+    // <bindingCacheDir>/<process>-configuration.json, one per process as each
+    // only mirrors the configuration types of its own sensors
+    std::filesystem::path snapshotFile;
+    // Objects of the snapshot, until the first sync
+    ManagedObjectType snapshot;
+    bool servingSnapshot = false;
+    std::vector<ReconcileHandler> reconcileHandlers;
+    // Replies to superseded GetManagedObjects calls are dropped
+    uint64_t syncSequence = 0;
+    uint64_t changes = 0;
+};
@@ -50,7 +50,7 @@ std::optional<I2CDeviceParams>
 
 static fs::path i2cBusPath(uint64_t bus)
 {
-    return {"/sys/bus/i2c/devices/i2c-" + std::to_string(bus)};
+    return {sysfsPath("/sys/bus/i2c/devices/i2c-") + std::to_string(bus)};
 }
 
 static std::string deviceDirName(uint64_t bus, uint64_t address)
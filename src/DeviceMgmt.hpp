@@ -1,12 +1,15 @@
 #pragma once
 
+#include "StaticMap.hpp"
 #include "Utils.hpp"
 
 #include <boost/container/flat_map.hpp>
 
+#include <cstddef>
 #include <functional>
 #include <optional>
 #include <string_view>
+#include <utility>
 
 struct I2CDeviceType
 {
@@ -14,16 +17,17 @@ struct I2CDeviceType
     bool createsHWMon;
 };
 
-struct I2CDeviceComparator
-{
-    bool operator()(const std::string& a, const std::string& b) const noexcept
-    {
-        return strcasecmp(a.c_str(), b.c_str()) < 0;
-    }
-};
+// Configuration types a daemon instantiates devices for, looked up ignoring
+// case. Daemons define their tables with makeI2CDeviceTypes() and pass them
+// around as an I2CDeviceTypeMap.
+using I2CDeviceTypeMap = StaticMapView<I2CDeviceType, CaseInsensitiveLess>;
 
-using I2CDeviceTypeMap =
-    boost::container::flat_map<std::string, I2CDeviceType, I2CDeviceComparator>;
+template <size_t N>
+consteval StaticMap<I2CDeviceType, N, CaseInsensitiveLess> makeI2CDeviceTypes(
+    std::pair<std::string_view, I2CDeviceType> (&&types)[N])
+{
+    return makeStaticMap<I2CDeviceType, CaseInsensitiveLess>(std::move(types));
+}
 
 struct I2CDeviceParams
 {
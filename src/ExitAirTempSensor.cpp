@@ -16,6 +16,7 @@
 
 #include "ExitAirTempSensor.hpp"
 
+#include "SensorInstrumentation.hpp"
 #include "SensorPaths.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
@@ -940,6 +941,7 @@ int main()
     auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
     sdbusplus::asio::object_server objectServer(systemBus, true);
     objectServer.add_manager("/xyz/openbmc_project/sensors");
+    registerSensorInstrumentationControl(objectServer);
     systemBus->request_name("xyz.openbmc_project.ExitAirTempSensor");
     std::shared_ptr<ExitAirTempSensor> sensor =
         nullptr; // wait until we find the config
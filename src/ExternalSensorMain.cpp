@@ -1,4 +1,7 @@
+#include "ConfigReconcile.hpp"
+#include "ConfigurationMirror.hpp"
 #include "ExternalSensor.hpp"
+#include "SensorHost.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
 #include "VariantVisitors.hpp"
@@ -59,10 +62,14 @@ static constexpr bool debug = false;
 
 static const char* sensorType = "ExternalSensor";
 
-void updateReaper(boost::container::flat_map<
-                      std::string, std::shared_ptr<ExternalSensor>>& sensors,
-                  boost::asio::steady_timer& timer,
-                  const std::chrono::steady_clock::time_point& now)
+// Configuration the sensors were last built from
+static ConfigReconciler configReconciler;
+
+static void updateReaper(
+    boost::container::flat_map<std::string, std::shared_ptr<ExternalSensor>>&
+        sensors,
+    boost::asio::steady_timer& timer,
+    const std::chrono::steady_clock::time_point& now)
 {
     // First pass, reap all stale sensors
     for (const auto& [name, sensor] : sensors)
@@ -151,7 +158,7 @@ void updateReaper(boost::container::flat_map<
     }
 }
 
-void createSensors(
+static void createSensors(
     sdbusplus::asio::object_server& objectServer,
     boost::container::flat_map<std::string, std::shared_ptr<ExternalSensor>>&
         sensors,
@@ -168,9 +175,19 @@ void createSensors(
     auto getter = std::make_shared<GetSensorConfiguration>(
         dbusConnection,
         [&objectServer, &sensors, &dbusConnection, sensorsChanged,
-         &reaperTimer](const ManagedObjectType& sensorConfigurations) {
+         &reaperTimer](const ManagedObjectType& sensorConfigurations,
+                       bool incomplete) {
         bool firstScan = (sensorsChanged == nullptr);
 
+        // Which sensors to rebuild or remove follows from the configuration
+        // itself, the signalled paths only triggered the rescan
+        configReconciler.update(sensorConfigurations, incomplete);
+        configReconciler.removeSensors(sensors);
+        if (!firstScan)
+        {
+            sensorsChanged->clear();
+        }
+
         for (const std::pair<sdbusplus::message::object_path, SensorData>&
                  sensor : sensorConfigurations)
         {
@@ -273,39 +290,34 @@ void createSensors(
                 continue;
             }
 
-            // on rescans, only update sensors we were signaled by
+            std::vector<thresholds::Threshold> sensorThresholds;
+            bool thresholdsParsed = parseThresholdsFromConfig(sensorData,
+                                                              sensorThresholds);
+
+            // on rescans, only rebuild sensors whose configuration changed,
+            // and update those of which only the thresholds changed
             auto findSensor = sensors.find(sensorName);
-            if (!firstScan && (findSensor != sensors.end()))
+            if (!firstScan && findSensor != sensors.end())
             {
-                std::string suffixName = "/";
-                suffixName += findSensor->second->name;
-                bool found = false;
-                for (auto it = sensorsChanged->begin();
-                     it != sensorsChanged->end(); it++)
+                if (findSensor->second != nullptr &&
+                    (!configReconciler.needsRebuild(interfacePath) ||
+                     (configReconciler.canUpdate(interfacePath) &&
+                      thresholdsParsed &&
+                      findSensor->second->updateThresholds(
+                          std::vector<thresholds::Threshold>(
+                              sensorThresholds)))))
                 {
-                    std::string suffixIt = "/";
-                    suffixIt += *it;
-                    if (suffixIt.ends_with(suffixName))
-                    {
-                        sensorsChanged->erase(it);
-                        findSensor->second = nullptr;
-                        found = true;
-                        if constexpr (debug)
-                        {
-                            std::cerr << "ExternalSensor " << sensorName
-                                      << " change found\n";
-                        }
-                        break;
-                    }
+                    continue;
                 }
-                if (!found)
+                if constexpr (debug)
                 {
-                    continue;
+                    std::cerr << "ExternalSensor " << sensorName
+                              << " change found\n";
                 }
+                findSensor->second = nullptr;
             }
 
-            std::vector<thresholds::Threshold> sensorThresholds;
-            if (!parseThresholdsFromConfig(sensorData, sensorThresholds))
+            if (!thresholdsParsed)
             {
                 std::cerr << "error populating thresholds for " << sensorName
                           << "\n";
@@ -336,34 +348,40 @@ void createSensors(
     getter->getConfiguration(std::vector<std::string>{sensorType});
 }
 
-int main()
+static void startExternalSensor(SensorHost& host)
 {
     if constexpr (debug)
     {
         std::cerr << "ExternalSensor service starting up\n";
     }
 
-    boost::asio::io_context io;
-    auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
-    sdbusplus::asio::object_server objectServer(systemBus, true);
+    boost::asio::io_context& io = host.io;
+    std::shared_ptr<sdbusplus::asio::connection>& systemBus = host.systemBus;
+    sdbusplus::asio::object_server& objectServer = host.objectServer;
 
-    objectServer.add_manager("/xyz/openbmc_project/sensors");
-    systemBus->request_name("xyz.openbmc_project.ExternalSensor");
+    host.addManager("/xyz/openbmc_project/sensors");
+    host.requestName("xyz.openbmc_project.ExternalSensor");
 
-    boost::container::flat_map<std::string, std::shared_ptr<ExternalSensor>>
-        sensors;
+    auto& sensors = host.make<boost::container::flat_map<
+        std::string, std::shared_ptr<ExternalSensor>>>();
     auto sensorsChanged =
         std::make_shared<boost::container::flat_set<std::string>>();
-    boost::asio::steady_timer reaperTimer(io);
+    auto& reaperTimer = host.make<boost::asio::steady_timer>(io);
 
     boost::asio::post(io,
                       [&objectServer, &sensors, &systemBus, &reaperTimer]() {
         createSensors(objectServer, sensors, systemBus, nullptr, reaperTimer);
     });
 
-    boost::asio::steady_timer filterTimer(io);
+    ConfigurationMirror::get(systemBus).onReconcileRescan(
+        [&objectServer, &sensors, &systemBus, sensorsChanged, &reaperTimer]() {
+        createSensors(objectServer, sensors, systemBus, sensorsChanged,
+                      reaperTimer);
+    });
+
+    auto& filterTimer = host.make<boost::asio::steady_timer>(io);
     std::function<void(sdbusplus::message_t&)> eventHandler =
-        [&objectServer, &sensors, &systemBus, &sensorsChanged, &filterTimer,
+        [&objectServer, &sensors, &systemBus, sensorsChanged, &filterTimer,
          &reaperTimer](sdbusplus::message_t& message) mutable {
         if (message.is_method_error())
         {
@@ -399,14 +417,16 @@ int main()
         });
     };
 
-    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches =
-        setupPropertiesChangedMatches(
-            *systemBus, std::to_array<const char*>({sensorType}), eventHandler);
+    host.make<std::vector<std::unique_ptr<sdbusplus::bus::match_t>>>(
+        setupPropertiesChangedMatches(*systemBus,
+                                      std::to_array<const char*>({sensorType}),
+                                      eventHandler));
 
     if constexpr (debug)
     {
         std::cerr << "ExternalSensor service entering main loop\n";
     }
-
-    io.run();
 }
+
+[[maybe_unused]] static const bool registered =
+    registerSensorClass("externalsensor", startExternalSensor);
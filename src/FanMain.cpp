@@ -14,7 +14,12 @@
 // limitations under the License.
 */
 
+#include "BindingCache.hpp"
+#include "ConfigReconcile.hpp"
+#include "ConfigurationMirror.hpp"
 #include "PwmSensor.hpp"
+#include "SensorHost.hpp"
+#include "SysfsCatalog.hpp"
 #include "TachSensor.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
@@ -75,8 +80,12 @@ constexpr const char* redundancyConfiguration =
     "xyz.openbmc_project.Configuration.FanRedundancy";
 static std::regex inputRegex(R"(fan(\d+)_input)");
 
+// Configuration the sensors were last built from
+static ConfigReconciler configReconciler;
+static BindingCache bindingCache(BindingCache::defaultFile("fansensor"));
+
 // todo: power supply fan redundancy
-std::optional<RedundancySensor> systemRedundancy;
+static std::optional<RedundancySensor> systemRedundancy;
 
 static const std::map<std::string, FanTypes> compatibleFanTypes = {
     {"aspeed,ast2400-pwm-tacho", FanTypes::aspeed},
@@ -88,7 +97,7 @@ static const std::map<std::string, FanTypes> compatibleFanTypes = {
     // add compatible string here for new fan type
 };
 
-FanTypes getFanType(const fs::path& parentPath)
+static FanTypes getFanType(const fs::path& parentPath)
 {
     fs::path linkPath = parentPath / "of_node";
     if (!fs::exists(linkPath))
@@ -122,7 +131,7 @@ FanTypes getFanType(const fs::path& parentPath)
 
     return FanTypes::i2c;
 }
-void enablePwm(const fs::path& filePath)
+static void enablePwm(const fs::path& filePath)
 {
     std::fstream enableFile(filePath, std::ios::in | std::ios::out);
     if (!enableFile.good())
@@ -138,7 +147,7 @@ void enablePwm(const fs::path& filePath)
         enableFile << 1;
     }
 }
-bool findPwmfanPath(unsigned int configPwmfanIndex, fs::path& pwmPath)
+static bool findPwmfanPath(unsigned int configPwmfanIndex, fs::path& pwmPath)
 {
     /* Search PWM since pwm-fan had separated
      * PWM from tach directory and 1 channel only*/
@@ -172,7 +181,8 @@ bool findPwmfanPath(unsigned int configPwmfanIndex, fs::path& pwmPath)
     }
     return false;
 }
-bool findPwmPath(const fs::path& directory, unsigned int pwm, fs::path& pwmPath)
+static bool findPwmPath(const fs::path& directory, unsigned int pwm,
+                        fs::path& pwmPath)
 {
     std::error_code ec;
 
@@ -200,7 +210,7 @@ bool findPwmPath(const fs::path& directory, unsigned int pwm, fs::path& pwmPath)
 // enable. The function will locate the corresponding fanN_enable file if it
 // exists. Note that some drivers don't provide this file if the sensors are
 // always enabled.
-void enableFanInput(const fs::path& fanInputPath)
+static void enableFanInput(const fs::path& fanInputPath)
 {
     std::error_code ec;
     std::string path(fanInputPath.string());
@@ -220,7 +230,7 @@ void enableFanInput(const fs::path& fanInputPath)
     enableFile << 1;
 }
 
-void createRedundancySensor(
+static void createRedundancySensor(
     const boost::container::flat_map<std::string, std::shared_ptr<TachSensor>>&
         sensors,
     const std::shared_ptr<sdbusplus::asio::connection>& conn,
@@ -269,7 +279,7 @@ void createRedundancySensor(
         "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
 }
 
-void createSensors(
+static void createSensors(
     boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
     boost::container::flat_map<std::string, std::shared_ptr<TachSensor>>&
         tachSensors,
@@ -278,15 +288,46 @@ void createSensors(
     std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
     const std::shared_ptr<boost::container::flat_set<std::string>>&
         sensorsChanged,
-    size_t retries = 0)
+    size_t retries = 0, bool discoverUnbound = false)
 {
+    std::vector<std::string> types{sensorTypes.begin(), sensorTypes.end()};
     auto getter = std::make_shared<GetSensorConfiguration>(
         dbusConnection,
         [&io, &objectServer, &tachSensors, &pwmSensors, &dbusConnection,
-         sensorsChanged](const ManagedObjectType& sensorConfigurations) {
+         sensorsChanged, types,
+         discoverUnbound](const ManagedObjectType& allConfigurations,
+                          bool incomplete) {
         bool firstScan = sensorsChanged == nullptr;
+
+        // Which sensors to rebuild or remove follows from the configuration
+        // itself, the signalled paths only triggered the rescan
+        configReconciler.update(allConfigurations, incomplete);
+        configReconciler.removeSensors(tachSensors);
+        if (!firstScan)
+        {
+            sensorsChanged->clear();
+        }
+        // The scan following a warm start only looks for the devices of the
+        // objects it left unbound
+        ManagedObjectType unbound;
+        if (discoverUnbound)
+        {
+            unbound = bindingCache.unbound(allConfigurations, types);
+        }
+        const ManagedObjectType& sensorConfigurations =
+            discoverUnbound ? unbound : allConfigurations;
+        // A restart binds to the files of the previous run, as long as they
+        // still belong to the same devices
         std::vector<fs::path> paths;
-        if (!findFiles(fs::path("/sys/class/hwmon"), R"(fan\d+_input)", paths))
+        std::optional<std::vector<fs::path>> cached =
+            bindingCache.warmStart(sensorConfigurations, types);
+        bool warmStart = cached.has_value();
+        if (warmStart)
+        {
+            paths = std::move(*cached);
+        }
+        else if (!SysfsCatalog::get(io).findFiles(
+                     fs::path("/sys/class/hwmon"), R"(fan\d+_input)", paths))
         {
             std::cerr << "No fan sensors in system\n";
             return;
@@ -387,6 +428,7 @@ void createSensors(
                           << "\n";
                 continue;
             }
+            bindingCache.bind(*interfacePath, path);
 
             auto findSensorName = baseConfiguration->second.find("Name");
 
@@ -399,29 +441,28 @@ void createSensors(
             std::string sensorName =
                 std::get<std::string>(findSensorName->second);
 
-            // on rescans, only update sensors we were signaled by
+            // on rescans, only rebuild sensors whose configuration changed
             auto findSensor = tachSensors.find(sensorName);
+            std::vector<thresholds::Threshold> sensorThresholds;
+            bool thresholdsParsed = parseThresholdsFromConfig(*sensorData,
+                                                              sensorThresholds);
             if (!firstScan && findSensor != tachSensors.end())
             {
-                bool found = false;
-                for (auto it = sensorsChanged->begin();
-                     it != sensorsChanged->end(); it++)
-                {
-                    if (it->ends_with(findSensor->second->name))
-                    {
-                        sensorsChanged->erase(it);
-                        findSensor->second = nullptr;
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found)
+                // A change to nothing but the thresholds is taken by the
+                // running sensor
+                if (findSensor->second != nullptr &&
+                    (!configReconciler.needsRebuild(*interfacePath) ||
+                     (configReconciler.canUpdate(*interfacePath) &&
+                      thresholdsParsed &&
+                      findSensor->second->updateThresholds(
+                          std::vector<thresholds::Threshold>(
+                              sensorThresholds)))))
                 {
                     continue;
                 }
+                findSensor->second = nullptr;
             }
-            std::vector<thresholds::Threshold> sensorThresholds;
-            if (!parseThresholdsFromConfig(*sensorData, sensorThresholds))
+            if (!thresholdsParsed)
             {
                 std::cerr << "error populating thresholds for " << sensorName
                           << "\n";
@@ -467,6 +508,8 @@ void createSensors(
             }
 
             PowerState powerState = getPowerState(baseConfiguration->second);
+            PublishPolicy publishPolicy =
+                getPublishPolicy(baseConfiguration->second);
 
             constexpr double defaultMaxReading = 25000;
             constexpr double defaultMinReading = 0;
@@ -574,6 +617,7 @@ void createSensors(
                 std::move(presenceSensor), redundancy, io, sensorName,
                 std::move(sensorThresholds), *interfacePath, limits, powerState,
                 led, ledReg, offset);
+            tachSensor->publishPolicy = publishPolicy;
             tachSensor->setupRead();
 
             if (!pwmPath.empty() && fs::exists(pwmPath) &&
@@ -586,26 +630,36 @@ void createSensors(
         }
 
         createRedundancySensor(tachSensors, dbusConnection, objectServer);
+
+        bindingCache.save(allConfigurations, types, incomplete);
+        if (warmStart &&
+            !bindingCache.unbound(sensorConfigurations, types).empty())
+        {
+            // Some fans were not bound before or their device moved since,
+            // discover those
+            createSensors(
+                io, objectServer, tachSensors, pwmSensors, dbusConnection,
+                std::make_shared<boost::container::flat_set<std::string>>(), 0,
+                true);
+        }
     });
-    getter->getConfiguration(
-        std::vector<std::string>{sensorTypes.begin(), sensorTypes.end()},
-        retries);
+    getter->getConfiguration(types, retries);
 }
 
-int main()
+static void startFanSensor(SensorHost& host)
 {
-    boost::asio::io_context io;
-    auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
-    sdbusplus::asio::object_server objectServer(systemBus, true);
-
-    objectServer.add_manager("/xyz/openbmc_project/sensors");
-    objectServer.add_manager("/xyz/openbmc_project/control");
-    objectServer.add_manager("/xyz/openbmc_project/inventory");
-    systemBus->request_name("xyz.openbmc_project.FanSensor");
-    boost::container::flat_map<std::string, std::shared_ptr<TachSensor>>
-        tachSensors;
-    boost::container::flat_map<std::string, std::unique_ptr<PwmSensor>>
-        pwmSensors;
+    boost::asio::io_context& io = host.io;
+    std::shared_ptr<sdbusplus::asio::connection>& systemBus = host.systemBus;
+    sdbusplus::asio::object_server& objectServer = host.objectServer;
+
+    host.addManager("/xyz/openbmc_project/sensors");
+    host.addManager("/xyz/openbmc_project/control");
+    host.addManager("/xyz/openbmc_project/inventory");
+    host.requestName("xyz.openbmc_project.FanSensor");
+    auto& tachSensors = host.make<
+        boost::container::flat_map<std::string, std::shared_ptr<TachSensor>>>();
+    auto& pwmSensors = host.make<
+        boost::container::flat_map<std::string, std::unique_ptr<PwmSensor>>>();
     auto sensorsChanged =
         std::make_shared<boost::container::flat_set<std::string>>();
 
@@ -614,9 +668,15 @@ int main()
                       nullptr);
     });
 
-    boost::asio::steady_timer filterTimer(io);
+    ConfigurationMirror::get(systemBus).onReconcileRescan(
+        [&, sensorsChanged]() {
+        createSensors(io, objectServer, tachSensors, pwmSensors, systemBus,
+                      sensorsChanged);
+    });
+
+    auto& filterTimer = host.make<boost::asio::steady_timer>(io);
     std::function<void(sdbusplus::message_t&)> eventHandler =
-        [&](sdbusplus::message_t& message) {
+        [&, sensorsChanged](sdbusplus::message_t& message) {
         if (message.is_method_error())
         {
             std::cerr << "callback method error\n";
@@ -642,8 +702,10 @@ int main()
         });
     };
 
-    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches =
-        setupPropertiesChangedMatches(*systemBus, sensorTypes, eventHandler);
+    auto& matches =
+        host.make<std::vector<std::unique_ptr<sdbusplus::bus::match_t>>>(
+            setupPropertiesChangedMatches(*systemBus, sensorTypes,
+                                          eventHandler));
 
     // redundancy sensor
     std::function<void(sdbusplus::message_t&)> redundancyHandler =
@@ -668,6 +730,7 @@ int main()
             << "Successfully registered TAL namespaceInit for Fan Sensor\n";
     }
 #endif
-    io.run();
-    return 0;
 }
+
+[[maybe_unused]] static const bool registered =
+    registerSensorClass("fansensor", startFanSensor);
@@ -14,9 +14,15 @@
 // limitations under the License.
 */
 
+#include "AdaptivePoll.hpp"
+#include "BindingCache.hpp"
+#include "ConfigReconcile.hpp"
+#include "ConfigurationMirror.hpp"
 #include "DeviceMgmt.hpp"
 #include "HwmonTempSensor.hpp"
+#include "SensorHost.hpp"
 #include "SensorPaths.hpp"
+#include "SysfsCatalog.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
 
@@ -66,7 +72,7 @@ static constexpr double minValueTemperature = -128;     // DegreesC
 
 namespace fs = std::filesystem;
 
-static const I2CDeviceTypeMap sensorTypes{
+static constexpr auto sensorTypeTable = makeI2CDeviceTypes({
     {"ADM1021", I2CDeviceType{"adm1021", true}},
     {"DPS310", I2CDeviceType{"dps310", false}},
     {"EMC1403", I2CDeviceType{"emc1403", true}},
@@ -101,9 +107,14 @@ static const I2CDeviceTypeMap sensorTypes{
     {"TMP432", I2CDeviceType{"tpm432", true}},
     {"W83773G", I2CDeviceType{"w83773g", true}},
     {"TMP75C", I2CDeviceType{"tmp75c", true}},
-};
+});
+static constexpr I2CDeviceTypeMap sensorTypes(sensorTypeTable);
+
+// Configuration the sensors were last built from
+static ConfigReconciler configReconciler;
+static BindingCache bindingCache(BindingCache::defaultFile("hwmontempsensor"));
 
-std::string getPlatform()
+static std::string getPlatform()
 {
     std::ifstream osRelease("/etc/os-release");
     if (!osRelease)
@@ -307,21 +318,102 @@ static SensorConfigMap
     return configMap;
 }
 
-void createSensors(
+// Applies thresholds that changed in place, see
+// ConfigReconciler::canUpdate(), to the sensor named sensorName. False if it
+// has to be rebuilt after all.
+static bool updateSensor(
+    boost::container::flat_map<std::string, std::shared_ptr<HwmonTempSensor>>&
+        sensors,
+    const std::string& sensorName, const SensorData& sensorData, int index)
+{
+    auto findSensor = sensors.find(sensorName);
+    if (findSensor == sensors.end() || findSensor->second == nullptr)
+    {
+        return false;
+    }
+    std::vector<thresholds::Threshold> sensorThresholds;
+    if (!parseThresholdsFromConfig(sensorData, sensorThresholds, nullptr,
+                                   &index))
+    {
+        return false;
+    }
+    return findSensor->second->updateThresholds(std::move(sensorThresholds));
+}
+
+// The same for every sensor of a configuration object: the one named
+// sensorName, reading index, and for hwmon devices those of the "Name1",
+// "Name2", ... keys
+static bool updateSensors(
+    boost::container::flat_map<std::string, std::shared_ptr<HwmonTempSensor>>&
+        sensors,
+    const std::string& sensorName, int index, const SensorData& sensorData,
+    const SensorBaseConfigMap& baseConfigMap, bool iio)
+{
+    if (!updateSensor(sensors, sensorName, sensorData, index))
+    {
+        return false;
+    }
+    if (iio)
+    {
+        return true;
+    }
+    for (int i = 1;; i++)
+    {
+        auto findKey = baseConfigMap.find("Name" + std::to_string(i));
+        if (findKey == baseConfigMap.end())
+        {
+            return true;
+        }
+        if (!updateSensor(sensors, std::get<std::string>(findKey->second),
+                          sensorData, i + 1))
+        {
+            return false;
+        }
+    }
+}
+
+static void createSensors(
     boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
     boost::container::flat_map<std::string, std::shared_ptr<HwmonTempSensor>>&
         sensors,
     std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
     const std::shared_ptr<boost::container::flat_set<std::string>>&
         sensorsChanged,
-    bool activateOnly)
+    bool activateOnly, bool discoverUnbound = false)
 {
+    std::vector<std::string> types;
+    types.reserve(sensorTypes.size());
+    for (const auto& [type, dt] : sensorTypes)
+    {
+        types.emplace_back(type);
+    }
     auto getter = std::make_shared<GetSensorConfiguration>(
         dbusConnection,
         [&io, &objectServer, &sensors, &dbusConnection, sensorsChanged,
-         activateOnly](const ManagedObjectType& sensorConfigurations) {
+         activateOnly, types,
+         discoverUnbound](const ManagedObjectType& allConfigurations,
+                          bool incomplete) {
         bool firstScan = sensorsChanged == nullptr;
 
+        // Which sensors to rebuild or remove follows from the configuration
+        // itself, the signalled paths only triggered the rescan
+        configReconciler.update(allConfigurations, incomplete);
+        configReconciler.removeSensors(sensors);
+        if (!firstScan)
+        {
+            sensorsChanged->clear();
+        }
+
+        // The scan following a warm start only looks for the devices of the
+        // objects it left unbound
+        ManagedObjectType unbound;
+        if (discoverUnbound)
+        {
+            unbound = bindingCache.unbound(allConfigurations, types);
+        }
+        const ManagedObjectType& sensorConfigurations =
+            discoverUnbound ? unbound : allConfigurations;
+
         SensorConfigMap configMap = buildSensorConfigMap(sensorConfigurations);
 
         auto devices = instantiateDevices(sensorConfigurations, sensors,
@@ -336,11 +428,27 @@ void createSensors(
         //     /sys/bus/iio/devices/iio:device1/in_temp_input
         //     /sys/bus/iio/devices/iio:device1/in_pressure_input
         std::vector<fs::path> paths;
-        fs::path root("/sys/bus/iio/devices");
-        findFiles(root, R"(in_temp\d*_(input|raw))", paths);
-        findFiles(root, R"(in_pressure\d*_(input|raw))", paths);
-        findFiles(root, R"(in_humidityrelative\d*_(input|raw))", paths);
-        findFiles(fs::path("/sys/class/hwmon"), R"(temp\d+_input)", paths);
+        const std::string iioRoot = sysfsPath("/sys/bus/iio/devices");
+        // A restart binds to the files of the previous run, as long as they
+        // still belong to the same devices
+        std::optional<std::vector<fs::path>> cached =
+            bindingCache.warmStart(sensorConfigurations, types);
+        bool warmStart = cached.has_value();
+        if (warmStart)
+        {
+            paths = std::move(*cached);
+        }
+        else
+        {
+            fs::path root(iioRoot);
+            SysfsCatalog& catalog = SysfsCatalog::get(io);
+            catalog.findFiles(root, R"(in_temp\d*_(input|raw))", paths);
+            catalog.findFiles(root, R"(in_pressure\d*_(input|raw))", paths);
+            catalog.findFiles(root, R"(in_humidityrelative\d*_(input|raw))",
+                              paths);
+            catalog.findFiles(fs::path(sysfsPath("/sys/class/hwmon")),
+                              R"(temp\d+_input)", paths);
+        }
 
         // iterate through all found temp and pressure sensors,
         // and try to match them with configuration
@@ -353,7 +461,7 @@ void createSensors(
 
             std::string deviceName;
             std::error_code ec;
-            if (pathStr.starts_with("/sys/bus/iio/devices"))
+            if (pathStr.starts_with(iioRoot))
             {
                 device = fs::canonical(directory, ec);
                 if (ec)
@@ -390,6 +498,7 @@ void createSensors(
             }
 
             const std::string& interfacePath = findSensorCfg->second.sensorPath;
+            bindingCache.bind(interfacePath, path);
             auto thisSensorParameters = getSensorParameters(path,
                                                             interfacePath);
             auto findI2CDev = devices.find(interfacePath);
@@ -447,27 +556,20 @@ void createSensors(
 
             std::string sensorName =
                 std::get<std::string>(findSensorName->second);
-            // on rescans, only update sensors we were signaled by
+            // on rescans, only rebuild sensors whose configuration changed
             auto findSensor = sensors.find(sensorName);
             if (!firstScan && findSensor != sensors.end())
             {
-                bool found = false;
-                auto it = sensorsChanged->begin();
-                while (it != sensorsChanged->end())
-                {
-                    if (it->ends_with(findSensor->second->name))
-                    {
-                        it = sensorsChanged->erase(it);
-                        findSensor->second = nullptr;
-                        found = true;
-                        break;
-                    }
-                    ++it;
-                }
-                if (!found)
+                if (findSensor->second != nullptr &&
+                    (!configReconciler.needsRebuild(interfacePath) ||
+                     (configReconciler.canUpdate(interfacePath) &&
+                      updateSensors(sensors, sensorName, index, sensorData,
+                                    baseConfigMap,
+                                    pathStr.starts_with(iioRoot)))))
                 {
                     continue;
                 }
+                findSensor->second = nullptr;
             }
 
             std::vector<thresholds::Threshold> sensorThresholds;
@@ -481,6 +583,9 @@ void createSensors(
 
             float pollRate = getPollRate(baseConfigMap, pollRateDefault);
             PowerState readState = getPowerState(baseConfigMap);
+            PublishPolicy publishPolicy = getPublishPolicy(baseConfigMap);
+            std::optional<AdaptivePoll> adaptivePoll =
+                getAdaptivePoll(baseConfigMap, pollRate);
 
             auto permitSet = getPermitSet(baseConfigMap);
             auto& sensor = sensors[sensorName];
@@ -490,7 +595,7 @@ void createSensors(
             }
             auto hwmonFile = getFullHwmonFilePath(directory.string(), "temp1",
                                                   permitSet);
-            if (pathStr.starts_with("/sys/bus/iio/devices"))
+            if (pathStr.starts_with(iioRoot))
             {
                 hwmonFile = pathStr;
             }
@@ -507,6 +612,8 @@ void createSensors(
                         io, sensorName, std::move(sensorThresholds),
                         thisSensorParameters, pollRate, interfacePath,
                         readState, i2cDev, sensorPhysicalContext);
+                    sensor->publishPolicy = publishPolicy;
+                    sensor->adaptivePoll = adaptivePoll;
                     sensor->setupRead();
                 }
             }
@@ -530,7 +637,7 @@ void createSensors(
                 hwmonFile = getFullHwmonFilePath(directory.string(),
                                                  "temp" + std::to_string(i + 1),
                                                  permitSet);
-                if (pathStr.starts_with("/sys/bus/iio/devices"))
+                if (pathStr.starts_with(iioRoot))
                 {
                     continue;
                 }
@@ -568,6 +675,8 @@ void createSensors(
                             std::move(thresholds), thisSensorParameters,
                             pollRate, interfacePath, readState, i2cDev,
                             context);
+                        sensor->publishPolicy = publishPolicy;
+                        sensor->adaptivePoll = adaptivePoll;
                         sensor->setupRead();
                     }
                 }
@@ -581,16 +690,23 @@ void createSensors(
                 configMap.erase(findSensorCfg);
             }
         }
+
+        bindingCache.save(allConfigurations, types, incomplete);
+        if (warmStart &&
+            !bindingCache.unbound(sensorConfigurations, types).empty())
+        {
+            // Some sensors were not bound before or their device moved
+            // since, discover those
+            createSensors(
+                io, objectServer, sensors, dbusConnection,
+                std::make_shared<boost::container::flat_set<std::string>>(),
+                false, true);
+        }
     });
-    std::vector<std::string> types(sensorTypes.size());
-    for (const auto& [type, dt] : sensorTypes)
-    {
-        types.push_back(type);
-    }
     getter->getConfiguration(types);
 }
 
-void interfaceRemoved(
+static void interfaceRemoved(
     sdbusplus::message_t& message,
     boost::container::flat_map<std::string, std::shared_ptr<HwmonTempSensor>>&
         sensors)
@@ -647,17 +763,17 @@ static void powerStateChanged(
     }
 }
 
-int main()
+static void startHwmonTempSensor(SensorHost& host)
 {
-    boost::asio::io_context io;
-    auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
-    sdbusplus::asio::object_server objectServer(systemBus, true);
-    objectServer.add_manager("/xyz/openbmc_project/sensors");
-    objectServer.add_manager("/xyz/openbmc_project/inventory");
-    systemBus->request_name("xyz.openbmc_project.HwmonTempSensor");
-
-    boost::container::flat_map<std::string, std::shared_ptr<HwmonTempSensor>>
-        sensors;
+    boost::asio::io_context& io = host.io;
+    std::shared_ptr<sdbusplus::asio::connection>& systemBus = host.systemBus;
+    sdbusplus::asio::object_server& objectServer = host.objectServer;
+    host.addManager("/xyz/openbmc_project/sensors");
+    host.addManager("/xyz/openbmc_project/inventory");
+    host.requestName("xyz.openbmc_project.HwmonTempSensor");
+
+    auto& sensors = host.make<boost::container::flat_map<
+        std::string, std::shared_ptr<HwmonTempSensor>>>();
     auto sensorsChanged =
         std::make_shared<boost::container::flat_set<std::string>>();
 
@@ -671,9 +787,15 @@ int main()
         createSensors(io, objectServer, sensors, systemBus, nullptr, false);
     });
 
-    boost::asio::steady_timer filterTimer(io);
+    ConfigurationMirror::get(systemBus).onReconcileRescan(
+        [&, sensorsChanged]() {
+        createSensors(io, objectServer, sensors, systemBus, sensorsChanged,
+                      false);
+    });
+
+    auto& filterTimer = host.make<boost::asio::steady_timer>(io);
     std::function<void(sdbusplus::message_t&)> eventHandler =
-        [&](sdbusplus::message_t& message) {
+        [&, sensorsChanged](sdbusplus::message_t& message) {
         if (message.is_method_error())
         {
             std::cerr << "callback method error\n";
@@ -699,8 +821,10 @@ int main()
         });
     };
 
-    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches =
-        setupPropertiesChangedMatches(*systemBus, sensorTypes, eventHandler);
+    auto& matches =
+        host.make<std::vector<std::unique_ptr<sdbusplus::bus::match_t>>>(
+            setupPropertiesChangedMatches(*systemBus, sensorTypes,
+                                          eventHandler));
     setupManufacturingModeMatch(*systemBus);
 
     // Watch for entity-manager to remove configuration interfaces
@@ -722,5 +846,7 @@ int main()
         std::cout << "Successfully registerd TAL namespaceInit for hwmontemp\n";
     }
 #endif
-    io.run();
 }
+
+[[maybe_unused]] static const bool registered =
+    registerSensorClass("hwmontempsensor", startHwmonTempSensor);
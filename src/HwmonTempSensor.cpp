@@ -159,6 +159,7 @@ void HwmonTempSensor::setupRead()
     }
 
     std::weak_ptr<HwmonTempSensor> weakRef = weak_from_this();
+    markReadStarted();
     inputDev.async_read_some_at(
         0, boost::asio::buffer(readBuf),
         [weakRef](const boost::system::error_code& ec, std::size_t bytesRead) {
@@ -173,7 +174,8 @@ void HwmonTempSensor::setupRead()
 void HwmonTempSensor::restartRead()
 {
     std::weak_ptr<HwmonTempSensor> weakRef = weak_from_this();
-    waitTimer.expires_after(std::chrono::milliseconds(sensorPollMs));
+    waitTimer.expires_after(
+        std::chrono::milliseconds(nextPollMs(sensorPollMs)));
     waitTimer.async_wait([weakRef](const boost::system::error_code& ec) {
         if (ec == boost::asio::error::operation_aborted)
         {
@@ -1,11 +1,12 @@
 #pragma once
 
 #include "DeviceMgmt.hpp"
+#include "PollScheduler.hpp"
+#include "SysfsReader.hpp"
 #include "Thresholds.hpp"
 #include "sensor.hpp"
 #include "sharedMemUtils.hpp"
 
-#include <boost/asio/random_access_file.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
 #include <string>
@@ -57,8 +58,8 @@ class HwmonTempSensor :
     std::array<char, 128> readBuf{};
     std::shared_ptr<I2CDevice> i2cDevice;
     sdbusplus::asio::object_server& objServer;
-    boost::asio::random_access_file inputDev;
-    boost::asio::steady_timer waitTimer;
+    SysfsFile inputDev;
+    PollTimer waitTimer;
     std::string path;
     double offsetValue;
     double scaleValue;
@@ -0,0 +1,230 @@
+#include "I2CBus.hpp"
+
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C"
+{
+#include <i2c/smbus.h>
+#include <linux/i2c-dev.h>
+}
+
+I2CBus::I2CBus(std::string path) : path(std::move(path)) {}
+
+I2CBus::~I2CBus()
+{
+    close();
+}
+
+int I2CBus::open()
+{
+    if (busFd >= 0)
+    {
+        return 0;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    busFd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (busFd < 0)
+    {
+        return -errno;
+    }
+    // Without the bits every typed helper reports EOPNOTSUPP
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    if (ioctl(busFd, I2C_FUNCS, &functionality) < 0)
+    {
+        functionality = 0;
+    }
+    return 0;
+}
+
+void I2CBus::close()
+{
+    if (busFd >= 0)
+    {
+        ::close(busFd);
+    }
+    busFd = -1;
+    functionality = 0;
+    selected = -1;
+}
+
+int I2CBus::result(int rc)
+{
+    if (rc == -ENODEV)
+    {
+        close();
+    }
+    return rc;
+}
+
+int I2CBus::setAddress(uint16_t address, bool force)
+{
+    if (selected == address)
+    {
+        return 0;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    if (ioctl(busFd, force ? I2C_SLAVE_FORCE : I2C_SLAVE, address) < 0)
+    {
+        selected = -1;
+        return result(-errno);
+    }
+    selected = address;
+    return 0;
+}
+
+int I2CBus::readByteData(uint16_t address, uint8_t command, bool force)
+{
+    if (!supports(I2C_FUNC_SMBUS_READ_BYTE_DATA))
+    {
+        return -EOPNOTSUPP;
+    }
+    int rc = setAddress(address, force);
+    if (rc < 0)
+    {
+        return rc;
+    }
+    rc = i2c_smbus_read_byte_data(busFd, command);
+    return rc < 0 ? result(-errno) : rc;
+}
+
+int I2CBus::writeByteData(uint16_t address, uint8_t command, uint8_t value,
+                          bool force)
+{
+    if (!supports(I2C_FUNC_SMBUS_WRITE_BYTE_DATA))
+    {
+        return -EOPNOTSUPP;
+    }
+    int rc = setAddress(address, force);
+    if (rc < 0)
+    {
+        return rc;
+    }
+    rc = i2c_smbus_write_byte_data(busFd, command, value);
+    return rc < 0 ? result(-errno) : 0;
+}
+
+int I2CBus::readWordData(uint16_t address, uint8_t command, bool force)
+{
+    if (!supports(I2C_FUNC_SMBUS_READ_WORD_DATA))
+    {
+        return -EOPNOTSUPP;
+    }
+    int rc = setAddress(address, force);
+    if (rc < 0)
+    {
+        return rc;
+    }
+    rc = i2c_smbus_read_word_data(busFd, command);
+    return rc < 0 ? result(-errno) : rc;
+}
+
+int I2CBus::readBlockData(uint16_t address, uint8_t command,
+                          std::vector<uint8_t>& block, bool force)
+{
+    block.clear();
+    if (!supports(I2C_FUNC_SMBUS_READ_BLOCK_DATA))
+    {
+        return -EOPNOTSUPP;
+    }
+    int rc = setAddress(address, force);
+    if (rc < 0)
+    {
+        return rc;
+    }
+    block.resize(I2C_SMBUS_BLOCK_MAX);
+    rc = i2c_smbus_read_block_data(busFd, command, block.data());
+    if (rc < 0)
+    {
+        block.clear();
+        return result(-errno);
+    }
+    block.resize(rc);
+    return rc;
+}
+
+int I2CBus::write(uint16_t address, std::span<const uint8_t> bytes)
+{
+    if (!supports(I2C_FUNC_I2C))
+    {
+        return -EOPNOTSUPP;
+    }
+    int rc = setAddress(address);
+    if (rc < 0)
+    {
+        return rc;
+    }
+    ssize_t written = ::write(busFd, bytes.data(), bytes.size());
+    if (written < 0)
+    {
+        return result(-errno);
+    }
+    return written == static_cast<ssize_t>(bytes.size()) ? 0 : -EIO;
+}
+
+int I2CBus::read(uint16_t address, std::span<uint8_t> bytes)
+{
+    if (!supports(I2C_FUNC_I2C))
+    {
+        return -EOPNOTSUPP;
+    }
+    int rc = setAddress(address);
+    if (rc < 0)
+    {
+        return rc;
+    }
+    ssize_t got = ::read(busFd, bytes.data(), bytes.size());
+    if (got < 0)
+    {
+        return result(-errno);
+    }
+    return got == static_cast<ssize_t>(bytes.size()) ? 0 : -EIO;
+}
+
+int I2CBus::transfer(std::span<i2c_msg> messages)
+{
+    if (!supports(I2C_FUNC_I2C))
+    {
+        return -EOPNOTSUPP;
+    }
+    i2c_rdwr_ioctl_data args{messages.data(),
+                             static_cast<uint32_t>(messages.size())};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    if (ioctl(busFd, I2C_RDWR, &args) < 0)
+    {
+        return result(-errno);
+    }
+    return 0;
+}
+
+int I2CBus::transferOrSplit(std::span<i2c_msg> messages)
+{
+    if (!splitTransfers)
+    {
+        int rc = transfer(messages);
+        if (rc != -EOPNOTSUPP || messages.size() < 2 ||
+            !supports(I2C_FUNC_I2C))
+        {
+            return rc;
+        }
+        splitTransfers = true;
+    }
+    for (i2c_msg& message : messages)
+    {
+        int rc = transfer(std::span(&message, 1));
+        if (rc < 0)
+        {
+            return rc;
+        }
+    }
+    return 0;
+}
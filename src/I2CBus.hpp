@@ -0,0 +1,77 @@
+#pragma once
+
+#include <linux/i2c.h>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// A /dev/i2c-N device as used from the worker of its bus in I2CExecutor. The
+// device stays open across transactions, its I2C_FUNCS bits are read once
+// when it is opened, and the target address is only set again when it
+// changes, so a register read costs the one ioctl doing the transfer.
+//
+// The typed helpers return the value read, or 0 for writes, and a negative
+// errno on failure: -EOPNOTSUPP if the adapter lacks the function. A device
+// that reports ENODEV is closed and opened again by the next transaction.
+class I2CBus
+{
+  public:
+    explicit I2CBus(std::string path);
+    ~I2CBus();
+
+    I2CBus(const I2CBus&) = delete;
+    I2CBus(I2CBus&&) = delete;
+    I2CBus& operator=(const I2CBus&) = delete;
+    I2CBus& operator=(I2CBus&&) = delete;
+
+    // Opens the device unless it is open already
+    int open();
+    void close();
+
+    int fd() const
+    {
+        return busFd;
+    }
+
+    bool supports(unsigned long funcs) const
+    {
+        return (functionality & funcs) == funcs;
+    }
+
+    // Targets address for the SMBus helpers and read()/write(). With force
+    // the address is claimed even if a kernel driver is bound to it.
+    int setAddress(uint16_t address, bool force = false);
+
+    int readByteData(uint16_t address, uint8_t command, bool force = false);
+    int writeByteData(uint16_t address, uint8_t command, uint8_t value,
+                      bool force = false);
+    int readWordData(uint16_t address, uint8_t command, bool force = false);
+    // Resizes block to the length the device returned
+    int readBlockData(uint16_t address, uint8_t command,
+                      std::vector<uint8_t>& block, bool force = false);
+
+    // Plain transfers to the target, failing unless every byte went through
+    int write(uint16_t address, std::span<const uint8_t> bytes);
+    int read(uint16_t address, std::span<uint8_t> bytes);
+
+    // One I2C_RDWR combined transaction, the addresses are in the messages
+    int transfer(std::span<i2c_msg> messages);
+
+    // As transfer(), but once the adapter rejects a combined transaction the
+    // messages go out one per I2C_RDWR instead, for devices that do not need
+    // the repeated starts in between
+    int transferOrSplit(std::span<i2c_msg> messages);
+
+  private:
+    int result(int rc);
+
+    std::string path;
+    int busFd = -1;
+    unsigned long functionality = 0;
+    // Address set with I2C_SLAVE or I2C_SLAVE_FORCE, -1 if none
+    int selected = -1;
+    // The adapter refused a combined transaction of several messages
+    bool splitTransfers = false;
+};
@@ -0,0 +1,274 @@
+#include "I2CExecutor.hpp"
+
+#include "I2CBus.hpp"
+#include "Utils.hpp"
+#include "VariantVisitors.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+boost::asio::execution_context::id I2CExecutor::id;
+
+I2CPolicy getI2CPolicy(const SensorBaseConfigMap& cfg,
+                       const I2CPolicy& defaults)
+{
+    I2CPolicy policy = defaults;
+    auto findPriority = cfg.find("I2CPriority");
+    if (findPriority != cfg.end())
+    {
+        std::string priority = std::visit(VariantToStringVisitor(),
+                                           findPriority->second);
+        if (priority == "Critical")
+        {
+            policy.priority = I2CPriority::critical;
+        }
+        else if (priority == "Normal")
+        {
+            policy.priority = I2CPriority::normal;
+        }
+        else if (priority == "Bulk")
+        {
+            policy.priority = I2CPriority::bulk;
+        }
+        else
+        {
+            std::cerr << "Ignoring invalid I2CPriority " << priority << "\n";
+        }
+    }
+    auto findDeadline = cfg.find("I2CDeadline");
+    if (findDeadline != cfg.end())
+    {
+        float seconds = std::visit(VariantToFloatVisitor(),
+                                   findDeadline->second);
+        if (std::isfinite(seconds) && seconds >= 0.0F)
+        {
+            policy.deadline = std::chrono::milliseconds(
+                static_cast<int64_t>(seconds * 1000));
+        }
+        else
+        {
+            std::cerr << "Ignoring invalid I2CDeadline " << seconds << "\n";
+        }
+    }
+    return policy;
+}
+
+std::chrono::milliseconds i2cSharedDeadline(std::chrono::milliseconds a,
+                                            std::chrono::milliseconds b)
+{
+    if (a.count() == 0 || b.count() == 0)
+    {
+        return std::chrono::milliseconds(0);
+    }
+    return std::max(a, b);
+}
+
+static int openEventFd()
+{
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+    }
+    return fd;
+}
+
+I2CExecutor::I2CExecutor(boost::asio::io_context& io) :
+    boost::asio::execution_context::service(io), io(io),
+    doneEvent(io, openEventFd())
+{}
+
+I2CExecutor::~I2CExecutor()
+{
+    shutdown();
+}
+
+I2CExecutor& I2CExecutor::get(boost::asio::io_context& io)
+{
+    return boost::asio::use_service<I2CExecutor>(io);
+}
+
+void I2CExecutor::submit(unsigned bus, const I2CPolicy& policy,
+                         I2CTransfer&& transfer, I2CCompletion&& completion)
+{
+    std::unique_ptr<Bus>& queue = buses[bus];
+    if (!queue)
+    {
+        queue = std::make_unique<Bus>();
+        Bus& started = *queue;
+        queue->worker = std::jthread(
+            [this, path{devicePrefix + std::to_string(bus)},
+             &started](const std::stop_token& stop) {
+            runWorker(path, started, stop);
+        });
+    }
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (policy.deadline.count() > 0)
+    {
+        deadline = std::chrono::steady_clock::now() + policy.deadline;
+    }
+    {
+        std::lock_guard<std::mutex> guard(queue->lock);
+        queue->jobs[static_cast<size_t>(policy.priority)].emplace_back(
+            std::move(transfer), std::move(completion), deadline);
+    }
+    queue->wake.notify_one();
+    outstanding++;
+    waitDone();
+}
+
+void I2CExecutor::runWorker(const std::string& path, Bus& queue,
+                            const std::stop_token& stop)
+{
+    I2CBus bus(path);
+    while (true)
+    {
+        std::unique_lock<std::mutex> guard(queue.lock);
+        auto next = queue.jobs.end();
+        if (!queue.wake.wait(guard, stop, [&queue, &next] {
+            next = std::find_if(queue.jobs.begin(), queue.jobs.end(),
+                                [](const std::deque<Job>& jobs) {
+                return !jobs.empty();
+            });
+            return next != queue.jobs.end();
+        }))
+        {
+            return;
+        }
+        Job job = std::move(next->front());
+        next->pop_front();
+        guard.unlock();
+
+        std::vector<uint8_t> data;
+        int rc = i2cExpired;
+        if (std::chrono::steady_clock::now() < job.deadline)
+        {
+            rc = bus.open();
+            if (rc == 0)
+            {
+                rc = job.transfer(bus, data);
+            }
+            if (rc == i2cExpired)
+            {
+                rc = -EIO;
+            }
+        }
+        finish({std::move(job.completion), rc, std::move(data)});
+    }
+}
+
+void I2CExecutor::finish(Done&& result)
+{
+    {
+        std::lock_guard<std::mutex> guard(doneLock);
+        done.push_back(std::move(result));
+    }
+    uint64_t one = 1;
+    // Can only fail if the counter would overflow, and then it is set anyway
+    (void)::write(doneEvent.native_handle(), &one, sizeof(one));
+}
+
+void I2CExecutor::waitDone()
+{
+    if (waiting || outstanding == 0)
+    {
+        return;
+    }
+    waiting = true;
+    doneEvent.async_read_some(
+        boost::asio::buffer(&doneEvents, sizeof(doneEvents)),
+        [this](const boost::system::error_code& ec, size_t /*bytes*/) {
+        waiting = false;
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        if (ec && ec != boost::asio::error::would_block)
+        {
+            std::cerr << "I2C completion event error " << ec.message()
+                      << "\n";
+        }
+        runDone();
+    });
+}
+
+void I2CExecutor::runDone()
+{
+    std::vector<Done> results;
+    {
+        std::lock_guard<std::mutex> guard(doneLock);
+        results.swap(done);
+    }
+    outstanding -= results.size();
+    for (Done& result : results)
+    {
+        result.completion(result.rc, result.data);
+    }
+    waitDone();
+}
+
+void I2CExecutor::shutdown()
+{
+    for (auto& [bus, queue] : buses)
+    {
+        queue->worker.request_stop();
+    }
+    // Waits for transfers in progress; queued ones are dropped
+    buses.clear();
+    done.clear();
+    doneEvent.close();
+}
+
+I2CChannel::I2CChannel(boost::asio::io_context& io, unsigned bus,
+                       const I2CPolicy& policy) :
+    executor(I2CExecutor::get(io)), busId(bus), busPolicy(policy)
+{}
+
+void I2CChannel::require(I2CPriority priority)
+{
+    busPolicy.priority = std::min(busPolicy.priority, priority);
+}
+
+void I2CChannel::submit(I2CTransfer&& transfer, I2CCompletion&& completion)
+{
+    submit(std::move(transfer), std::move(completion), busPolicy.deadline);
+}
+
+void I2CChannel::submit(I2CTransfer&& transfer, I2CCompletion&& completion,
+                        std::chrono::milliseconds deadline)
+{
+    executor.submit(busId, {.priority = busPolicy.priority,
+                            .deadline = deadline},
+                    std::move(transfer),
+                    [alive = std::weak_ptr<int>(lifetime),
+                     completion = std::move(completion)](
+                        int rc, std::vector<uint8_t>& data) {
+        if (alive.expired())
+        {
+            return;
+        }
+        completion(rc, data);
+    });
+}
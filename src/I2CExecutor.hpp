@@ -0,0 +1,203 @@
+#pragma once
+
+#include "I2CBus.hpp"
+#include "Utils.hpp"
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs on the worker of a bus with /dev/i2c-<bus> open. Returns a negative
+// errno on failure; anything else, together with what it left in data, is
+// handed to the completion. It must not touch state owned by the io_context.
+using I2CTransfer = std::function<int(I2CBus& bus, std::vector<uint8_t>& data)>;
+
+// Runs on the io_context with the result of a transfer
+using I2CCompletion = std::function<void(int rc, std::vector<uint8_t>& data)>;
+
+// Order in which the worker of a bus takes queued transfers: a transfer
+// never waits behind queued ones of a less urgent class, only behind the one
+// already on the bus.
+enum class I2CPriority : uint8_t
+{
+    // Reads that must not be held up, like intrusion detection
+    critical,
+    normal,
+    // Slow inventory and status polls
+    bulk,
+};
+
+struct I2CPolicy
+{
+    I2CPriority priority = I2CPriority::normal;
+    // How long a transfer may wait in the queue. One that has not started by
+    // then is dropped and completes with i2cExpired; zero waits forever.
+    std::chrono::milliseconds deadline{0};
+};
+
+// Result of a transfer dropped for its queue deadline, which says nothing
+// about the device. No transfer completes with it: one failing with it is
+// reported as -EIO, so that -ETIMEDOUT from an adapter timing out on the
+// device is never taken for a dropped transfer.
+constexpr int i2cExpired = -ECANCELED;
+
+// Deadline of one transfer done for requests with deadlines a and b. It is
+// dropped only once every request would have been, so it has none if either
+// has none.
+std::chrono::milliseconds i2cSharedDeadline(std::chrono::milliseconds a,
+                                            std::chrono::milliseconds b);
+
+// The policy in I2CPriority ("Critical", "Normal" or "Bulk") and I2CDeadline,
+// in seconds like PollRate, of a sensor's configuration, defaults for what
+// it does not set
+I2CPolicy getI2CPolicy(const SensorBaseConfigMap& cfg,
+                       const I2CPolicy& defaults);
+
+// Per io_context executor for the sensors that talk to devices through
+// /dev/i2c-N directly. Every bus gets a worker thread of its own that runs
+// the transfers queued for it in order, so a slow or clock-stretching device
+// only holds up the transactions on its bus, buses proceed in parallel, and
+// the io_context never blocks in open() or ioctl(). The worker keeps its bus
+// open for the life of the process and takes transfers by I2CPriority.
+//
+// The io_context is built without thread support, so the workers never
+// touch it: they queue their results here and signal an eventfd, which the
+// io_context reads while transfers are outstanding.
+class I2CExecutor : public boost::asio::execution_context::service
+{
+  public:
+    using key_type = I2CExecutor;
+
+    static boost::asio::execution_context::id id;
+
+    explicit I2CExecutor(boost::asio::io_context& io);
+    ~I2CExecutor() override;
+
+    I2CExecutor(const I2CExecutor&) = delete;
+    I2CExecutor(I2CExecutor&&) = delete;
+    I2CExecutor& operator=(const I2CExecutor&) = delete;
+    I2CExecutor& operator=(I2CExecutor&&) = delete;
+
+    static I2CExecutor& get(boost::asio::io_context& io);
+
+    // Queues a transfer on the worker of bus, starting the worker on first
+    // use. The completion runs on the io_context.
+    void submit(unsigned bus, const I2CPolicy& policy, I2CTransfer&& transfer,
+                I2CCompletion&& completion);
+
+    // Where bus devices are opened, "/dev/i2c-" followed by the bus number
+    // unless tests point it elsewhere before the first submit()
+    void setDevicePrefix(const std::string& prefix)
+    {
+        devicePrefix = prefix;
+    }
+
+  private:
+    struct Job
+    {
+        I2CTransfer transfer;
+        I2CCompletion completion;
+        // time_point::max() if there is none
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    struct Done
+    {
+        I2CCompletion completion;
+        int rc;
+        std::vector<uint8_t> data;
+    };
+
+    struct Bus
+    {
+        std::mutex lock;
+        std::condition_variable_any wake;
+        // One queue per I2CPriority
+        std::array<std::deque<Job>, 3> jobs;
+        // Declared last, so it is joined before the queue goes away
+        std::jthread worker;
+    };
+
+    void shutdown() override;
+
+    void runWorker(const std::string& path, Bus& queue,
+                   const std::stop_token& stop);
+    void finish(Done&& result);
+    void waitDone();
+    void runDone();
+
+    boost::asio::io_context& io;
+    std::string devicePrefix = "/dev/i2c-";
+
+    // Results queued by the workers, guarded by doneLock
+    std::mutex doneLock;
+    std::vector<Done> done;
+    // Written by a worker for every result it queues
+    boost::asio::posix::stream_descriptor doneEvent;
+    uint64_t doneEvents = 0;
+    // Only touched on the io_context. The eventfd is read while some
+    // transfer has not completed, which keeps io_context::run() going for
+    // exactly as long as there are transfers in flight.
+    size_t outstanding = 0;
+    bool waiting = false;
+
+    // Declared last, so the workers are joined before the rest goes away
+    std::map<unsigned, std::unique_ptr<Bus>> buses;
+};
+
+// A sensor's handle on the bus its device sits on. Completions of transfers
+// still pending when the channel is destroyed are dropped rather than run,
+// so sensors need not outlive their transactions.
+class I2CChannel
+{
+  public:
+    I2CChannel(boost::asio::io_context& io, unsigned bus,
+               const I2CPolicy& policy = {});
+    ~I2CChannel() = default;
+
+    I2CChannel(const I2CChannel&) = delete;
+    I2CChannel(I2CChannel&&) = delete;
+    I2CChannel& operator=(const I2CChannel&) = delete;
+    I2CChannel& operator=(I2CChannel&&) = delete;
+
+    void submit(I2CTransfer&& transfer, I2CCompletion&& completion);
+    // As above, but the transfer waits in the queue for deadline rather
+    // than the deadline of the channel's policy
+    void submit(I2CTransfer&& transfer, I2CCompletion&& completion,
+                std::chrono::milliseconds deadline);
+
+    unsigned bus() const
+    {
+        return busId;
+    }
+
+    const I2CPolicy& policy() const
+    {
+        return busPolicy;
+    }
+
+    // Makes the channel at least as urgent as priority, for a channel
+    // shared by sensors that each bring their own. Their deadlines stay with
+    // their requests, see submit().
+    void require(I2CPriority priority);
+
+  private:
+    I2CExecutor& executor;
+    unsigned busId;
+    I2CPolicy busPolicy;
+    std::shared_ptr<int> lifetime = std::make_shared<int>(0);
+};
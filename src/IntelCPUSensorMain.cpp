@@ -15,6 +15,8 @@
 */
 
 #include "IntelCPUSensor.hpp"
+#include "SensorInstrumentation.hpp"
+#include "SysfsCatalog.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
 #include "VariantVisitors.hpp"
@@ -298,8 +300,9 @@ bool createSensors(boost::asio::io_context& io,
 
         auto directory = hwmonNamePath.parent_path();
         std::vector<fs::path> inputPaths;
-        if (!findFiles(directory, R"((temp|power)\d+_(input|average|cap)$)",
-                       inputPaths, 0))
+        if (!SysfsCatalog::get(io).findFiles(
+                directory, R"((temp|power)\d+_(input|average|cap)$)",
+                inputPaths, 0))
         {
             std::cerr << "No temperature sensors in system\n";
             continue;
@@ -683,23 +686,10 @@ void detectCpuAsync(
     });
 }
 
-bool getCpuConfig(const std::shared_ptr<sdbusplus::asio::connection>& systemBus,
-                  boost::container::flat_set<CPUConfig>& cpuConfigs,
-                  ManagedObjectType& sensorConfigs,
-                  sdbusplus::asio::object_server& objectServer)
+bool parseCpuConfig(const ManagedObjectType& sensorConfigs,
+                    boost::container::flat_set<CPUConfig>& cpuConfigs,
+                    sdbusplus::asio::object_server& objectServer)
 {
-    bool useCache = false;
-    sensorConfigs.clear();
-    // use new data the first time, then refresh
-    for (const char* type : sensorTypes)
-    {
-        if (!getSensorConfiguration(type, systemBus, sensorConfigs, useCache))
-        {
-            return false;
-        }
-        useCache = true;
-    }
-
     // check PECI client addresses and names from CPU configuration
     // before starting ping operation
     for (const char* type : sensorTypes)
@@ -788,6 +778,36 @@ bool getCpuConfig(const std::shared_ptr<sdbusplus::asio::connection>& systemBus,
     return false;
 }
 
+// Fetches the CPU configuration, then starts pinging the CPUs it names
+void getCpuConfig(boost::asio::steady_timer& pingTimer,
+                  boost::asio::steady_timer& creationTimer,
+                  boost::asio::io_context& io,
+                  sdbusplus::asio::object_server& objectServer,
+                  std::shared_ptr<sdbusplus::asio::connection>& systemBus,
+                  boost::container::flat_set<CPUConfig>& cpuConfigs,
+                  ManagedObjectType& sensorConfigs)
+{
+    auto getter = std::make_shared<GetSensorConfiguration>(
+        systemBus,
+        [&pingTimer, &creationTimer, &io, &objectServer, &systemBus,
+         &cpuConfigs, &sensorConfigs](const ManagedObjectType& configs,
+                                      bool incomplete) {
+        if (incomplete)
+        {
+            std::cerr << "error communicating to entity manager\n";
+            return;
+        }
+        sensorConfigs = configs;
+        if (parseCpuConfig(sensorConfigs, cpuConfigs, objectServer))
+        {
+            detectCpuAsync(pingTimer, creationTimer, io, objectServer,
+                           systemBus, cpuConfigs, sensorConfigs);
+        }
+    });
+    getter->getConfiguration(
+        std::vector<std::string>(sensorTypes.begin(), sensorTypes.end()));
+}
+
 int main()
 {
     boost::asio::io_context io;
@@ -796,6 +816,7 @@ int main()
 
     sdbusplus::asio::object_server objectServer(systemBus, true);
     objectServer.add_manager("/xyz/openbmc_project/sensors");
+    registerSensorInstrumentationControl(objectServer);
     boost::asio::steady_timer pingTimer(io);
     boost::asio::steady_timer creationTimer(io);
     boost::asio::steady_timer filterTimer(io);
@@ -808,11 +829,8 @@ int main()
             return; // we're being canceled
         }
 
-        if (getCpuConfig(systemBus, cpuConfigs, sensorConfigs, objectServer))
-        {
-            detectCpuAsync(pingTimer, creationTimer, io, objectServer,
-                           systemBus, cpuConfigs, sensorConfigs);
-        }
+        getCpuConfig(pingTimer, creationTimer, io, objectServer, systemBus,
+                     cpuConfigs, sensorConfigs);
     });
 
     std::function<void(sdbusplus::message_t&)> eventHandler =
@@ -836,12 +854,8 @@ int main()
                 return; // we're being canceled
             }
 
-            if (getCpuConfig(systemBus, cpuConfigs, sensorConfigs,
-                             objectServer))
-            {
-                detectCpuAsync(pingTimer, creationTimer, io, objectServer,
-                               systemBus, cpuConfigs, sensorConfigs);
-            }
+            getCpuConfig(pingTimer, creationTimer, io, objectServer,
+                         systemBus, cpuConfigs, sensorConfigs);
         });
     };
 
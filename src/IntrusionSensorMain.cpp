@@ -15,6 +15,7 @@
 */
 
 #include "ChassisIntrusionSensor.hpp"
+#include "I2CExecutor.hpp"
 #include "Utils.hpp"
 
 #include <boost/asio/error.hpp>
@@ -59,22 +60,11 @@ static const std::map<std::string, std::string> compatibleHwmonNames = {
     // use the available Hwmon class.
 };
 
-static void createSensorsFromConfig(
+static void createSensorFromConfigurations(
     boost::asio::io_context& io, sdbusplus::asio::object_server& objServer,
-    const std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
+    const ManagedObjectType& sensorConfigurations,
     std::shared_ptr<ChassisIntrusionSensor>& pSensor)
 {
-    // find matched configuration according to sensor type
-    ManagedObjectType sensorConfigurations;
-    bool useCache = false;
-
-    if (!getSensorConfiguration(sensorType, dbusConnection,
-                                sensorConfigurations, useCache))
-    {
-        std::cerr << "error communicating to entity manager\n";
-        return;
-    }
-
     const SensorData* sensorData = nullptr;
     const std::pair<std::string, SensorBaseConfigMap>* baseConfiguration =
         nullptr;
@@ -197,7 +187,9 @@ static void createSensorsFromConfig(
                     int busId = std::get<uint64_t>(findBus->second);
                     int slaveAddr = std::get<uint64_t>(findAddress->second);
                     pSensor = std::make_shared<ChassisIntrusionPchSensor>(
-                        autoRearm, io, objServer, busId, slaveAddr);
+                        autoRearm, io, objServer, busId, slaveAddr,
+                        getI2CPolicy(baseConfiguration->second,
+                                     {.priority = I2CPriority::critical}));
                     pSensor->start();
                     if (debug)
                     {
@@ -233,6 +225,27 @@ static void createSensorsFromConfig(
     }
 }
 
+static void createSensorsFromConfig(
+    boost::asio::io_context& io, sdbusplus::asio::object_server& objServer,
+    const std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
+    std::shared_ptr<ChassisIntrusionSensor>& pSensor)
+{
+    // find matched configuration according to sensor type
+    auto getter = std::make_shared<GetSensorConfiguration>(
+        dbusConnection,
+        [&io, &objServer, &pSensor](
+            const ManagedObjectType& sensorConfigurations, bool incomplete) {
+        if (incomplete)
+        {
+            std::cerr << "error communicating to entity manager\n";
+            return;
+        }
+        createSensorFromConfigurations(io, objServer, sensorConfigurations,
+                                       pSensor);
+    });
+    getter->getConfiguration(std::vector<std::string>{sensorType});
+}
+
 static constexpr bool debugLanLeash = false;
 boost::container::flat_map<int, bool> lanStatusMap;
 boost::container::flat_map<int, std::string> lanInfoMap;
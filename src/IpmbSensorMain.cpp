@@ -1,5 +1,6 @@
 #include "IpmbSDRSensor.hpp"
 #include "IpmbSensor.hpp"
+#include "SensorInstrumentation.hpp"
 #include "Utils.hpp"
 
 #include <boost/asio/error.hpp>
@@ -100,6 +101,7 @@ int main()
     auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
     sdbusplus::asio::object_server objectServer(systemBus, true);
     objectServer.add_manager("/xyz/openbmc_project/sensors");
+    registerSensorInstrumentationControl(objectServer);
     systemBus->request_name("xyz.openbmc_project.IpmbSensor");
 
     initCmdTimer = std::make_unique<boost::asio::steady_timer>(io);
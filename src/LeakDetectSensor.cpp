@@ -377,12 +377,13 @@ void LeakDetectSensor::handleResponse(const boost::system::error_code& err,
         internalValueSet = false;
 
 #ifdef NVIDIA_SHMEM
-        std::string objPath = sensorInterface->get_object_path();
-        std::string ifaceName = sensorInterface->get_interface_name();
-        std::string parentChassis =
-            sdbusplus::message::object_path(configurationPath).parent_path();
-
-        updateTelemetry(objPath, ifaceName, "Value", newValue, parentChassis);
+        if (!telemetry.isBound())
+        {
+            telemetry.bind(sensorInterface->get_object_path(),
+                           sensorInterface->get_interface_name(),
+                           configurationPath);
+        }
+        telemetry.update("Value", newValue);
 #endif
     }
     restartRead();
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "DeviceMgmt.hpp"
+#include "PollScheduler.hpp"
 #include "Thresholds.hpp"
 #include "sensor.hpp"
 
@@ -63,7 +64,7 @@ class LeakDetectSensor : public std::enable_shared_from_this<LeakDetectSensor>
     sdbusplus::asio::object_server& objServer;
     std::shared_ptr<sdbusplus::asio::connection> dbusConnection;
     boost::asio::random_access_file inputDev;
-    boost::asio::steady_timer waitTimer;
+    PollTimer waitTimer;
     boost::asio::steady_timer shutdownTimer;
     std::string name;
     std::string readPath;
@@ -87,6 +88,9 @@ class LeakDetectSensor : public std::enable_shared_from_this<LeakDetectSensor>
     std::shared_ptr<sdbusplus::asio::dbus_interface> opStateInterface;
     std::shared_ptr<sdbusplus::asio::dbus_interface> stateAssociation;
     double detectorValue = std::numeric_limits<double>::quiet_NaN();
+#ifdef NVIDIA_SHMEM
+    TelemetryHandle telemetry;
+#endif
 
     void handleResponse(const boost::system::error_code& err, size_t bytesRead);
     void restartRead();
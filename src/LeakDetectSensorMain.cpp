@@ -31,9 +31,11 @@
 
 static constexpr float pollRateDefault = 0.1;
 
-static const I2CDeviceTypeMap i2CDeviceTypes{
+static constexpr auto i2CDeviceTypeTable = makeI2CDeviceTypes({
     {"MAX1363", I2CDeviceType{"max1363", false}},
-    {"ADS7142", I2CDeviceType{"ads7142", false}}};
+    {"ADS7142", I2CDeviceType{"ads7142", false}},
+});
+static constexpr I2CDeviceTypeMap i2CDeviceTypes(i2CDeviceTypeTable);
 
 static std::shared_ptr<I2CDeviceParams>
     getI2CParams(const SensorBaseConfigMap& cfg)
@@ -16,16 +16,13 @@
 
 #include "MCUTempSensor.hpp"
 
+#include "I2CExecutor.hpp"
+#include "SensorInstrumentation.hpp"
 #include "SensorPaths.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
 #include "sensor.hpp"
 
-#include <fcntl.h>
-#include <linux/i2c.h>
-#include <sys/ioctl.h>
-#include <unistd.h>
-
 #include <boost/asio/error.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/post.hpp>
@@ -40,6 +37,7 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -47,12 +45,6 @@
 #include <utility>
 #include <vector>
 
-extern "C"
-{
-#include <i2c/smbus.h>
-#include <linux/i2c-dev.h>
-}
-
 constexpr const bool debug = false;
 
 constexpr const char* sensorType = "MCUTempSensor";
@@ -68,12 +60,12 @@ MCUTempSensor::MCUTempSensor(std::shared_ptr<sdbusplus::asio::connection>& conn,
                              sdbusplus::asio::object_server& objectServer,
                              std::vector<thresholds::Threshold>&& thresholdData,
                              uint8_t busId, uint8_t mcuAddress,
-                             uint8_t tempReg) :
+                             uint8_t tempReg, const I2CPolicy& i2cPolicy) :
     Sensor(escapeName(sensorName), std::move(thresholdData),
            sensorConfiguration, "MCUTempSensor", false, false,
            mcuTempMaxReading, mcuTempMinReading, conn),
     busId(busId), mcuAddress(mcuAddress), tempReg(tempReg),
-    objectServer(objectServer), waitTimer(io)
+    objectServer(objectServer), waitTimer(io), i2c(io, busId, i2cPolicy)
 {
     sensorInterface = objectServer.add_interface(
         "/xyz/openbmc_project/sensors/temperature/" + name,
@@ -113,56 +105,6 @@ void MCUTempSensor::checkThresholds()
     thresholds::checkThresholds(this);
 }
 
-int MCUTempSensor::getMCURegsInfoWord(uint8_t regs, int32_t* pu32data) const
-{
-    std::string i2cBus = "/dev/i2c-" + std::to_string(busId);
-
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    int fd = open(i2cBus.c_str(), O_RDWR);
-    if (fd < 0)
-    {
-        std::cerr << " unable to open i2c device" << i2cBus << "  err=" << fd
-                  << "\n";
-        return -1;
-    }
-
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(fd, I2C_SLAVE_FORCE, mcuAddress) < 0)
-    {
-        std::cerr << " unable to set device address\n";
-        close(fd);
-        return -1;
-    }
-
-    unsigned long funcs = 0;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(fd, I2C_FUNCS, &funcs) < 0)
-    {
-        std::cerr << " not support I2C_FUNCS\n";
-        close(fd);
-        return -1;
-    }
-
-    if ((funcs & I2C_FUNC_SMBUS_READ_WORD_DATA) == 0U)
-    {
-        std::cerr << " not support I2C_FUNC_SMBUS_READ_WORD_DATA\n";
-        close(fd);
-        return -1;
-    }
-
-    *pu32data = i2c_smbus_read_word_data(fd, regs);
-    close(fd);
-
-    if (*pu32data < 0)
-    {
-        std::cerr << " read word data failed at " << static_cast<int>(regs)
-                  << "\n";
-        return -1;
-    }
-
-    return 0;
-}
-
 void MCUTempSensor::read()
 {
     static constexpr size_t pollTime = 1; // in seconds
@@ -179,24 +121,39 @@ void MCUTempSensor::read()
             std::cerr << "timer error\n";
             return;
         }
-        int32_t temp = 0;
-        int ret = getMCURegsInfoWord(tempReg, &temp);
-        if (ret >= 0)
-        {
-            double v = static_cast<double>(temp) / 1000;
-            if constexpr (debug)
+        i2c.submit([address{mcuAddress}, regs{tempReg}](
+                       I2CBus& bus, std::vector<uint8_t>& /*data*/) {
+            return bus.readWordData(address, regs, true);
+        },
+                   [this](int rc, std::vector<uint8_t>& /*data*/) {
+            if (rc == i2cExpired)
             {
-                std::cerr << "Value update to " << v << "raw reading "
-                          << static_cast<int>(temp) << "\n";
+                // Dropped for waiting too long behind other transfers on a
+                // busy bus, which says nothing about the MCU. Keep the last
+                // reading.
+                read();
+                return;
             }
-            updateValue(v);
-        }
-        else
-        {
-            std::cerr << "Invalid read getMCURegsInfoWord\n";
-            incrementError();
-        }
-        read();
+            if (rc >= 0)
+            {
+                double v = static_cast<double>(rc) / 1000;
+                if constexpr (debug)
+                {
+                    std::cerr << "Value update to " << v << "raw reading "
+                              << rc << "\n";
+                }
+                updateValue(v);
+            }
+            else
+            {
+                std::cerr << "Invalid read of MCU register "
+                          << static_cast<int>(tempReg) << " on bus "
+                          << static_cast<int>(busId) << ": " << strerror(-rc)
+                          << "\n";
+                incrementError();
+            }
+            read();
+        });
     });
 }
 
@@ -260,7 +217,8 @@ void createSensors(
 
                 sensor = std::make_unique<MCUTempSensor>(
                     dbusConnection, io, name, path, objectServer,
-                    std::move(sensorThresholds), busId, mcuAddress, tempReg);
+                    std::move(sensorThresholds), busId, mcuAddress, tempReg,
+                    getI2CPolicy(cfg, {.priority = I2CPriority::bulk}));
 
                 sensor->init();
             }
@@ -276,6 +234,7 @@ int main()
     auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
     sdbusplus::asio::object_server objectServer(systemBus, true);
     objectServer.add_manager("/xyz/openbmc_project/sensors");
+    registerSensorInstrumentationControl(objectServer);
 
     systemBus->request_name("xyz.openbmc_project.MCUTempSensor");
 
@@ -1,4 +1,6 @@
 #pragma once
+#include "I2CExecutor.hpp"
+
 #include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
 #include <sensor.hpp>
@@ -16,7 +18,8 @@ struct MCUTempSensor : public Sensor
                   const std::string& sensorConfiguration,
                   sdbusplus::asio::object_server& objectServer,
                   std::vector<thresholds::Threshold>&& thresholdData,
-                  uint8_t busId, uint8_t mcuAddress, uint8_t tempReg);
+                  uint8_t busId, uint8_t mcuAddress, uint8_t tempReg,
+                  const I2CPolicy& i2cPolicy);
     ~MCUTempSensor() override;
 
     void checkThresholds() override;
@@ -28,7 +31,7 @@ struct MCUTempSensor : public Sensor
     uint8_t tempReg;
 
   private:
-    int getMCURegsInfoWord(uint8_t regs, int32_t* pu32data) const;
     sdbusplus::asio::object_server& objectServer;
     boost::asio::steady_timer waitTimer;
+    I2CChannel i2c;
 };
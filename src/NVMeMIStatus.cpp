@@ -1,10 +1,7 @@
 #include "NVMeMIStatus.hpp"
 
 #include "../src/Utils.hpp"
-
-#include <fcntl.h>
-#include <sys/ioctl.h>
-#include <unistd.h>
+#include "I2CExecutor.hpp"
 
 #include <boost/asio/error.hpp>
 #include <boost/asio/io_context.hpp>
@@ -29,12 +26,6 @@
 #include <tuple>
 #include <vector>
 
-extern "C"
-{
-#include <i2c/smbus.h>
-#include <linux/i2c-dev.h>
-}
-
 // NVMe Status command
 const static constexpr size_t nvmeStatusCmd = 0x00;
 
@@ -48,14 +39,15 @@ NVMeMIStatus::NVMeMIStatus(sdbusplus::asio::object_server& objectServer,
                            const std::string& sensorName,
                            const std::string& sensorConfiguration,
                            unsigned int pollRate, uint8_t busId,
-                           uint8_t nvmeAddress) :
+                           uint8_t nvmeAddress, const I2CPolicy& i2cPolicy) :
     StatusInterface(
         static_cast<sdbusplus::bus::bus&>(*conn),
         ("/xyz/openbmc_project/sensors/drive/" + escapeName(sensorName))
             .c_str(),
         StatusInterface::action::defer_emit),
     name(sensorName), sensorPollSec(pollRate), busId(busId),
-    nvmeAddress(nvmeAddress), objServer(objectServer), waitTimer(io)
+    nvmeAddress(nvmeAddress), objServer(objectServer), waitTimer(io),
+    i2c(io, busId, i2cPolicy)
 {
     sensorInterface = objectServer.add_interface(
         ("/xyz/openbmc_project/sensors/drive/" + escapeName(sensorName)),
@@ -80,59 +72,6 @@ NVMeMIStatus::~NVMeMIStatus()
     objServer.remove_interface(sensorInterface);
 }
 
-int NVMeMIStatus::getNVMeInfo(int bus, uint8_t addr, std::vector<uint8_t>& resp)
-{
-    int32_t size = 0;
-    int32_t statusCmd = nvmeStatusCmd;
-
-    std::string i2cBus = "/dev/i2c-" + std::to_string(bus);
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    int dev = open(i2cBus.c_str(), O_RDWR);
-    if (dev < 0)
-    {
-        std::cerr << " unable to open i2c device " << i2cBus << ": "
-                  << strerror(errno) << "\n";
-        return -1;
-    }
-
-    /* Select the target device */
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (::ioctl(dev, I2C_SLAVE, addr) == -1)
-    {
-        std::cerr << "Failed to configure device address 0x" << std::hex
-                  << (int)addr << " for bus " << std::dec << bus << ": "
-                  << strerror(errno) << "\n";
-        close(dev);
-        return -1;
-    }
-
-    /* Issue the NVMe MI basic command */
-    resp.reserve(UINT8_MAX + 1);
-    // Read NVM Subsystem Health Status data from NVMe M2 drive
-    // If command success, M2 drive present
-    // If 5th bit of data 1 is not set, drive fault occured
-    // If all bits of data 2 is not set, Predictive failure occured
-    size = i2c_smbus_read_block_data(dev, statusCmd, resp.data());
-    if (size < 0)
-    {
-        // Ignore the error message when the drive is not present.
-        if (errno == ENXIO)
-        {
-            close(dev);
-            return -1;
-        }
-        std::cerr << "Failed to read block data from device 0x" << std::hex
-                  << (int)addr << " on bus " << std::dec << bus << ": "
-                  << strerror(errno) << "\n";
-        close(dev);
-        return -1;
-    }
-
-    close(dev);
-
-    return 0;
-}
-
 void NVMeMIStatus::monitor()
 {
     waitTimer.expires_after(std::chrono::seconds(sensorPollSec));
@@ -148,52 +87,79 @@ void NVMeMIStatus::monitor()
             std::cerr << "timer error\n";
             return;
         }
-        std::vector<uint8_t> resp{};
-        int32_t statusMask = nvmeDriveFaultMask;
-        int32_t statusFailure = nvmeDriveFailureStatus;
-        int ret = getNVMeInfo(busId, nvmeAddress, resp);
-        if (ret >= 0)
+        // Read NVM Subsystem Health Status data from NVMe M2 drive
+        // If command success, M2 drive present
+        // If 5th bit of data 1 is not set, drive fault occured
+        // If all bits of data 2 is not set, Predictive failure occured
+        i2c.submit([address{nvmeAddress}](I2CBus& bus,
+                                          std::vector<uint8_t>& resp) {
+            return bus.readBlockData(address, nvmeStatusCmd, resp);
+        },
+                   [this](int rc, std::vector<uint8_t>& resp) {
+            updateStatus(rc, resp);
+            // Start read for next status
+            monitor();
+        });
+    });
+}
+
+void NVMeMIStatus::updateStatus(int rc, const std::vector<uint8_t>& resp)
+{
+    // A read dropped for waiting too long on a busy bus says nothing about
+    // the drive, keep its presence and state as they were
+    if (rc == i2cExpired)
+    {
+        return;
+    }
+    int32_t statusMask = nvmeDriveFaultMask;
+    int32_t statusFailure = nvmeDriveFailureStatus;
+    if (rc >= 0 && resp.size() > 2)
+    {
+        sdbusplus::xyz::openbmc_project::Inventory::server::Item::present(
+            true);
+        if ((resp[1] & statusMask) == 0)
         {
-            sdbusplus::xyz::openbmc_project::Inventory::server::Item::present(
-                true);
-            if ((resp[1] & statusMask) == 0)
-            {
-                sdbusplus::xyz::openbmc_project::State::Decorator::server::
-                    OperationalStatus::state(
-                        sdbusplus::xyz::openbmc_project::State::Decorator::
-                            server::OperationalStatus::StateType::Fault);
-            }
-            else
-            {
-                sdbusplus::xyz::openbmc_project::State::Decorator::server::
-                    OperationalStatus::state(
-                        sdbusplus::xyz::openbmc_project::State::Decorator::
-                            server::OperationalStatus::StateType::None);
-            }
-            if (resp[2] == statusFailure)
-            {
-                sdbusplus::xyz::openbmc_project::State::Decorator::server::
-                    OperationalStatus::functional(false);
-            }
-            else
-            {
-                sdbusplus::xyz::openbmc_project::State::Decorator::server::
-                    OperationalStatus::functional(true);
-            }
+            sdbusplus::xyz::openbmc_project::State::Decorator::server::
+                OperationalStatus::state(
+                    sdbusplus::xyz::openbmc_project::State::Decorator::
+                        server::OperationalStatus::StateType::Fault);
         }
         else
         {
-            // reset states to default, if drive not present
-            sdbusplus::xyz::openbmc_project::Inventory::server::Item::present(
-                false);
             sdbusplus::xyz::openbmc_project::State::Decorator::server::
                 OperationalStatus::state(
-                    sdbusplus::xyz::openbmc_project::State::Decorator::server::
-                        OperationalStatus::StateType::None);
+                    sdbusplus::xyz::openbmc_project::State::Decorator::
+                        server::OperationalStatus::StateType::None);
+        }
+        if (resp[2] == statusFailure)
+        {
+            sdbusplus::xyz::openbmc_project::State::Decorator::server::
+                OperationalStatus::functional(false);
+        }
+        else
+        {
             sdbusplus::xyz::openbmc_project::State::Decorator::server::
                 OperationalStatus::functional(true);
         }
-        // Start read for next status
-        monitor();
-    });
+    }
+    else
+    {
+        // Ignore the error message when the drive is not present.
+        if (rc < 0 && rc != -ENXIO)
+        {
+            std::cerr << "Failed to read block data from device 0x"
+                      << std::hex << static_cast<int>(nvmeAddress)
+                      << " on bus " << std::dec << static_cast<int>(busId)
+                      << ": " << strerror(-rc) << "\n";
+        }
+        // reset states to default, if drive not present
+        sdbusplus::xyz::openbmc_project::Inventory::server::Item::present(
+            false);
+        sdbusplus::xyz::openbmc_project::State::Decorator::server::
+            OperationalStatus::state(
+                sdbusplus::xyz::openbmc_project::State::Decorator::server::
+                    OperationalStatus::StateType::None);
+        sdbusplus::xyz::openbmc_project::State::Decorator::server::
+            OperationalStatus::functional(true);
+    }
 }
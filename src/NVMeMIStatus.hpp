@@ -1,5 +1,6 @@
 #pragma once
 
+#include "I2CExecutor.hpp"
 #include "Utils.hpp"
 
 #include <boost/asio/io_context.hpp>
@@ -37,7 +38,8 @@ class NVMeMIStatus :
                  std::shared_ptr<sdbusplus::asio::connection>& conn,
                  boost::asio::io_context& io, const std::string& sensorName,
                  const std::string& sensorConfiguration, unsigned int pollRate,
-                 uint8_t busId, uint8_t nvmeAddress);
+                 uint8_t busId, uint8_t nvmeAddress,
+                 const I2CPolicy& i2cPolicy);
     ~NVMeMIStatus() override;
 
     void monitor();
@@ -48,8 +50,10 @@ class NVMeMIStatus :
     uint8_t nvmeAddress;
 
   private:
+    void updateStatus(int rc, const std::vector<uint8_t>& resp);
+
     std::shared_ptr<sdbusplus::asio::dbus_interface> sensorInterface;
     sdbusplus::asio::object_server& objServer;
-    static int getNVMeInfo(int bus, uint8_t addr, std::vector<uint8_t>& resp);
     boost::asio::steady_timer waitTimer;
+    I2CChannel i2c;
 };
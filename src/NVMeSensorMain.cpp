@@ -17,6 +17,7 @@
 #include "NVMeBasicContext.hpp"
 #include "NVMeContext.hpp"
 #include "NVMeSensor.hpp"
+#include "SensorInstrumentation.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
 #include "VariantVisitors.hpp"
@@ -278,6 +279,7 @@ int main()
     systemBus->request_name("xyz.openbmc_project.NVMeSensor");
     sdbusplus::asio::object_server objectServer(systemBus, true);
     objectServer.add_manager("/xyz/openbmc_project/sensors");
+    registerSensorInstrumentationControl(objectServer);
 
     boost::asio::post(io,
                       [&]() { createSensors(io, objectServer, systemBus); });
@@ -1,11 +1,7 @@
 #include "NVMeStatus.hpp"
 
 #include "../src/Utils.hpp"
-
-#include <fcntl.h>
-#include <linux/i2c.h>
-#include <sys/ioctl.h>
-#include <unistd.h>
+#include "I2CExecutor.hpp"
 
 #include <boost/asio/error.hpp>
 #include <boost/asio/io_context.hpp>
@@ -27,19 +23,14 @@
 #include <tuple>
 #include <vector>
 
-extern "C"
-{
-#include <i2c/smbus.h>
-#include <linux/i2c-dev.h>
-}
-
 NVMeStatus::NVMeStatus(sdbusplus::asio::object_server& objectServer,
                        std::shared_ptr<sdbusplus::asio::connection>& conn,
                        boost::asio::io_context& io,
                        const std::string& sensorName,
                        const std::string& sensorConfiguration,
                        unsigned int pollRate, uint8_t index, uint8_t busId,
-                       uint8_t cpldAddress, uint8_t statusReg) :
+                       uint8_t cpldAddress, uint8_t statusReg,
+                       const I2CPolicy& i2cPolicy) :
     ItemInterface(
         static_cast<sdbusplus::bus::bus&>(*conn),
         ("/xyz/openbmc_project/sensors/drive/" + escapeName(sensorName))
@@ -47,7 +38,7 @@ NVMeStatus::NVMeStatus(sdbusplus::asio::object_server& objectServer,
         ItemInterface::action::defer_emit),
     name(sensorName), sensorPollSec(pollRate), index(index), busId(busId),
     cpldAddress(cpldAddress), statusReg(statusReg), objServer(objectServer),
-    waitTimer(io)
+    waitTimer(io), i2c(io, busId, i2cPolicy)
 {
     sensorInterface = objectServer.add_interface(
         ("/xyz/openbmc_project/sensors/drive/" + escapeName(sensorName)),
@@ -72,57 +63,6 @@ NVMeStatus::~NVMeStatus()
     objServer.remove_interface(sensorInterface);
 }
 
-int NVMeStatus::getCPLDRegsInfo(uint8_t regs, int16_t* pu16data) const
-{
-    std::string i2cBus = "/dev/i2c-" + std::to_string(busId);
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    int fd = open(i2cBus.c_str(), O_RDWR);
-
-    if (fd < 0)
-    {
-        std::cerr << " unable to open i2c device " << i2cBus << ": "
-                  << strerror(errno) << "\n";
-        return -1;
-    }
-
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(fd, I2C_SLAVE_FORCE, cpldAddress) < 0)
-    {
-        std::cerr << " unable to set device address: " << strerror(errno)
-                  << "\n";
-        close(fd);
-        return -1;
-    }
-
-    unsigned long funcs = 0;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(fd, I2C_FUNCS, &funcs) < 0)
-    {
-        std::cerr << "not support I2C_FUNCS: " << strerror(errno) << "\n";
-        close(fd);
-        return -1;
-    }
-
-    if ((funcs & I2C_FUNC_SMBUS_READ_WORD_DATA) == 0U)
-    {
-        std::cerr << " not support I2C_FUNC_SMBUS_READ_WORD_DATA\n";
-        close(fd);
-        return -1;
-    }
-
-    *pu16data = i2c_smbus_read_word_data(fd, regs);
-    close(fd);
-
-    if (*pu16data < 0)
-    {
-        std::cerr << " read word data failed at " << static_cast<int>(regs)
-                  << ": " << strerror(errno) << "\n";
-        return -1;
-    }
-
-    return 0;
-}
-
 void NVMeStatus::monitor()
 {
     waitTimer.expires_after(std::chrono::seconds(sensorPollSec));
@@ -138,26 +78,41 @@ void NVMeStatus::monitor()
             std::cerr << "timer error\n";
             return;
         }
-        int16_t status = 0;
-        int ret = getCPLDRegsInfo(statusReg, &status);
-        if (ret >= 0)
-        {
-            if ((status & (1 << index)) != 0)
+        i2c.submit([address{cpldAddress}, regs{statusReg}](
+                       I2CBus& bus, std::vector<uint8_t>& /*data*/) {
+            return bus.readWordData(address, regs, true);
+        },
+                   [this](int rc, std::vector<uint8_t>& /*data*/) {
+            // A read dropped for waiting too long on a busy bus says
+            // nothing about the drive, keep its presence as it was
+            if (rc == i2cExpired)
+            {
+                monitor();
+                return;
+            }
+            if (rc >= 0)
             {
-                sdbusplus::xyz::openbmc_project::Inventory::server::Item::
-                    present(false);
+                auto status = static_cast<int16_t>(rc);
+                if ((status & (1 << index)) != 0)
+                {
+                    sdbusplus::xyz::openbmc_project::Inventory::server::Item::
+                        present(false);
+                }
+                else
+                {
+                    sdbusplus::xyz::openbmc_project::Inventory::server::Item::
+                        present(true);
+                }
             }
             else
             {
-                sdbusplus::xyz::openbmc_project::Inventory::server::Item::
-                    present(true);
+                std::cerr << "Invalid read of CPLD register "
+                          << static_cast<int>(statusReg) << " on bus "
+                          << static_cast<int>(busId) << ": " << strerror(-rc)
+                          << "\n";
             }
-        }
-        else
-        {
-            std::cerr << "Invalid read getCPLDRegsInfo\n";
-        }
-        // Start read for next status
-        monitor();
+            // Start read for next status
+            monitor();
+        });
     });
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "I2CExecutor.hpp"
 #include "Utils.hpp"
 
 #include <boost/asio/io_context.hpp>
@@ -35,7 +36,7 @@ class NVMeStatus :
                boost::asio::io_context& io, const std::string& sensorName,
                const std::string& sensorConfiguration, unsigned int pollRate,
                uint8_t index, uint8_t busId, uint8_t cpldAddress,
-               uint8_t statusReg);
+               uint8_t statusReg, const I2CPolicy& i2cPolicy);
     ~NVMeStatus() override;
 
     void monitor();
@@ -50,6 +51,6 @@ class NVMeStatus :
   private:
     std::shared_ptr<sdbusplus::asio::dbus_interface> sensorInterface;
     sdbusplus::asio::object_server& objServer;
-    int getCPLDRegsInfo(uint8_t regs, int16_t* pu16data) const;
     boost::asio::steady_timer waitTimer;
+    I2CChannel i2c;
 };
@@ -1,4 +1,5 @@
 #include "../src/Utils.hpp"
+#include "I2CExecutor.hpp"
 #include "NVMeMIStatus.hpp"
 #include "NVMeStatus.hpp"
 #include "VariantVisitors.hpp"
@@ -174,6 +175,10 @@ void createSensors(
             unsigned int address = std::visit(VariantToUnsignedIntVisitor(),
                                               findAddress->second);
 
+            // Status polls, they must not hold up other reads on the bus
+            I2CPolicy i2cPolicy = getI2CPolicy(
+                baseConfiguration->second, {.priority = I2CPriority::bulk});
+
             if (sensor.second.find(
                     "xyz.openbmc_project.Configuration.Nvmecpld") !=
                 sensor.second.end())
@@ -199,7 +204,7 @@ void createSensors(
                     u2SensorConstruct = std::make_shared<NVMeStatus>(
                         objectServer, dbusConnection, io, nameWithIndex,
                         *interfacePath, pollRate, nvmeIndex, busId, address,
-                        reg);
+                        reg, i2cPolicy);
                 }
             }
             else if (sensor.second.find(
@@ -211,7 +216,7 @@ void createSensors(
 
                 m2SensorConstruct = std::make_shared<NVMeMIStatus>(
                     objectServer, dbusConnection, io, sensorName,
-                    *interfacePath, pollRate, busId, address);
+                    *interfacePath, pollRate, busId, address, i2cPolicy);
             }
         }
     });
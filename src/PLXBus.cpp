@@ -0,0 +1,189 @@
+#include "PLXBus.hpp"
+
+#include "I2CBus.hpp"
+#include "I2CExecutor.hpp"
+
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+// The format for I2C Register Write and Read as per Atlas
+/* Register write :-
+ * <slave address>,<CommandByte1>,<CommandByte2>,<CommandByte3>,CommandByte4>,
+ * <DataByte1>,<DataByte2>,<DataByte3>,<DataByte4>
+ */
+/*Register Read
+ * packet 1 for selecting register to read
+ * <slave address>,<CommandByte1>,<CommandByte2>,<CommandByte3>,<CommandByte4>
+ * packet 2 to read 32-bit register
+ * <slave address>,<BufferByet3>,<BufferByte2>,<BufferByte1>,<BufferByte0>
+ */
+
+// Setting register to read, then getting the temperature reading
+static constexpr std::array<PLXWrite, 8> readRegValues{{
+    {0x03, 0x58, 0x3c, 0x40, 0xff, 0xe7, 0x85, 0x04},
+    {0x03, 0x58, 0x3c, 0x41, 0x20, 0x06, 0x53, 0xe8},
+    {0x03, 0x58, 0x3c, 0x42, 0x00, 0x00, 0x00, 0x01},
+    {0x03, 0x58, 0x3c, 0x40, 0xff, 0xe7, 0x85, 0x34},
+    {0x03, 0x58, 0x3c, 0x42, 0x00, 0x00, 0x00, 0x02},
+    {0x03, 0x00, 0x3c, 0xb3, 0x00, 0x00, 0x00, 0x07},
+    {0x03, 0x58, 0x3c, 0x40, 0xff, 0xe7, 0x85, 0x38},
+    {0x03, 0x58, 0x3c, 0x42, 0x00, 0x00, 0x00, 0x02},
+}};
+
+static constexpr std::array<PLXSelect, 2> selectRegs{{
+    {0x04, 0x58, 0x3c, 0x42},
+    {0x04, 0x58, 0x3c, 0x41},
+}};
+
+PLXReadCommands::PLXReadCommands() :
+    writes(readRegValues), selects(selectRegs)
+{}
+
+std::vector<i2c_msg> plxReadTransaction(std::span<const uint8_t> addresses,
+                                        PLXReadCommands& commands,
+                                        std::vector<uint8_t>& data)
+{
+    data.assign(addresses.size() * arrayLenRead, 0);
+    std::vector<i2c_msg> msgs;
+    msgs.reserve(addresses.size() * plxReadMessages);
+    for (size_t ii = 0; ii < addresses.size(); ii++)
+    {
+        uint16_t addr = addresses[ii];
+        for (PLXWrite& write : commands.writes)
+        {
+            msgs.push_back({addr, 0, arrayLenWrite, write.data()});
+        }
+        for (PLXSelect& select : commands.selects)
+        {
+            msgs.push_back({addr, 0, arrayLenRead, select.data()});
+        }
+        msgs.push_back(
+            {addr, I2C_M_RD, arrayLenRead, &data[ii * arrayLenRead]});
+    }
+    return msgs;
+}
+
+int plxRead(I2CBus& bus, std::span<const uint8_t> addresses,
+            std::vector<uint8_t>& data)
+{
+    PLXReadCommands commands;
+    std::vector<i2c_msg> msgs = plxReadTransaction(addresses, commands, data);
+    int rc = bus.transferOrSplit(msgs);
+    if (rc < 0)
+    {
+        data.clear();
+    }
+    return rc;
+}
+
+PLXBus::PLXBus(boost::asio::io_context& io, uint8_t bus, Transfer&& transfer) :
+    io(io), i2c(io, bus),
+    transfer(std::make_shared<const Transfer>(std::move(transfer)))
+{}
+
+std::shared_ptr<PLXBus> PLXBus::get(boost::asio::io_context& io, uint8_t bus)
+{
+    // Keyed by io_context too, see SatelliteDevice::get()
+    static std::map<std::pair<boost::asio::io_context*, uint8_t>,
+                    std::weak_ptr<PLXBus>>
+        buses;
+    std::weak_ptr<PLXBus>& entry = buses[{&io, bus}];
+    std::shared_ptr<PLXBus> plxBus = entry.lock();
+    if (!plxBus)
+    {
+        plxBus = std::make_shared<PLXBus>(io, bus);
+        entry = plxBus;
+    }
+    return plxBus;
+}
+
+void PLXBus::read(uint8_t address, std::weak_ptr<void> owner,
+                  Completion&& completion, std::chrono::milliseconds deadline)
+{
+    if (pending.empty())
+    {
+        boost::asio::post(io, [this, alive = std::weak_ptr<int>(lifetime)]() {
+            if (!alive.expired())
+            {
+                flush();
+            }
+        });
+    }
+    pending.emplace_back(address, std::move(owner), std::move(completion),
+                         deadline);
+}
+
+void PLXBus::flush()
+{
+    std::vector<Request> requests = std::move(pending);
+    pending.clear();
+    for (size_t first = 0; first < requests.size(); first += plxReadGroup)
+    {
+        size_t last = std::min(first + plxReadGroup, requests.size());
+        submit(std::vector<Request>(
+            std::make_move_iterator(requests.begin() + first),
+            std::make_move_iterator(requests.begin() + last)));
+    }
+}
+
+void PLXBus::submit(std::vector<Request>&& requests)
+{
+    std::vector<uint8_t> addresses;
+    addresses.reserve(requests.size());
+    std::chrono::milliseconds deadline = requests.front().deadline;
+    for (const Request& request : requests)
+    {
+        addresses.push_back(request.address);
+        deadline = i2cSharedDeadline(deadline, request.deadline);
+    }
+    i2c.submit([transfer{transfer}, addresses](I2CBus& bus,
+                                               std::vector<uint8_t>& data) {
+        return (*transfer)(bus, addresses, data);
+    },
+               [this, requests{std::move(requests)}](
+                   int rc, std::vector<uint8_t>& data) mutable {
+        // A switch failing the group must not cost the others their
+        // reading, so a failed group is read again switch by switch. One
+        // dropped for its deadline never reached the switches, and queueing
+        // it again would only add to the load of a congested bus.
+        if (rc < 0 && rc != i2cExpired && requests.size() > 1)
+        {
+            for (Request& request : requests)
+            {
+                std::vector<Request> single;
+                single.push_back(std::move(request));
+                submit(std::move(single));
+            }
+            return;
+        }
+        for (size_t ii = 0; ii < requests.size(); ii++)
+        {
+            if (requests[ii].owner.expired())
+            {
+                continue;
+            }
+            std::vector<uint8_t> reading;
+            if (rc >= 0)
+            {
+                reading.assign(data.begin() + ii * arrayLenRead,
+                               data.begin() + (ii + 1) * arrayLenRead);
+            }
+            requests[ii].completion(rc, reading);
+        }
+    }, deadline);
+}
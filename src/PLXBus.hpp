@@ -0,0 +1,122 @@
+#pragma once
+
+#include "I2CBus.hpp"
+#include "I2CExecutor.hpp"
+
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+
+#include <boost/asio/io_context.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+static constexpr unsigned int arrayLenWrite = 8;
+static constexpr unsigned int arrayLenRead = 4;
+
+using PLXWrite = std::array<uint8_t, arrayLenWrite>;
+using PLXSelect = std::array<uint8_t, arrayLenRead>;
+
+// The commands of a switch read. The write messages point into a copy of
+// them, as the kernel only reads from their buffers but takes them non-const.
+struct PLXReadCommands
+{
+    PLXReadCommands();
+
+    std::array<PLXWrite, 8> writes;
+    std::array<PLXSelect, 2> selects;
+};
+
+// Every switch read takes the register writes, the selects and the read
+static constexpr size_t plxReadMessages =
+    std::tuple_size_v<decltype(PLXReadCommands::writes)> +
+    std::tuple_size_v<decltype(PLXReadCommands::selects)> + 1;
+// Switches read in one transaction, as many as I2C_RDWR takes messages
+static constexpr size_t plxReadGroup =
+    I2C_RDWR_IOCTL_MAX_MSGS / plxReadMessages;
+
+// The messages of one I2C_RDWR reading the switches at addresses, switch
+// after switch: the register writes, the selects, then the read of its
+// 32-bit register into the next arrayLenRead bytes of data
+std::vector<i2c_msg> plxReadTransaction(std::span<const uint8_t> addresses,
+                                        PLXReadCommands& commands,
+                                        std::vector<uint8_t>& data);
+
+// Runs on the I2C worker of the bus. Leaves the 32-bit registers holding the
+// status and reading of the switches at addresses in data, one after the
+// other.
+int plxRead(I2CBus& bus, std::span<const uint8_t> addresses,
+            std::vector<uint8_t>& data);
+
+/**
+ * @class PLXBus
+ * The PLX switches on one bus. Readings requested while a poll tick is
+ * handled go out together once the tick is done, the indirect register
+ * sequences of a few switches at a time in a single I2C_RDWR, so no other
+ * master can get in between the steps of a sequence.
+ */
+class PLXBus
+{
+  public:
+    // The 32-bit register holding the status and reading is left in data
+    using Completion = std::function<void(int rc, std::vector<uint8_t>& data)>;
+    // Reads a group of switches like plxRead(), which tests replace
+    using Transfer = std::function<int(
+        I2CBus& bus, std::span<const uint8_t> addresses,
+        std::vector<uint8_t>& data)>;
+
+    PLXBus(boost::asio::io_context& io, uint8_t bus,
+           Transfer&& transfer = plxRead);
+
+    PLXBus(const PLXBus&) = delete;
+    PLXBus(PLXBus&&) = delete;
+    PLXBus& operator=(const PLXBus&) = delete;
+    PLXBus& operator=(PLXBus&&) = delete;
+    ~PLXBus() = default;
+
+    /**
+     * @brief the PLXBus of bus on io, created on first use and kept while
+     * any sensor holds it
+     */
+    static std::shared_ptr<PLXBus> get(boost::asio::io_context& io,
+                                       uint8_t bus);
+
+    /**
+     * @brief queue a reading of the switch at address for the next flush
+     * The completion is dropped if owner has expired by then. The reading
+     * waits in the queue of the bus for deadline at most, see I2CPolicy.
+     */
+    void read(uint8_t address, std::weak_ptr<void> owner,
+              Completion&& completion,
+              std::chrono::milliseconds deadline = {});
+
+    I2CChannel& channel()
+    {
+        return i2c;
+    }
+
+  private:
+    struct Request
+    {
+        uint8_t address;
+        std::weak_ptr<void> owner;
+        Completion completion;
+        std::chrono::milliseconds deadline;
+    };
+
+    void flush();
+    void submit(std::vector<Request>&& requests);
+
+    boost::asio::io_context& io;
+    I2CChannel i2c;
+    std::shared_ptr<const Transfer> transfer;
+    std::vector<Request> pending;
+    // Token for the posted flush, which must not outlive the bus
+    std::shared_ptr<int> lifetime = std::make_shared<int>(0);
+};
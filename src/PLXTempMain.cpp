@@ -1,4 +1,6 @@
+#include "I2CExecutor.hpp"
 #include "PLXTempSensor.hpp"
+#include "SensorInstrumentation.hpp"
 #include "Utils.hpp"
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -152,7 +154,8 @@ void createSensors(
             sensorEntry = std::make_shared<PLXTempSensor>(
                 sensorType, objectServer, dbusConnection, io, sensorName,
                 std::move(sensorThresholds), *interfacePath, readState,
-                deviceBus, deviceAddress, pollRate);
+                deviceBus, deviceAddress, pollRate,
+                getI2CPolicy(baseConfiguration->second, {}));
             sensorEntry->setupRead();
         }
     });
@@ -200,6 +203,7 @@ int main()
     auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
     systemBus->request_name("xyz.openbmc_project.PLXTempSensor");
     sdbusplus::asio::object_server objectServer(systemBus);
+    registerSensorInstrumentationControl(objectServer);
     boost::container::flat_map<std::string, std::shared_ptr<PLXTempSensor>>
         sensors;
     std::vector<std::unique_ptr<sdbusplus::bus::match::match>> matches;
@@ -1,24 +1,29 @@
 #include "PLXTempSensor.hpp"
 
+#include "I2CBus.hpp"
+#include "I2CExecutor.hpp"
+#include "PLXBus.hpp"
 #include "sensor.hpp"
 
-#include <fcntl.h>
 #include <linux/i2c-dev.h>
 #include <linux/i2c.h>
-#include <sys/ioctl.h>
-#include <unistd.h>
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/asio/io_context.hpp>
 #include <boost/asio/read_until.hpp>
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <istream>
 #include <limits>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 static constexpr double maxReading = 127;
@@ -32,14 +37,18 @@ PLXTempSensor::PLXTempSensor(const std::string& objectType,
                              std::vector<thresholds::Threshold>&& thresholdsIn,
                              const std::string& sensorConfiguration,
                              const PowerState powerState, uint8_t deviceBus,
-                             uint8_t deviceAddress, const float pollRate) :
+                             uint8_t deviceAddress, const float pollRate,
+                             const I2CPolicy& i2cPolicy) :
     Sensor(boost::replace_all_copy(sensorName, " ", "_"),
            std::move(thresholdsIn), sensorConfiguration, objectType, false,
            false, maxReading, minReading, conn, powerState),
-    objServer(objectServer), waitTimer(io), deviceBus(deviceBus),
-    deviceAddress(deviceAddress),
-    sensorPollMs(static_cast<unsigned int>(pollRate * 1000))
+    objServer(objectServer), waitTimer(io),
+    plxBus(PLXBus::get(io, deviceBus)),
+    deviceBus(deviceBus), deviceAddress(deviceAddress),
+    sensorPollMs(static_cast<unsigned int>(pollRate * 1000)),
+    i2cDeadline(i2cPolicy.deadline)
 {
+    plxBus->channel().require(i2cPolicy.priority);
     // add interface under sensor so it can be viewed as a sensor
     sensorInterface = objectServer.add_interface(
         "/xyz/openbmc_project/sensors/temperature/" + name,
@@ -79,10 +88,7 @@ void PLXTempSensor::setupRead()
         restartRead();
         return;
     }
-    if (!updateReading())
-    {
-        restartRead();
-    }
+    updateReading();
 }
 
 void PLXTempSensor::restartRead()
@@ -103,195 +109,73 @@ void PLXTempSensor::restartRead()
     });
 }
 
-// The format for I2C Register Write and Read as per Atlas
-/* Register write :-
- * <slave address>,<CommandByte1>,<CommandByte2>,<CommandByte3>,CommandByte4>,
- * <DataByte1>,<DataByte2>,<DataByte3>,<DataByte4>
- */
-/*Register Read
- * packet 1 for selecting register to read
- * <slave address>,<CommandByte1>,<CommandByte2>,<CommandByte3>,<CommandByte4>
- * packet 2 to read 32-bit register
- * <slave address>,<BufferByet3>,<BufferByte2>,<BufferByte1>,<BufferByte0>
- */
-
-bool PLXTempSensor::updateReading()
+// Register writes setting the switch up for temperature readings, see
+// PLXBus.cpp for the format
+static constexpr std::array<PLXWrite, 3> initRegValues{{
+    {0x03, 0x00, 0x3c, 0xb3, 0x00, 0x00, 0x00, 0x07},
+    {0x03, 0x58, 0x3c, 0x40, 0xff, 0xe7, 0x85, 0x04},
+    {0x03, 0x58, 0x3c, 0x42, 0x00, 0x00, 0x00, 0x02},
+}};
+
+// Runs on the I2C worker of the bus, like plxRead(). On failure the command
+// that was not written is left in data.
+template <size_t N, size_t Len>
+static int plxWriteAll(I2CBus& bus, uint8_t slaveAddr,
+                       const std::array<std::array<uint8_t, Len>, N>& commands,
+                       std::vector<uint8_t>& data)
 {
-    std::string i2cBus = "/dev/i2c-" + std::to_string(deviceBus);
-    uint8_t slaveAddr = deviceAddress;
-    int16_t rawValue = 0;
-    int16_t respValue = 0;
-    int16_t reading = 0;
-    std::array<uint16_t, 2> regValue{};
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    int file = open(i2cBus.c_str(), O_RDWR);
-    if (file < 0)
-    {
-        std::cerr << "Plx temp sensor " << name << " not valid " << i2cBus
-                  << std::string(std::strerror(errno)) << "\n";
-        return false;
-    }
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(file, I2C_SLAVE, slaveAddr) < 0)
-    {
-        std::cerr << "unable to set device address "
-                  << std::string(std::strerror(errno)) << "\n";
-        close(file);
-        return false;
-    }
-
-    // setting register to read
-    std::array<uint8_t, arrayLenWrite> setReg1{0x03, 0x58, 0x3c, 0x40,
-                                               0xff, 0xe7, 0x85, 0x04};
-    if (i2cWrite(file, setReg1.data(), static_cast<ssize_t>(setReg1.size())) !=
-        0)
-    {
-        std::cerr << "Error while setting register to read, Register:";
-        for (const auto itr : setReg1)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
-    }
-
-    std::array<uint8_t, arrayLenWrite> setReg2{0x03, 0x58, 0x3c, 0x41,
-                                               0x20, 0x06, 0x53, 0xe8};
-    if (i2cWrite(file, setReg2.data(), static_cast<ssize_t>(setReg2.size())) !=
-        0)
-    {
-        std::cerr << "Error while setting register to read, Register:";
-        for (const auto itr : setReg2)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
-    }
-    std::array<uint8_t, arrayLenWrite> setReg3{0x03, 0x58, 0x3c, 0x42,
-                                               0x00, 0x00, 0x00, 0x01};
-    if (i2cWrite(file, setReg3.data(), static_cast<ssize_t>(setReg3.size())) !=
-        0)
-    {
-        std::cerr << "Error while setting register to read, Register:";
-        for (const auto itr : setReg3)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
-    }
-    std::array<uint8_t, arrayLenWrite> setReg4{0x03, 0x58, 0x3c, 0x40,
-                                               0xff, 0xe7, 0x85, 0x34};
-    if (i2cWrite(file, setReg4.data(), static_cast<ssize_t>(setReg4.size())) !=
-        0)
-    {
-        std::cerr << "Error while setting register to read, Register:";
-        for (const auto itr : setReg4)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
-    }
-    std::array<uint8_t, arrayLenWrite> setReg5{0x03, 0x58, 0x3c, 0x42,
-                                               0x00, 0x00, 0x00, 0x02};
-    if (i2cWrite(file, setReg5.data(), static_cast<ssize_t>(setReg5.size())) !=
-        0)
-    {
-        std::cerr << "Error while setting register to read, Register:";
-        for (const auto itr : setReg5)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
-    }
-
-    // Getting Temperature reading
-
-    std::array<uint8_t, arrayLenWrite> readRegValue1{0x03, 0x00, 0x3c, 0xb3,
-                                                     0x00, 0x00, 0x00, 0x07};
-    if (i2cWrite(file, readRegValue1.data(),
-                 static_cast<ssize_t>(readRegValue1.size())) != 0)
-    {
-        std::cerr << "Error while writing to register:";
-        for (const auto itr : readRegValue1)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
-    }
-
-    std::array<uint8_t, arrayLenWrite> readRegValue2{0x03, 0x58, 0x3c, 0x40,
-                                                     0xff, 0xe7, 0x85, 0x38};
-    if (i2cWrite(file, readRegValue2.data(),
-                 static_cast<ssize_t>(readRegValue2.size())) != 0)
+    for (const auto& command : commands)
     {
-        std::cerr << "Error while writing to register:";
-        for (const auto itr : readRegValue2)
+        int rc = bus.write(slaveAddr, command);
+        if (rc < 0)
         {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
+            data.assign(command.begin(), command.end());
+            return rc;
         }
-        return false;
-    }
-
-    std::array<uint8_t, arrayLenWrite> readRegValue3{0x03, 0x58, 0x3c, 0x42,
-                                                     0x00, 0x00, 0x00, 0x02};
-    if (i2cWrite(file, readRegValue3.data(),
-                 static_cast<ssize_t>(readRegValue3.size())) != 0)
-    {
-        std::cerr << "Error while writing to register:";
-        for (const auto itr : readRegValue3)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
     }
+    return 0;
+}
 
-    std::array<uint8_t, arrayLenRead> selectReg1{0x04, 0x58, 0x3c, 0x42};
-    if (i2cWrite(file, selectReg1.data(),
-                 static_cast<ssize_t>(selectReg1.size())) != 0)
+static void logPLXError(const std::string& sensor, const char* what, int rc,
+                        const std::vector<uint8_t>& command)
+{
+    std::cerr << "Plx temp sensor " << sensor << ": " << what;
+    for (const auto itr : command)
     {
-        std::cerr << "Error while selecting register:";
-        for (const auto itr : selectReg1)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return false;
+        std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
     }
+    std::cerr << std::dec << " " << std::strerror(-rc) << "\n";
+}
 
-    std::array<uint8_t, arrayLenRead> selectReg2{0x04, 0x58, 0x3c, 0x41};
-    if (i2cWrite(file, selectReg2.data(),
-                 static_cast<ssize_t>(selectReg2.size())) != 0)
-    {
-        std::cerr << "Error while selecting register:";
-        for (const auto itr : selectReg2)
+void PLXTempSensor::updateReading()
+{
+    plxBus->read(deviceAddress, weak_from_this(),
+                 [this](int rc, std::vector<uint8_t>& data) {
+        if (rc < 0)
         {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
+            logPLXError(name, "Error reading register", rc, data);
+            restartRead();
+            return;
         }
-        return false;
-    }
-    if (read(file, regValue.data(), arrayLenRead) != 4)
-    {
-        std::cerr << "Error reading PLX at " << i2cBus
-                  << std::string(std::strerror(errno)) << "\n";
-        close(file);
-        return false;
-    }
-    respValue = static_cast<int16_t>((regValue[0] >> 8) | (regValue[0] << 8));
+        std::array<uint16_t, 2> regValue{};
+        std::memcpy(regValue.data(), data.data(), arrayLenRead);
+        auto respValue =
+            static_cast<int16_t>((regValue[0] >> 8) | (regValue[0] << 8));
 
-    if ((respValue & readingAvailableBit) != 0U)
-    {
-        rawValue =
-            static_cast<int16_t>((regValue[1] >> 8) | (regValue[1] << 8));
-        // 2's complement
-        if ((rawValue & readingSignedBit) != 0U)
+        if ((respValue & readingAvailableBit) != 0U)
         {
-            rawValue = -((~rawValue & 0xffff) + 1);
+            auto rawValue =
+                static_cast<int16_t>((regValue[1] >> 8) | (regValue[1] << 8));
+            // 2's complement
+            if ((rawValue & readingSignedBit) != 0U)
+            {
+                rawValue = -((~rawValue & 0xffff) + 1);
+            }
+            int16_t reading = rawValue / 128;
+            updateValue(reading);
         }
-        reading = rawValue / 128;
-        updateValue(reading);
-    }
-
-    close(file);
-    restartRead();
-    return true;
+        restartRead();
+    }, i2cDeadline);
 }
 
 void PLXTempSensor::checkThresholds()
@@ -301,62 +185,20 @@ void PLXTempSensor::checkThresholds()
 
 void PLXTempSensor::hwInit()
 {
-    std::string i2cBus = "/dev/i2c-" + std::to_string(deviceBus);
-    uint8_t slaveAddr = deviceAddress;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    int file = open(i2cBus.c_str(), O_RDWR);
-    if (file < 0)
-    {
-        std::cerr << "Plx temp sensor " << name << " not valid " << i2cBus
-                  << std::string(std::strerror(errno)) << "\n";
-    }
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(file, I2C_SLAVE, slaveAddr) < 0)
-    {
-        std::cerr << "unable to set device address "
-                  << std::string(std::strerror(errno)) << "\n";
-        close(file);
-        return;
-    }
-
-    std::array<uint8_t, arrayLenWrite> initRegValue1{0x03, 0x00, 0x3c, 0xb3,
-                                                     0x00, 0x00, 0x00, 0x07};
-    if (i2cWrite(file, initRegValue1.data(),
-                 static_cast<ssize_t>(initRegValue1.size())) != 0)
-    {
-        std::cerr << "Error while initialization, register:";
-        for (const auto itr : initRegValue1)
-        {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
-        }
-        return;
-    }
-
-    std::array<uint8_t, arrayLenWrite> initRegValue2{0x03, 0x58, 0x3c, 0x40,
-                                                     0xff, 0xe7, 0x85, 0x04};
-    if (i2cWrite(file, initRegValue2.data(),
-                 static_cast<ssize_t>(initRegValue2.size())) != 0)
-    {
-        std::cerr << "Error while initialization, register:";
-        for (const auto itr : initRegValue2)
+    plxBus->channel().submit([slaveAddr{deviceAddress}](I2CBus& bus,
+                                          std::vector<uint8_t>& data) {
+        return plxWriteAll(bus, slaveAddr, initRegValues, data);
+    },
+               [this, alive = std::weak_ptr<int>(lifetime)](
+                   int rc, std::vector<uint8_t>& data) {
+        if (alive.expired())
         {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
+            return;
         }
-        return;
-    }
-
-    std::array<uint8_t, arrayLenWrite> initRegValue3{0x03, 0x58, 0x3c, 0x42,
-                                                     0x00, 0x00, 0x00, 0x02};
-    if (i2cWrite(file, initRegValue3.data(),
-                 static_cast<ssize_t>(initRegValue3.size())) != 0)
-    {
-        std::cerr << "Error while initialization, register:";
-        for (const auto itr : initRegValue3)
+        if (rc < 0)
         {
-            std::cerr << " 0x" << std::hex << static_cast<uint16_t>(itr);
+            logPLXError(name, "Error while initialization, register", rc,
+                        data);
         }
-        return;
-    }
-
-    close(file);
+    });
 }
@@ -1,13 +1,21 @@
 #pragma once
 
+#include "I2CExecutor.hpp"
+#include "PLXBus.hpp"
+#include "PollScheduler.hpp"
 #include "sensor.hpp"
 
 #include <unistd.h>
 
+#include <boost/asio/io_context.hpp>
 #include <boost/asio/streambuf.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,6 +42,7 @@ class PLXTempSensor :
      * @param i2c bus number
      * @param device address
      * @param pollrate
+     * @param I2C queueing of the readings
      */
 
     PLXTempSensor(const std::string& objectType,
@@ -42,22 +51,30 @@ class PLXTempSensor :
                   boost::asio::io_context& io, const std::string& sensorName,
                   std::vector<thresholds::Threshold>&& thresholds,
                   const std::string& sensorConfiguration, PowerState powerState,
-                  uint8_t deviceBus, uint8_t deviceAddress, float pollRate);
+                  uint8_t deviceBus, uint8_t deviceAddress, float pollRate,
+                  const I2CPolicy& i2cPolicy);
     ~PLXTempSensor() override;
     void setupRead();
 
   private:
     sdbusplus::asio::object_server& objServer;
-    boost::asio::steady_timer waitTimer;
+    PollTimer waitTimer;
+    std::shared_ptr<PLXBus> plxBus;
+    // Keeps the completion of the init transfer, queued on the channel of
+    // the shared bus, from outliving the sensor. weak_from_this() is of no
+    // use here, hwInit() runs from the constructor.
+    std::shared_ptr<int> lifetime = std::make_shared<int>(0);
 
     uint8_t deviceBus;
     uint8_t deviceAddress;
     unsigned int sensorPollMs;
+    // How long a reading may wait in the queue of the shared bus
+    std::chrono::milliseconds i2cDeadline;
 
     /**
      * @brief update sensor reading based on plx registers
      */
-    bool updateReading();
+    void updateReading();
 
     /**
      * @brief initialization of plx device
@@ -75,28 +92,7 @@ class PLXTempSensor :
      * with an interval of 0.5 seconds.
      */
     void restartRead();
-
-    /**
-     * @brief writes up to count bytes from the buffer starting at
-     *  buf to the file referred to by the file descriptor fd.
-     *  @param file descriptor
-     *  @param buffer
-     *  @param count bytes to write
-     */
-    static int i2cWrite(int fd, const void* buf, ssize_t len)
-    {
-        if (write(fd, buf, len) != len)
-        {
-            std::cerr << "unable to write to i2c device "
-                      << std::string(std::strerror(errno)) << "\n";
-            close(fd);
-            return -1;
-        }
-        return 0;
-    }
 };
 
 static constexpr unsigned int readingSignedBit = 0x8000;
 static constexpr unsigned int readingAvailableBit = 0x01;
-static constexpr unsigned int arrayLenWrite = 8;
-static constexpr unsigned int arrayLenRead = 4;
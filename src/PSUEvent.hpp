@@ -16,10 +16,11 @@
 
 #pragma once
 
+#include "PollScheduler.hpp"
+#include "SysfsReader.hpp"
 #include "Utils.hpp"
 
 #include <boost/asio/io_context.hpp>
-#include <boost/asio/random_access_file.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
 #include <sdbusplus/asio/object_server.hpp>
@@ -62,13 +63,13 @@ class PSUSubEvent : public std::enable_shared_from_this<PSUSubEvent>
     std::string eventName;
 
     PowerState readState;
-    boost::asio::steady_timer waitTimer;
+    PollTimer waitTimer;
     std::shared_ptr<std::array<char, 128>> buffer;
     void restartRead();
     void handleResponse(const boost::system::error_code& err,
                         size_t bytesTransferred);
     void updateValue(const int& newValue);
-    boost::asio::random_access_file inputDev;
+    SysfsFile inputDev;
     std::string psuName;
     std::string groupEventName;
     std::string fanName;
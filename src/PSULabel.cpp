@@ -0,0 +1,202 @@
+#include "PSULabel.hpp"
+
+#include "SensorPaths.hpp"
+#include "StaticMap.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+static constexpr auto sensorTable = makeStaticMap<const char*>({
+    {"power", sensor_paths::unitWatts},
+    {"curr", sensor_paths::unitAmperes},
+    {"temp", sensor_paths::unitDegreesC},
+    {"in", sensor_paths::unitVolts},
+    {"voltage", sensor_paths::unitVolts},
+    {"fan", sensor_paths::unitRPMs},
+});
+
+static constexpr auto labelMatch = makeStaticMap<PSUPropertyDefaults>({
+    {"pin", {"Input Power", 3000, 0, 6, 0}},
+    {"pout", {"Output Power", 3000, 0, 6, 0}},
+    {"power", {"Output Power", 3000, 0, 6, 0}},
+    {"maxpin", {"Max Input Power", 3000, 0, 6, 0}},
+    {"vin", {"Input Voltage", 300, 0, 3, 0}},
+    {"maxvin", {"Max Input Voltage", 300, 0, 3, 0}},
+    {"in_voltage", {"Output Voltage", 255, 0, 3, 0}},
+    {"vout", {"Output Voltage", 255, 0, 3, 0}},
+    {"vmon", {"Auxiliary Input Voltage", 255, 0, 3, 0}},
+    {"in", {"Output Voltage", 255, 0, 3, 0}},
+    {"iin", {"Input Current", 20, 0, 3, 0}},
+    {"iout", {"Output Current", 255, 0, 3, 0}},
+    {"curr", {"Output Current", 255, 0, 3, 0}},
+    {"maxiout", {"Max Output Current", 255, 0, 3, 0}},
+    {"temp", {"Temperature", 127, -128, 3, 0}},
+    {"maxtemp", {"Max Temperature", 127, -128, 3, 0}},
+    {"fan", {"Fan Speed ", 30000, 0, 0, 0}},
+});
+
+static bool isAlpha(char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+namespace
+{
+
+// A run of letters, the digits right after it and whatever follows those
+struct AlphaNum
+{
+    std::string_view letters;
+    std::string_view digits;
+    std::string_view rest;
+};
+
+} // namespace
+
+// Leftmost run of letters and digits that accept takes, the way a search for
+// ([A-Za-z]+)([0-9]*) followed by more pattern would find it. Starting within
+// a run of letters leads to the same digits and rest, so only the start of
+// each run is tried.
+template <typename Accept>
+static std::optional<AlphaNum> findAlphaNum(std::string_view name,
+                                            Accept accept)
+{
+    size_t pos = 0;
+    while (pos < name.size())
+    {
+        if (!isAlpha(name[pos]))
+        {
+            ++pos;
+            continue;
+        }
+        size_t digits = pos;
+        while (digits < name.size() && isAlpha(name[digits]))
+        {
+            ++digits;
+        }
+        size_t end = digits;
+        while (end < name.size() && isDigit(name[end]))
+        {
+            ++end;
+        }
+        AlphaNum candidate{name.substr(pos, digits - pos),
+                           name.substr(digits, end - digits), name.substr(end)};
+        if (accept(candidate))
+        {
+            return candidate;
+        }
+        pos = digits;
+    }
+    return std::nullopt;
+}
+
+const char* psuSensorFileRegEx(DevTypes devType)
+{
+    switch (devType)
+    {
+        case DevTypes::HWMON:
+            return R"(\w\d+_input$)";
+        case DevTypes::IIO:
+            return R"(\w+_(raw|input)$)";
+        default:
+            return "";
+    }
+}
+
+std::string_view psuSensorType(DevTypes devType, std::string_view fileName)
+{
+    if (devType == DevTypes::HWMON)
+    {
+        // ([A-Za-z]+)[0-9]*_
+        auto match = findAlphaNum(fileName, [](const AlphaNum& candidate) {
+            return candidate.rest.starts_with('_');
+        });
+        return match ? match->letters : std::string_view();
+    }
+    if (devType == DevTypes::IIO)
+    {
+        // ^(in|out)_([A-Za-z]+)[0-9]*_
+        if (fileName.starts_with("in_"))
+        {
+            fileName.remove_prefix(3);
+        }
+        else if (fileName.starts_with("out_"))
+        {
+            fileName.remove_prefix(4);
+        }
+        else
+        {
+            return {};
+        }
+        size_t letters = 0;
+        while (letters < fileName.size() && isAlpha(fileName[letters]))
+        {
+            ++letters;
+        }
+        size_t end = letters;
+        while (end < fileName.size() && isDigit(fileName[end]))
+        {
+            ++end;
+        }
+        if (letters == 0 || end == fileName.size() || fileName[end] != '_')
+        {
+            return {};
+        }
+        return fileName.substr(0, letters);
+    }
+    return {};
+}
+
+std::string psuSiblingAttribute(std::string_view attributePath,
+                                std::string_view suffix)
+{
+    size_t fileName = attributePath.rfind('/');
+    fileName = (fileName == std::string_view::npos) ? 0 : fileName + 1;
+    size_t underscore = attributePath.rfind('_');
+    if (underscore == std::string_view::npos || underscore < fileName)
+    {
+        return {};
+    }
+    std::string sibling(attributePath.substr(0, underscore + 1));
+    sibling += suffix;
+    return sibling;
+}
+
+std::string_view psuLabelIndex(std::string_view labelHead)
+{
+    // [A-Za-z]+([0-9]+)
+    auto match = findAlphaNum(labelHead, [](const AlphaNum& candidate) {
+        return !candidate.digits.empty();
+    });
+    return match ? match->digits : std::string_view();
+}
+
+const PSUPropertyDefaults* psuPropertyDefaults(std::string_view sensorType)
+{
+    auto found = labelMatch.find(sensorType);
+    return found == labelMatch.end() ? nullptr : &found->second;
+}
+
+const char* psuSensorUnit(std::string_view sensorType)
+{
+    auto found = sensorTable.find(sensorType);
+    return found == sensorTable.end() ? nullptr : found->second;
+}
+
+std::string psuScaleFactorKey(std::string_view sensorType)
+{
+    std::string key(sensorType);
+    if (!key.empty() && key[0] >= 'a' && key[0] <= 'z')
+    {
+        key[0] = static_cast<char>(key[0] - 'a' + 'A');
+    }
+    key += "ScaleFactor";
+    return key;
+}
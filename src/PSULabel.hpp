@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Turns the sysfs attributes of a power supply into the sensor types, label
+// heads and names psusensor creates its sensors from. This runs for every
+// attribute of every PSU on each scan, so the fixed patterns involved are
+// matched by hand and the per-type defaults are constant tables; no regex is
+// built along the way.
+
+enum class DevTypes
+{
+    Unknown = 0,
+    HWMON,
+    IIO
+};
+
+// Default name, range and scaling of a PSU sensor by its type, before the
+// configuration overrides any of them
+struct PSUPropertyDefaults
+{
+    const char* labelTypeName;
+    double maxReading;
+    double minReading;
+    unsigned int sensorScaleFactor;
+    double sensorOffset;
+};
+
+// findFiles() pattern of the attributes sensors are created from
+const char* psuSensorFileRegEx(DevTypes devType);
+
+// Sensor type an attribute file is for: "in" for hwmon in1_input, "voltage"
+// for iio in_voltage0_raw. Empty if the name does not follow the scheme of
+// the device type.
+std::string_view psuSensorType(DevTypes devType, std::string_view fileName);
+
+// Path of another attribute of the same channel, in1_input with suffix
+// "label" gives in1_label. Empty if the file name has no suffix to replace.
+std::string psuSiblingAttribute(std::string_view attributePath,
+                                std::string_view suffix);
+
+// Channel number of a label head, "2" for vout2 or maxiout2. Empty if it has
+// none.
+std::string_view psuLabelIndex(std::string_view labelHead);
+
+// Defaults of a sensor type, nullptr for types no sensor is created for
+const PSUPropertyDefaults* psuPropertyDefaults(std::string_view sensorType);
+
+// Unit of the values of a sensor type, nullptr if unknown
+const char* psuSensorUnit(std::string_view sensorType);
+
+// Configuration key scaling all sensors of a type, from before per label
+// keys existed: CurrScaleFactor for curr
+std::string psuScaleFactorKey(std::string_view sensorType);
@@ -164,6 +164,7 @@ void PSUSensor::setupRead()
     // the actual data structure, so that we can always append the null
     // terminator.  This can go away once std::from_chars<double> is available
     // in the standard
+    markReadStarted();
     inputDev.async_read_some_at(
         0, boost::asio::buffer(buffer->data(), buffer->size() - 1),
         [weak, buffer{buffer}](const boost::system::error_code& ec,
@@ -181,7 +182,8 @@ void PSUSensor::setupRead()
 void PSUSensor::restartRead()
 {
     std::weak_ptr<PSUSensor> weakRef = weak_from_this();
-    waitTimer.expires_after(std::chrono::milliseconds(sensorPollMs));
+    waitTimer.expires_after(
+        std::chrono::milliseconds(nextPollMs(sensorPollMs)));
     waitTimer.async_wait([weakRef](const boost::system::error_code& ec) {
         if (ec == boost::asio::error::operation_aborted)
         {
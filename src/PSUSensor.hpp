@@ -1,11 +1,12 @@
 #pragma once
 
 #include "DeviceMgmt.hpp"
+#include "PollScheduler.hpp"
 #include "PwmSensor.hpp"
+#include "SysfsReader.hpp"
 #include "Thresholds.hpp"
 #include "sensor.hpp"
 
-#include <boost/asio/random_access_file.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
 #include <array>
@@ -38,6 +39,12 @@ class PSUSensor : public Sensor, public std::enable_shared_from_this<PSUSensor>
         return i2cDevice;
     }
 
+    // The sysfs file read, empty while deactivated
+    const std::string& getPath() const
+    {
+        return path;
+    }
+
   private:
     // Note, this buffer is a shared_ptr because during a read, its lifetime
     // might have to outlive the PSUSensor class if the object gets destroyed
@@ -45,8 +52,8 @@ class PSUSensor : public Sensor, public std::enable_shared_from_this<PSUSensor>
     std::shared_ptr<std::array<char, 128>> buffer;
     std::shared_ptr<I2CDevice> i2cDevice;
     sdbusplus::asio::object_server& objServer;
-    boost::asio::random_access_file inputDev;
-    boost::asio::steady_timer waitTimer;
+    SysfsFile inputDev;
+    PollTimer waitTimer;
     std::string path;
     unsigned int sensorFactor;
     double sensorOffset;
@@ -14,17 +14,22 @@
 // limitations under the License.
 */
 
+#include "AdaptivePoll.hpp"
+#include "BindingCache.hpp"
+#include "ConfigReconcile.hpp"
+#include "ConfigurationMirror.hpp"
 #include "DeviceMgmt.hpp"
 #include "PSUEvent.hpp"
+#include "PSULabel.hpp"
 #include "PSUSensor.hpp"
 #include "PwmSensor.hpp"
-#include "SensorPaths.hpp"
+#include "SensorHost.hpp"
+#include "SysfsCatalog.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
 #include "VariantVisitors.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
-#include <boost/algorithm/string/replace.hpp>
 #include <boost/asio/error.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/post.hpp>
@@ -42,7 +47,7 @@
 
 #include <algorithm>
 #include <array>
-#include <cctype>
+#include <charconv>
 #include <chrono>
 #include <cmath>
 #include <cstddef>
@@ -52,18 +57,20 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
-#include <regex>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <utility>
 #include <variant>
 #include <vector>
 
 static constexpr bool debug = false;
 
-static const I2CDeviceTypeMap sensorTypes{
+static constexpr auto sensorTypeTable = makeI2CDeviceTypes({
     {"ADC128D818", I2CDeviceType{"adc128d818", true}},
     {"ADM1266", I2CDeviceType{"adm1266", true}},
     {"ADM1272", I2CDeviceType{"adm1272", true}},
@@ -132,21 +139,8 @@ static const I2CDeviceTypeMap sensorTypes{
     {"XDPE11280", I2CDeviceType{"xdpe11280", true}},
     {"XDPE12284", I2CDeviceType{"xdpe12284", true}},
     {"XDPE152C4", I2CDeviceType{"xdpe152c4", true}},
-};
-
-enum class DevTypes
-{
-    Unknown = 0,
-    HWMON,
-    IIO
-};
-
-struct DevParams
-{
-    unsigned int matchIndex = 0;
-    std::string matchRegEx;
-    std::string nameRegEx;
-};
+});
+static constexpr I2CDeviceTypeMap sensorTypes(sensorTypeTable);
 
 namespace fs = std::filesystem;
 
@@ -156,19 +150,34 @@ static boost::container::flat_map<std::string, std::unique_ptr<PSUCombineEvent>>
     combineEvents;
 static boost::container::flat_map<std::string, std::unique_ptr<PwmSensor>>
     pwmSensors;
-static boost::container::flat_map<std::string, std::string> sensorTable;
-static boost::container::flat_map<std::string, PSUProperty> labelMatch;
 static EventPathList eventMatch;
 static EventPathList limitEventMatch;
 
 static boost::container::flat_map<size_t, bool> cpuPresence;
-static boost::container::flat_map<DevTypes, DevParams> devParamMap;
+
+using I2CDeviceMap =
+    boost::container::flat_map<std::string,
+                               std::pair<std::shared_ptr<I2CDevice>, bool>>;
+
+// What was created for the device in a hwmon or iio directory, to tear it
+// down when the device goes away
+struct PSUDevice
+{
+    std::string psuName;
+    boost::container::flat_set<std::string> pwmSensors;
+};
+static boost::container::flat_map<std::string, PSUDevice> psuDevices;
+
+// Configuration the sensors were last built from
+static ConfigReconciler configReconciler;
+static BindingCache bindingCache(BindingCache::defaultFile("psusensor"));
 
 // Function CheckEvent will check each attribute from eventMatch table in the
 // sysfs. If the attributes exists in sysfs, then store the complete path
 // of the attribute into eventPathList.
-void checkEvent(const std::string& directory, const EventPathList& eventMatch,
-                EventPathList& eventPathList)
+static void checkEvent(const std::string& directory,
+                       const EventPathList& eventMatch,
+                       EventPathList& eventPathList)
 {
     for (const auto& match : eventMatch)
     {
@@ -193,8 +202,8 @@ void checkEvent(const std::string& directory, const EventPathList& eventMatch,
 
 // Check Group Events which contains more than one targets in each combine
 // events.
-void checkGroupEvent(const std::string& directory,
-                     GroupEventPathList& groupEventPathList)
+static void checkGroupEvent(const std::string& directory,
+                            GroupEventPathList& groupEventPathList)
 {
     EventPathList pathList;
     std::vector<fs::path> eventPaths;
@@ -215,9 +224,9 @@ void checkGroupEvent(const std::string& directory,
 // in sysfs to see if xxx_crit_alarm xxx_lcrit_alarm xxx_max_alarm
 // xxx_min_alarm exist, then store the existing paths of the alarm attributes
 // to eventPathList.
-void checkEventLimits(const std::string& sensorPathStr,
-                      const EventPathList& limitEventMatch,
-                      EventPathList& eventPathList)
+static void checkEventLimits(const std::string& sensorPathStr,
+                             const EventPathList& limitEventMatch,
+                             EventPathList& eventPathList)
 {
     auto attributePartPos = sensorPathStr.find_last_of('_');
     if (attributePartPos == std::string::npos)
@@ -264,9 +273,8 @@ static void
     }
     std::string labelHeadIndex = labelHead.substr(3);
 
-    const std::string& sensorPathStr = sensorPath.string();
-    const std::string& pwmPathStr = boost::replace_all_copy(sensorPathStr,
-                                                            "input", "target");
+    std::string pwmPathStr = psuSiblingAttribute(sensorPath.string(),
+                                                 "target");
     std::ifstream pwmFile(pwmPathStr);
     if (!pwmFile.good())
     {
@@ -292,27 +300,28 @@ static void
         name, pwmPathStr, dbusConnection, objectServer, objPath, "PSU");
 }
 
-static void createSensorsCallback(
+static bool hasActiveSensors(const std::string& directory)
+{
+    return std::ranges::any_of(sensors, [&directory](const auto& entry) {
+        return entry.second != nullptr && entry.second->isActive() &&
+               entry.second->getPath().starts_with(directory + "/");
+    });
+}
+
+// Creates the sensors of the devices whose sysfs "name" files are given
+static void createDeviceSensors(
     boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
     std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
-    const ManagedObjectType& sensorConfigs,
+    const ManagedObjectType& sensorConfigs, const I2CDeviceMap& devices,
+    const std::vector<fs::path>& pmbusPaths,
     const std::shared_ptr<boost::container::flat_set<std::string>>&
         sensorsChanged,
     bool activateOnly)
 {
     int numCreated = 0;
     bool firstScan = sensorsChanged == nullptr;
-
-    auto devices = instantiateDevices(sensorConfigs, sensors, sensorTypes);
-
-    std::vector<fs::path> pmbusPaths;
-    findFiles(fs::path("/sys/bus/iio/devices"), "name", pmbusPaths);
-    findFiles(fs::path("/sys/class/hwmon"), "name", pmbusPaths);
-    if (pmbusPaths.empty())
-    {
-        std::cerr << "No PSU sensors in system\n";
-        return;
-    }
+    const std::string hwmonRoot = sysfsPath("/sys/class/hwmon");
+    SysfsCatalog& catalog = SysfsCatalog::get(io);
 
     boost::container::flat_set<std::string> directories;
     for (const auto& pmbusPath : pmbusPaths)
@@ -351,7 +360,7 @@ static void createSensorsCallback(
 
         DevTypes devType = DevTypes::HWMON;
         std::string deviceName;
-        if (directory.parent_path() == "/sys/class/hwmon")
+        if (directory.parent_path() == hwmonRoot)
         {
             deviceName = fs::canonical(directory / "device").stem();
         }
@@ -443,6 +452,7 @@ static void createSensorsCallback(
             std::cerr << "failed to find match for " << deviceName << "\n";
             continue;
         }
+        bindingCache.bind(*interfacePath, pmbusPath);
 
         auto findI2CDev = devices.find(*interfacePath);
 
@@ -482,25 +492,21 @@ static void createSensorsCallback(
             }
         }
 
-        // on rescans, only update sensors we were signaled by
-        if (!firstScan)
+        // on rescans, only rebuild the PSUs whose configuration changed.
+        // Unlike the other daemons this also rebuilds those that changed in
+        // their thresholds or scaling only (see ConfigReconciler::canUpdate()):
+        // those are matched to sensors by label further down, per sysfs file.
+        if (!firstScan && !configReconciler.needsRebuild(*interfacePath) &&
+            hasActiveSensors(directory.string()))
         {
-            std::string psuNameStr = "/" + escapeName(*psuName);
-            auto it = std::find_if(sensorsChanged->begin(),
-                                   sensorsChanged->end(),
-                                   [psuNameStr](std::string& s) {
-                return s.ends_with(psuNameStr);
-            });
-
-            if (it == sensorsChanged->end())
-            {
-                continue;
-            }
-            sensorsChanged->erase(it);
+            continue;
         }
         checkEvent(directory.string(), eventMatch, eventPathList);
         checkGroupEvent(directory.string(), groupEventPathList);
 
+        PSUDevice& psuDevice = psuDevices[directory.string()];
+        psuDevice.psuName = *psuName;
+
         PowerState readState = getPowerState(*baseConfig);
 
         /* Check if there are more sensors in the same interface */
@@ -515,15 +521,15 @@ static void createSensorsCallback(
         } while (findPSUName != baseConfig->end());
 
         std::vector<fs::path> sensorPaths;
-        if (!findFiles(directory, devParamMap[devType].matchRegEx, sensorPaths,
-                       0))
+        if (!catalog.findFiles(directory, psuSensorFileRegEx(devType),
+                               sensorPaths, 0))
         {
             std::cerr << "No PSU non-label sensor in PSU\n";
             continue;
         }
 
         /* read max value in sysfs for in, curr, power, temp, ... */
-        if (!findFiles(directory, R"(\w\d+_max$)", sensorPaths, 0))
+        if (!catalog.findFiles(directory, R"(\w\d+_max$)", sensorPaths, 0))
         {
             if constexpr (debug)
             {
@@ -532,6 +538,9 @@ static void createSensorsCallback(
         }
 
         float pollRate = getPollRate(*baseConfig, PSUSensor::defaultSensorPoll);
+        PublishPolicy publishPolicy = getPublishPolicy(*baseConfig);
+        std::optional<AdaptivePoll> adaptivePoll = getAdaptivePoll(*baseConfig,
+                                                                   pollRate);
 
         /* Find array of labels to be exposed if it is defined in config */
         std::vector<std::string> findLabels;
@@ -542,25 +551,19 @@ static void createSensorsCallback(
                 std::get<std::vector<std::string>>(findLabelObj->second);
         }
 
-        std::regex sensorNameRegEx(devParamMap[devType].nameRegEx);
-        std::smatch matches;
-
         for (const auto& sensorPath : sensorPaths)
         {
             bool maxLabel = false;
             std::string labelHead;
             std::string sensorPathStr = sensorPath.string();
             std::string sensorNameStr = sensorPath.filename();
-            std::string sensorNameSubStr;
-            if (std::regex_search(sensorNameStr, matches, sensorNameRegEx))
-            {
-                // hwmon *_input filename without number:
-                // in, curr, power, temp, ...
-                // iio in_*_raw filename without number:
-                // voltage, temp, pressure, ...
-                sensorNameSubStr = matches[devParamMap[devType].matchIndex];
-            }
-            else
+            // hwmon *_input filename without number:
+            // in, curr, power, temp, ...
+            // iio in_*_raw filename without number:
+            // voltage, temp, pressure, ...
+            std::string sensorNameSubStr(psuSensorType(devType,
+                                                       sensorNameStr));
+            if (sensorNameSubStr.empty())
             {
                 std::cerr << "Could not extract the alpha prefix from "
                           << sensorNameStr;
@@ -572,27 +575,12 @@ static void createSensorsCallback(
             if (devType == DevTypes::HWMON)
             {
                 /* find and differentiate _max and _input to replace "label" */
-                size_t pos = sensorPathStr.find('_');
-                if (pos != std::string::npos)
-                {
-                    std::string sensorPathStrMax = sensorPathStr.substr(pos);
-                    if (sensorPathStrMax == "_max")
-                    {
-                        labelPath = boost::replace_all_copy(sensorPathStr,
-                                                            "max", "label");
-                        maxLabel = true;
-                    }
-                    else
-                    {
-                        labelPath = boost::replace_all_copy(sensorPathStr,
-                                                            "input", "label");
-                        maxLabel = false;
-                    }
-                }
-                else
+                labelPath = psuSiblingAttribute(sensorPathStr, "label");
+                if (labelPath.empty())
                 {
                     continue;
                 }
+                maxLabel = sensorNameStr.ends_with("_max");
 
                 std::ifstream labelFile(labelPath);
                 if (!labelFile.good())
@@ -631,6 +619,10 @@ static void createSensorsCallback(
 
                 checkPWMSensor(sensorPath, labelHead, *interfacePath,
                                dbusConnection, objectServer, psuNames[0]);
+                if (pwmSensors.contains(psuNames[0] + labelHead))
+                {
+                    psuDevice.pwmSensors.insert(psuNames[0] + labelHead);
+                }
             }
             else if (devType == DevTypes::IIO)
             {
@@ -659,8 +651,9 @@ static void createSensorsCallback(
                 }
             }
 
-            auto findProperty = labelMatch.find(sensorNameSubStr);
-            if (findProperty == labelMatch.end())
+            const PSUPropertyDefaults* defaults =
+                psuPropertyDefaults(sensorNameSubStr);
+            if (defaults == nullptr)
             {
                 if constexpr (debug)
                 {
@@ -670,11 +663,12 @@ static void createSensorsCallback(
                 continue;
             }
 
-            // Protect the hardcoded labelMatch list from changes,
-            // by making a copy and modifying that instead.
-            // Avoid bleedthrough of one device's customizations to
-            // the next device, as each should be independently customizable.
-            PSUProperty psuProperty = findProperty->second;
+            // The hardcoded defaults are constant, customizations go into a
+            // copy so each device stays independently customizable.
+            PSUProperty psuProperty(
+                defaults->labelTypeName, defaults->maxReading,
+                defaults->minReading, defaults->sensorScaleFactor,
+                defaults->sensorOffset);
 
             // Use label head as prefix for reading from config file,
             // example if temp1: temp1_Name, temp1_Scale, temp1_Min, ...
@@ -798,12 +792,18 @@ static void createSensorsCallback(
             if (!customizedName)
             {
                 /* Find out sensor name index for this label */
-                std::regex rgx("[A-Za-z]+([0-9]+)");
+                std::string_view labelIndex = psuLabelIndex(labelHead);
                 size_t nameIndex{0};
-                if (std::regex_search(labelHead, matches, rgx))
+                if (!labelIndex.empty())
                 {
-                    nameIndexStr = matches[1];
-                    nameIndex = std::stoi(nameIndexStr);
+                    nameIndexStr = labelIndex;
+                    auto parsed = std::from_chars(
+                        labelIndex.data(),
+                        labelIndex.data() + labelIndex.size(), nameIndex);
+                    if (parsed.ec != std::errc())
+                    {
+                        nameIndex = std::numeric_limits<size_t>::max();
+                    }
 
                     // Decrement to preserve alignment, because hwmon
                     // human-readable filenames and labels use 1-based
@@ -850,11 +850,8 @@ static void createSensorsCallback(
                 // Preserve existing usage of hardcoded labelMatch table below
                 factor = std::pow(10.0, factor);
 
-                /* Change first char of substring to uppercase */
-                char firstChar =
-                    static_cast<char>(std::toupper(sensorNameSubStr[0]));
                 std::string strScaleFactor =
-                    firstChar + sensorNameSubStr.substr(1) + "ScaleFactor";
+                    psuScaleFactorKey(sensorNameSubStr);
 
                 // Preserve existing configs by accepting earlier syntax,
                 // example CurrScaleFactor, PowerScaleFactor, ...
@@ -880,8 +877,8 @@ static void createSensorsCallback(
                           << sensorNameSubStr << "\n";
             }
 
-            auto findSensorUnit = sensorTable.find(sensorNameSubStr);
-            if (findSensorUnit == sensorTable.end())
+            const char* sensorUnit = psuSensorUnit(sensorNameSubStr);
+            if (sensorUnit == nullptr)
             {
                 std::cerr << sensorNameSubStr
                           << " is not a recognized sensor type\n";
@@ -946,10 +943,12 @@ static void createSensorsCallback(
                 sensors[sensorName] = std::make_shared<PSUSensor>(
                     sensorPathStr, sensorType, objectServer, dbusConnection, io,
                     sensorName, std::move(sensorThresholds), *interfacePath,
-                    readState, findSensorUnit->second, factor,
+                    readState, sensorUnit, factor,
                     psuProperty.maxReading, psuProperty.minReading,
                     psuProperty.sensorOffset, labelHead, thresholdConfSize,
                     pollRate, i2cDev);
+                sensors[sensorName]->publishPolicy = publishPolicy;
+                sensors[sensorName]->adaptivePoll = adaptivePoll;
                 sensors[sensorName]->setupRead();
                 ++numCreated;
                 if constexpr (debug)
@@ -978,6 +977,269 @@ static void createSensorsCallback(
     }
 }
 
+static void createSensors(
+    boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
+    std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
+    const std::shared_ptr<boost::container::flat_set<std::string>>&
+        sensorsChanged,
+    bool activateOnly, bool discoverUnbound = false);
+
+// The configuration types of sensorTypes, as entity-manager names them
+static std::vector<std::string> configurationTypes()
+{
+    std::vector<std::string> types;
+    types.reserve(sensorTypes.size());
+    for (const auto& [type, dt] : sensorTypes)
+    {
+        types.emplace_back(type);
+    }
+    return types;
+}
+
+static void createSensorsCallback(
+    boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
+    std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
+    const ManagedObjectType& allConfigs, bool incomplete,
+    const std::shared_ptr<boost::container::flat_set<std::string>>&
+        sensorsChanged,
+    bool activateOnly, bool discoverUnbound)
+{
+    // Which PSUs to rebuild or remove follows from the configuration itself,
+    // the signalled paths only triggered the rescan
+    configReconciler.update(allConfigs, incomplete);
+    configReconciler.removeSensors(sensors);
+    if (sensorsChanged != nullptr)
+    {
+        sensorsChanged->clear();
+    }
+
+    // The scan following a warm start only looks for the devices of the
+    // objects it left unbound
+    std::vector<std::string> types = configurationTypes();
+    ManagedObjectType unbound;
+    if (discoverUnbound)
+    {
+        unbound = bindingCache.unbound(allConfigs, types);
+    }
+    const ManagedObjectType& sensorConfigs = discoverUnbound ? unbound
+                                                             : allConfigs;
+
+    auto devices = instantiateDevices(sensorConfigs, sensors, sensorTypes);
+
+    // A restart binds to the devices of the previous run, as long as their
+    // directories still belong to the same devices
+    std::vector<fs::path> pmbusPaths;
+    std::optional<std::vector<fs::path>> cached =
+        bindingCache.warmStart(sensorConfigs, types);
+    bool warmStart = cached.has_value();
+    if (warmStart)
+    {
+        pmbusPaths = std::move(*cached);
+    }
+    else
+    {
+        SysfsCatalog& catalog = SysfsCatalog::get(io);
+        catalog.findFiles(fs::path(sysfsPath("/sys/bus/iio/devices")), "name",
+                          pmbusPaths);
+        catalog.findFiles(fs::path(sysfsPath("/sys/class/hwmon")), "name",
+                          pmbusPaths);
+    }
+    if (pmbusPaths.empty())
+    {
+        std::cerr << "No PSU sensors in system\n";
+        return;
+    }
+
+    createDeviceSensors(io, objectServer, dbusConnection, sensorConfigs,
+                        devices, pmbusPaths, sensorsChanged, activateOnly);
+
+    bindingCache.save(allConfigs, types, incomplete);
+    if (warmStart && !bindingCache.unbound(sensorConfigs, types).empty())
+    {
+        // Some PSUs were not bound before or their device moved since,
+        // discover those
+        createSensors(
+            io, objectServer, dbusConnection,
+            std::make_shared<boost::container::flat_set<std::string>>(),
+            false, true);
+    }
+}
+
+// Maps a uevent devpath to the directory the scans know the device by
+static std::optional<fs::path>
+    ueventDeviceDirectory(const SysfsCatalog::Uevent& event)
+{
+    std::string device = fs::path(event.devpath).filename();
+    if (event.subsystem == "hwmon")
+    {
+        return fs::path(sysfsPath("/sys/class/hwmon")) / device;
+    }
+    if (event.subsystem == "iio")
+    {
+        return fs::path(sysfsPath("/sys/bus/iio/devices")) / device;
+    }
+    return std::nullopt;
+}
+
+// Whether the device that appeared in directory is a PSU of the current
+// configuration, so that other hwmon and iio devices coming up are ignored
+// without a scan of their attributes
+static bool isConfiguredPSU(const fs::path& directory, bool iio)
+{
+    std::ifstream nameFile(directory / "name");
+    std::string pmbusName;
+    std::getline(nameFile, pmbusName);
+    if (sensorTypes.find(pmbusName) == sensorTypes.end())
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::path device = iio ? fs::canonical(directory, ec).parent_path()
+                          : fs::canonical(directory / "device", ec);
+    size_t bus = 0;
+    size_t addr = 0;
+    if (ec || !getDeviceBusAddr(device.stem().string(), bus, addr))
+    {
+        return false;
+    }
+
+    for (const auto& [path, cfgData] : configReconciler.configuration())
+    {
+        for (const auto& [type, dt] : sensorTypes)
+        {
+            auto sensorBase = cfgData.find(configInterfaceName(type));
+            if (sensorBase == cfgData.end())
+            {
+                continue;
+            }
+            auto configBus = sensorBase->second.find("Bus");
+            auto configAddress = sensorBase->second.find("Address");
+            if (configBus == sensorBase->second.end() ||
+                configAddress == sensorBase->second.end())
+            {
+                continue;
+            }
+            const uint64_t* confBus = std::get_if<uint64_t>(&configBus->second);
+            const uint64_t* confAddr =
+                std::get_if<uint64_t>(&configAddress->second);
+            if (confBus != nullptr && confAddr != nullptr && *confBus == bus &&
+                *confAddr == addr)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// The sensors of a PSU device that went away
+static void psuDeviceRemoved(const std::string& directory)
+{
+    auto device = psuDevices.find(directory);
+    if (device == psuDevices.end())
+    {
+        return;
+    }
+    // Our own devices go away when their sensors are deactivated, and are
+    // instantiated again with them
+    if (removeDeviceSensors(sensors, directory) == 0)
+    {
+        return;
+    }
+    for (const std::string& pwm : device->second.pwmSensors)
+    {
+        pwmSensors.erase(pwm);
+    }
+    combineEvents.erase(device->second.psuName + "OperationalStatus");
+    std::cerr << "Removed sensors of " << device->second.psuName
+              << ", its device " << directory << " went away\n";
+    psuDevices.erase(device);
+}
+
+// Creates the sensors of a device that appeared in directory, if it is a PSU
+// of the configuration the other sensors were built from
+static void psuDeviceAdded(
+    boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
+    std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
+    const fs::path& directory, bool iio)
+{
+    // Devices we instantiate ourselves are picked up by the scan that
+    // instantiated them
+    if (hasActiveSensors(directory.string()) ||
+        !isConfiguredPSU(directory, iio))
+    {
+        return;
+    }
+    const ManagedObjectType& configs = configReconciler.configuration();
+    createDeviceSensors(io, objectServer, dbusConnection, configs, {},
+                        {directory / "name"}, nullptr, true);
+    bindingCache.save(configs, configurationTypes());
+}
+
+// A PSU driver bound or unbound outside of us, typically by a hot swap.
+// Only the sensors of that one device are created or torn down, the others
+// keep reading. The configuration is the one the other sensors were built
+// from, entity-manager signals changes to it separately.
+static void deviceHotplugged(
+    boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
+    std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
+    const SysfsCatalog::Uevent& event)
+{
+    if (event.action == SysfsCatalog::rescanAction)
+    {
+        // Uevents were lost, compare the devices we know with what is there
+        std::vector<std::string> known;
+        known.reserve(psuDevices.size());
+        for (const auto& [directory, device] : psuDevices)
+        {
+            known.emplace_back(directory);
+        }
+        for (const std::string& directory : known)
+        {
+            std::error_code ec;
+            if (!fs::exists(fs::path(directory) / "name", ec))
+            {
+                psuDeviceRemoved(directory);
+            }
+        }
+
+        SysfsCatalog& catalog = SysfsCatalog::get(io);
+        std::vector<fs::path> iioPaths;
+        std::vector<fs::path> hwmonPaths;
+        catalog.findFiles(fs::path(sysfsPath("/sys/bus/iio/devices")), "name",
+                          iioPaths);
+        catalog.findFiles(fs::path(sysfsPath("/sys/class/hwmon")), "name",
+                          hwmonPaths);
+        for (const fs::path& path : iioPaths)
+        {
+            psuDeviceAdded(io, objectServer, dbusConnection,
+                           path.parent_path(), true);
+        }
+        for (const fs::path& path : hwmonPaths)
+        {
+            psuDeviceAdded(io, objectServer, dbusConnection,
+                           path.parent_path(), false);
+        }
+        return;
+    }
+
+    std::optional<fs::path> directory = ueventDeviceDirectory(event);
+    if (!directory)
+    {
+        return;
+    }
+    if (event.action == "remove")
+    {
+        psuDeviceRemoved(directory->string());
+    }
+    else if (event.action == "add")
+    {
+        psuDeviceAdded(io, objectServer, dbusConnection, *directory,
+                       event.subsystem == "iio");
+    }
+}
+
 static void
     getPresentCpus(std::shared_ptr<sdbusplus::asio::connection>& dbusConnection)
 {
@@ -1045,55 +1307,27 @@ static void
     }
 }
 
-void createSensors(
+static void createSensors(
     boost::asio::io_context& io, sdbusplus::asio::object_server& objectServer,
     std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
     const std::shared_ptr<boost::container::flat_set<std::string>>&
         sensorsChanged,
-    bool activateOnly)
+    bool activateOnly, bool discoverUnbound)
 {
     auto getter = std::make_shared<GetSensorConfiguration>(
-        dbusConnection, [&io, &objectServer, &dbusConnection, sensorsChanged,
-                         activateOnly](const ManagedObjectType& sensorConfigs) {
+        dbusConnection,
+        [&io, &objectServer, &dbusConnection, sensorsChanged, activateOnly,
+         discoverUnbound](const ManagedObjectType& sensorConfigs,
+                          bool incomplete) {
         createSensorsCallback(io, objectServer, dbusConnection, sensorConfigs,
-                              sensorsChanged, activateOnly);
+                              incomplete, sensorsChanged, activateOnly,
+                              discoverUnbound);
     });
-    std::vector<std::string> types(sensorTypes.size());
-    for (const auto& [type, dt] : sensorTypes)
-    {
-        types.push_back(type);
-    }
-    getter->getConfiguration(types);
+    getter->getConfiguration(configurationTypes());
 }
 
-void propertyInitialize()
+static void propertyInitialize()
 {
-    sensorTable = {{"power", sensor_paths::unitWatts},
-                   {"curr", sensor_paths::unitAmperes},
-                   {"temp", sensor_paths::unitDegreesC},
-                   {"in", sensor_paths::unitVolts},
-                   {"voltage", sensor_paths::unitVolts},
-                   {"fan", sensor_paths::unitRPMs}};
-
-    labelMatch = {
-        {"pin", PSUProperty("Input Power", 3000, 0, 6, 0)},
-        {"pout", PSUProperty("Output Power", 3000, 0, 6, 0)},
-        {"power", PSUProperty("Output Power", 3000, 0, 6, 0)},
-        {"maxpin", PSUProperty("Max Input Power", 3000, 0, 6, 0)},
-        {"vin", PSUProperty("Input Voltage", 300, 0, 3, 0)},
-        {"maxvin", PSUProperty("Max Input Voltage", 300, 0, 3, 0)},
-        {"in_voltage", PSUProperty("Output Voltage", 255, 0, 3, 0)},
-        {"vout", PSUProperty("Output Voltage", 255, 0, 3, 0)},
-        {"vmon", PSUProperty("Auxiliary Input Voltage", 255, 0, 3, 0)},
-        {"in", PSUProperty("Output Voltage", 255, 0, 3, 0)},
-        {"iin", PSUProperty("Input Current", 20, 0, 3, 0)},
-        {"iout", PSUProperty("Output Current", 255, 0, 3, 0)},
-        {"curr", PSUProperty("Output Current", 255, 0, 3, 0)},
-        {"maxiout", PSUProperty("Max Output Current", 255, 0, 3, 0)},
-        {"temp", PSUProperty("Temperature", 127, -128, 3, 0)},
-        {"maxtemp", PSUProperty("Max Temperature", 127, -128, 3, 0)},
-        {"fan", PSUProperty("Fan Speed ", 30000, 0, 0, 0)}};
-
     limitEventMatch = {{"PredictiveFailure", {"max_alarm", "min_alarm"}},
                        {"Failure", {"crit_alarm", "lcrit_alarm"}}};
 
@@ -1101,11 +1335,6 @@ void propertyInitialize()
                   {"Failure", {"in2_alarm"}},
                   {"ACLost", {"in1_beep"}},
                   {"ConfigureError", {"in1_fault"}}};
-
-    devParamMap = {
-        {DevTypes::HWMON, {1, R"(\w\d+_input$)", "([A-Za-z]+)[0-9]*_"}},
-        {DevTypes::IIO,
-         {2, R"(\w+_(raw|input)$)", "^(in|out)_([A-Za-z]+)[0-9]*_"}}};
 }
 
 static void powerStateChanged(
@@ -1131,15 +1360,15 @@ static void powerStateChanged(
     }
 }
 
-int main()
+static void startPSUSensor(SensorHost& host)
 {
-    boost::asio::io_context io;
-    auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
+    boost::asio::io_context& io = host.io;
+    std::shared_ptr<sdbusplus::asio::connection>& systemBus = host.systemBus;
+    sdbusplus::asio::object_server& objectServer = host.objectServer;
 
-    sdbusplus::asio::object_server objectServer(systemBus, true);
-    objectServer.add_manager("/xyz/openbmc_project/sensors");
-    objectServer.add_manager("/xyz/openbmc_project/control");
-    systemBus->request_name("xyz.openbmc_project.PSUSensor");
+    host.addManager("/xyz/openbmc_project/sensors");
+    host.addManager("/xyz/openbmc_project/control");
+    host.requestName("xyz.openbmc_project.PSUSensor");
     auto sensorsChanged =
         std::make_shared<boost::container::flat_set<std::string>>();
 
@@ -1155,9 +1384,18 @@ int main()
     boost::asio::post(io, [&]() {
         createSensors(io, objectServer, systemBus, nullptr, false);
     });
-    boost::asio::steady_timer filterTimer(io);
+
+    ConfigurationMirror::get(systemBus).onReconcileRescan(
+        [&, sensorsChanged]() {
+        createSensors(io, objectServer, systemBus, sensorsChanged, false);
+    });
+    SysfsCatalog::get(io).onUevent([&](const SysfsCatalog::Uevent& event) {
+        deviceHotplugged(io, objectServer, systemBus, event);
+    });
+
+    auto& filterTimer = host.make<boost::asio::steady_timer>(io);
     std::function<void(sdbusplus::message_t&)> eventHandler =
-        [&](sdbusplus::message_t& message) {
+        [&, sensorsChanged](sdbusplus::message_t& message) {
         if (message.is_method_error())
         {
             std::cerr << "callback method error\n";
@@ -1178,7 +1416,7 @@ int main()
         });
     };
 
-    boost::asio::steady_timer cpuFilterTimer(io);
+    auto& cpuFilterTimer = host.make<boost::asio::steady_timer>(io);
     std::function<void(sdbusplus::message_t&)> cpuPresenceHandler =
         [&](sdbusplus::message_t& message) {
         std::string path = message.get_path();
@@ -1233,8 +1471,10 @@ int main()
         });
     };
 
-    std::vector<std::unique_ptr<sdbusplus::bus::match_t>> matches =
-        setupPropertiesChangedMatches(*systemBus, sensorTypes, eventHandler);
+    auto& matches =
+        host.make<std::vector<std::unique_ptr<sdbusplus::bus::match_t>>>(
+            setupPropertiesChangedMatches(*systemBus, sensorTypes,
+                                          eventHandler));
 
     matches.emplace_back(std::make_unique<sdbusplus::bus::match_t>(
         static_cast<sdbusplus::bus_t&>(*systemBus),
@@ -1255,5 +1495,7 @@ int main()
             << "Successfully registered TAL namespaceInit for PSUSensor\n";
     }
 #endif
-    io.run();
 }
+
+[[maybe_unused]] static const bool registered =
+    registerSensorClass("psusensor", startPSUSensor);
@@ -0,0 +1,370 @@
+#include "PollScheduler.hpp"
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+
+boost::asio::execution_context::id PollScheduler::id;
+
+PollTimer::PollTimer(boost::asio::io_context& io) :
+    scheduler(&PollScheduler::get(io))
+{}
+
+PollTimer::~PollTimer()
+{
+    cancel();
+}
+
+void PollTimer::expires_after(std::chrono::steady_clock::duration newDelay)
+{
+    cancel();
+    expiry = std::chrono::steady_clock::now() + newDelay;
+}
+
+void PollTimer::async_wait(Handler&& newHandler)
+{
+    cancel();
+    handler = std::move(newHandler);
+    scheduler->add(*this);
+}
+
+size_t PollTimer::cancel()
+{
+    if (!linked)
+    {
+        return 0;
+    }
+    scheduler->remove(*this);
+    boost::asio::post(scheduler->io, [cancelled{std::move(handler)}]() {
+        cancelled(boost::asio::error::operation_aborted);
+    });
+    handler = nullptr;
+    return 1;
+}
+
+PollScheduler::PollScheduler(boost::asio::io_context& io) :
+    boost::asio::execution_context::service(io), io(io), timer(io),
+    epoch(std::chrono::steady_clock::now())
+{}
+
+PollScheduler::~PollScheduler()
+{
+    shutdown();
+}
+
+PollScheduler& PollScheduler::get(boost::asio::io_context& io)
+{
+    return boost::asio::use_service<PollScheduler>(io);
+}
+
+void PollScheduler::addBatchStartCallback(BatchCallback&& callback)
+{
+    batchStartCallbacks.emplace_back(std::move(callback));
+}
+
+void PollScheduler::addBatchEndCallback(BatchCallback&& callback)
+{
+    batchEndCallbacks.emplace_back(std::move(callback));
+}
+
+void PollScheduler::shutdown()
+{
+    for (Level& level : levels)
+    {
+        for (Slot& slot : level.slots)
+        {
+            for (PollTimer* entry = slot.head; entry != nullptr;)
+            {
+                PollTimer* next = entry->next;
+                entry->prev = nullptr;
+                entry->next = nullptr;
+                entry->linked = false;
+                entry->handler = nullptr;
+                entry = next;
+            }
+            slot = Slot{};
+        }
+        level.occupied = 0;
+    }
+    pendingCount = 0;
+    armed = false;
+    timer.cancel();
+}
+
+uint64_t PollScheduler::tickAt(std::chrono::steady_clock::time_point time) const
+{
+    if (time <= epoch)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>((time - epoch) / pollTickDuration);
+}
+
+std::chrono::steady_clock::time_point
+    PollScheduler::timeOfTick(uint64_t tick) const
+{
+    return epoch + pollTickDuration * tick;
+}
+
+void PollScheduler::add(PollTimer& entry)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (pendingCount == 0)
+    {
+        // Nothing is queued, so there are no cascades to catch up on and the
+        // wheel can be moved straight to the present.
+        baseTick = std::max(baseTick, tickAt(now));
+    }
+
+    // Round up so that a timer never fires before its requested expiry, the
+    // same guarantee steady_timer gives.
+    uint64_t expiryTick = 0;
+    if (entry.expiry > epoch)
+    {
+        expiryTick = static_cast<uint64_t>(
+            (entry.expiry - epoch + pollTickDuration -
+             std::chrono::nanoseconds(1)) /
+            pollTickDuration);
+    }
+    entry.expiryTick = std::max(expiryTick, baseTick);
+
+    link(entry);
+    pendingCount++;
+
+    if (!running)
+    {
+        rearm();
+    }
+}
+
+void PollScheduler::remove(PollTimer& entry)
+{
+    unlink(entry);
+    pendingCount--;
+    if (!running)
+    {
+        rearm();
+    }
+}
+
+void PollScheduler::link(PollTimer& entry)
+{
+    uint64_t delta = entry.expiryTick - baseTick;
+    size_t level = 0;
+    while (level < levelCount - 1 &&
+           delta >= (uint64_t{1} << (levelBits * (level + 1))))
+    {
+        level++;
+    }
+    if (delta > maxTicks)
+    {
+        entry.expiryTick = baseTick + maxTicks;
+    }
+    size_t index = (entry.expiryTick >> (levelBits * level)) & levelMask;
+
+    Slot& slot = levels[level].slots[index];
+    entry.level = level;
+    entry.index = index;
+    entry.prev = slot.tail;
+    entry.next = nullptr;
+    if (slot.tail != nullptr)
+    {
+        slot.tail->next = &entry;
+    }
+    else
+    {
+        slot.head = &entry;
+    }
+    slot.tail = &entry;
+    levels[level].occupied |= uint64_t{1} << index;
+    entry.linked = true;
+}
+
+void PollScheduler::unlink(PollTimer& entry)
+{
+    Slot& slot = levels[entry.level].slots[entry.index];
+    if (entry.prev != nullptr)
+    {
+        entry.prev->next = entry.next;
+    }
+    else
+    {
+        slot.head = entry.next;
+    }
+    if (entry.next != nullptr)
+    {
+        entry.next->prev = entry.prev;
+    }
+    else
+    {
+        slot.tail = entry.prev;
+    }
+    if (slot.head == nullptr)
+    {
+        levels[entry.level].occupied &= ~(uint64_t{1} << entry.index);
+    }
+    entry.prev = nullptr;
+    entry.next = nullptr;
+    entry.linked = false;
+}
+
+// Moves every timer of the current slot on the given level down the
+// hierarchy. Returns true if that level wrapped around, meaning the next level
+// up is due for a cascade as well.
+bool PollScheduler::cascade(size_t level)
+{
+    size_t index = (baseTick >> (levelBits * level)) & levelMask;
+    Slot& slot = levels[level].slots[index];
+    PollTimer* entry = slot.head;
+    slot = Slot{};
+    levels[level].occupied &= ~(uint64_t{1} << index);
+    while (entry != nullptr)
+    {
+        PollTimer* next = entry->next;
+        link(*entry);
+        entry = next;
+    }
+    return index == 0;
+}
+
+void PollScheduler::run(const boost::system::error_code& ec)
+{
+    if (ec == boost::asio::error::operation_aborted)
+    {
+        return; // re-armed for a different tick
+    }
+    if (ec)
+    {
+        std::cerr << "Poll scheduler timer error " << ec.message() << "\n";
+    }
+    armed = false;
+
+    auto now = std::chrono::steady_clock::now();
+    uint64_t nowTick = tickAt(now);
+
+    statistics.wakeups++;
+    auto late = std::chrono::duration_cast<std::chrono::microseconds>(
+        now - timeOfTick(armedTick));
+    statistics.lastJitter = std::max(late, std::chrono::microseconds(0));
+    statistics.maxJitter = std::max(statistics.maxJitter,
+                                    statistics.lastJitter);
+    if (nowTick > armedTick)
+    {
+        statistics.overruns++;
+    }
+
+    running = true;
+    while (baseTick <= nowTick && pendingCount != 0)
+    {
+        size_t index = baseTick & levelMask;
+        if (index == 0)
+        {
+            for (size_t level = 1; level < levelCount; level++)
+            {
+                if (!cascade(level))
+                {
+                    break;
+                }
+            }
+        }
+        baseTick++;
+        statistics.ticks++;
+
+        Slot& slot = levels[0].slots[index];
+        PollTimer* entry = slot.head;
+        slot = Slot{};
+        levels[0].occupied &= ~(uint64_t{1} << index);
+        while (entry != nullptr)
+        {
+            PollTimer* next = entry->next;
+            entry->prev = nullptr;
+            entry->next = nullptr;
+            entry->linked = false;
+            pendingCount--;
+            // Take the handler now; like an expired steady_timer, a later
+            // cancel from another handler in this batch must not stop it.
+            batch.emplace_back(std::move(entry->handler));
+            entry->handler = nullptr;
+            entry = next;
+        }
+    }
+    baseTick = std::max(baseTick, nowTick + 1);
+
+    size_t batchSize = batch.size();
+    if (batchSize != 0)
+    {
+        statistics.fired += batchSize;
+        statistics.maxBatch = std::max(statistics.maxBatch, batchSize);
+
+        for (const BatchCallback& callback : batchStartCallbacks)
+        {
+            callback(batchSize);
+        }
+        for (PollTimer::Handler& handler : batch)
+        {
+            handler(boost::system::error_code());
+        }
+        for (const BatchCallback& callback : batchEndCallbacks)
+        {
+            callback(batchSize);
+        }
+        batch.clear();
+    }
+    running = false;
+
+    rearm();
+}
+
+void PollScheduler::rearm()
+{
+    if (pendingCount == 0)
+    {
+        if (armed)
+        {
+            timer.cancel();
+            armed = false;
+        }
+        return;
+    }
+
+    uint64_t nextTick = baseTick + maxTicks;
+
+    size_t start = baseTick & levelMask;
+    uint64_t occupied = levels[0].occupied;
+    if (occupied != 0)
+    {
+        uint64_t rotated = std::rotr(occupied, static_cast<int>(start));
+        nextTick = baseTick + static_cast<uint64_t>(std::countr_zero(rotated));
+    }
+
+    for (size_t level = 1; level < levelCount; level++)
+    {
+        if (levels[level].occupied != 0)
+        {
+            // Wake at the next level 0 wrap to cascade the upper levels
+            uint64_t boundary = (baseTick + levelMask) & ~levelMask;
+            nextTick = std::min(nextTick, boundary);
+            break;
+        }
+    }
+
+    if (armed && armedTick == nextTick)
+    {
+        return;
+    }
+    armed = true;
+    armedTick = nextTick;
+    timer.expires_at(timeOfTick(nextTick));
+    timer.async_wait(
+        [this](const boost::system::error_code& ec) { run(ec); });
+}
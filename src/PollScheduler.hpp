@@ -0,0 +1,167 @@
+#pragma once
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Resolution of the shared poll wheel. Every sensor deadline is rounded up to
+// a multiple of this, so sensors polling at the same rate end up sharing a
+// single wakeup instead of each arming its own asio timer.
+constexpr std::chrono::milliseconds pollTickDuration(25);
+
+class PollScheduler;
+
+struct PollSchedulerStats
+{
+    // Number of times the scheduler's single asio timer fired
+    uint64_t wakeups = 0;
+    // Wheel ticks advanced, including empty ones skipped over in a wakeup
+    uint64_t ticks = 0;
+    // Timers whose handler has been run
+    uint64_t fired = 0;
+    // Largest number of timers fired from a single wakeup
+    size_t maxBatch = 0;
+    // Wakeups that arrived one or more whole ticks after their deadline
+    uint64_t overruns = 0;
+    // Lateness of the most recent and of the worst wakeup
+    std::chrono::microseconds lastJitter{0};
+    std::chrono::microseconds maxJitter{0};
+};
+
+// A one-shot timer serviced by the process-wide PollScheduler. The interface
+// mirrors the subset of boost::asio::steady_timer that the sensors use, so it
+// can replace a per-sensor waitTimer member without touching the call sites.
+// As with steady_timer, re-arming or cancelling a pending wait completes the
+// old handler with boost::asio::error::operation_aborted.
+class PollTimer
+{
+  public:
+    using Handler = std::function<void(const boost::system::error_code&)>;
+
+    explicit PollTimer(boost::asio::io_context& io);
+    ~PollTimer();
+
+    PollTimer(const PollTimer&) = delete;
+    PollTimer(PollTimer&&) = delete;
+    PollTimer& operator=(const PollTimer&) = delete;
+    PollTimer& operator=(PollTimer&&) = delete;
+
+    void expires_after(std::chrono::steady_clock::duration delay);
+    void async_wait(Handler&& handler);
+    size_t cancel();
+
+  private:
+    friend class PollScheduler;
+
+    PollScheduler* scheduler;
+    Handler handler;
+
+    // Intrusive wheel slot linkage, owned by the scheduler
+    PollTimer* prev = nullptr;
+    PollTimer* next = nullptr;
+    std::chrono::steady_clock::time_point expiry;
+    uint64_t expiryTick = 0;
+    size_t level = 0;
+    size_t index = 0;
+    bool linked = false;
+};
+
+// Hierarchical timer wheel owning the poll cadence of every sensor in the
+// process. It is registered as an io_context service, so there is exactly one
+// per io_context and it is torn down together with it.
+class PollScheduler : public boost::asio::execution_context::service
+{
+  public:
+    using key_type = PollScheduler;
+    // Called once per wakeup that fires at least one timer, with the number
+    // of timers in the batch.
+    using BatchCallback = std::function<void(size_t batchSize)>;
+
+    static boost::asio::execution_context::id id;
+
+    explicit PollScheduler(boost::asio::io_context& io);
+    ~PollScheduler() override;
+
+    PollScheduler(const PollScheduler&) = delete;
+    PollScheduler(PollScheduler&&) = delete;
+    PollScheduler& operator=(const PollScheduler&) = delete;
+    PollScheduler& operator=(PollScheduler&&) = delete;
+
+    static PollScheduler& get(boost::asio::io_context& io);
+
+    // Hooks run immediately before the first and after the last handler of a
+    // batch. They let subsystems queue work for the whole tick and submit it
+    // in one go.
+    void addBatchStartCallback(BatchCallback&& callback);
+    void addBatchEndCallback(BatchCallback&& callback);
+
+    const PollSchedulerStats& stats() const
+    {
+        return statistics;
+    }
+
+    size_t pending() const
+    {
+        return pendingCount;
+    }
+
+  private:
+    friend class PollTimer;
+
+    static constexpr size_t levelBits = 6;
+    static constexpr size_t levelSize = size_t{1} << levelBits;
+    static constexpr uint64_t levelMask = levelSize - 1;
+    static constexpr size_t levelCount = 4;
+    static constexpr uint64_t maxTicks =
+        (uint64_t{1} << (levelBits * levelCount)) - 1;
+
+    struct Slot
+    {
+        PollTimer* head = nullptr;
+        PollTimer* tail = nullptr;
+    };
+
+    struct Level
+    {
+        std::array<Slot, levelSize> slots;
+        uint64_t occupied = 0;
+    };
+
+    void shutdown() override;
+
+    uint64_t tickAt(std::chrono::steady_clock::time_point time) const;
+    std::chrono::steady_clock::time_point
+        timeOfTick(uint64_t tick) const;
+
+    void add(PollTimer& timer);
+    void remove(PollTimer& timer);
+    void link(PollTimer& timer);
+    void unlink(PollTimer& timer);
+    bool cascade(size_t level);
+    void run(const boost::system::error_code& ec);
+    void rearm();
+
+    boost::asio::io_context& io;
+    boost::asio::steady_timer timer;
+    std::chrono::steady_clock::time_point epoch;
+    // Next tick that has not been processed yet
+    uint64_t baseTick = 0;
+    // Tick the asio timer is currently armed for, if any
+    uint64_t armedTick = 0;
+    bool armed = false;
+    // Set while handlers run, rearming is deferred until the batch is done
+    bool running = false;
+    size_t pendingCount = 0;
+    std::array<Level, levelCount> levels;
+    std::vector<PollTimer::Handler> batch;
+    std::vector<BatchCallback> batchStartCallbacks;
+    std::vector<BatchCallback> batchEndCallbacks;
+    PollSchedulerStats statistics;
+};
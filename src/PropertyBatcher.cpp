@@ -0,0 +1,172 @@
+#include "PropertyBatcher.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+boost::asio::execution_context::id PropertyBatcher::id;
+
+PropertyChangeSet::PropertyChangeSet(
+    const std::shared_ptr<sdbusplus::asio::connection>& conn) :
+    conn(conn),
+    batcher(&PropertyBatcher::get(conn->get_io_context()))
+{}
+
+PropertyChangeSet::~PropertyChangeSet()
+{
+    if (queued)
+    {
+        batcher->dequeue(*this);
+    }
+}
+
+void PropertyChangeSet::mark(
+    const std::shared_ptr<sdbusplus::asio::dbus_interface>& interface,
+    const char* property)
+{
+    if (!interface)
+    {
+        return;
+    }
+
+    Pending* entry = nullptr;
+    for (size_t ii = 0; ii < used; ii++)
+    {
+        if (pending[ii].interface.lock() == interface)
+        {
+            entry = &pending[ii];
+            break;
+        }
+    }
+    if (entry == nullptr)
+    {
+        if (used == pending.size())
+        {
+            pending.emplace_back();
+        }
+        entry = &pending[used++];
+        entry->interface = interface;
+        entry->properties.clear();
+    }
+
+    if (std::find(entry->properties.begin(), entry->properties.end(),
+                  property) == entry->properties.end())
+    {
+        entry->properties.emplace_back(property);
+    }
+
+    if (!queued)
+    {
+        queued = true;
+        batcher->enqueue(*this);
+    }
+}
+
+void PropertyChangeSet::flush()
+{
+    if (queued)
+    {
+        queued = false;
+        batcher->dequeue(*this);
+    }
+    emit();
+}
+
+void PropertyChangeSet::emit()
+{
+    for (size_t ii = 0; ii < used; ii++)
+    {
+        Pending& entry = pending[ii];
+        std::shared_ptr<sdbusplus::asio::dbus_interface> interface =
+            entry.interface.lock();
+        entry.interface.reset();
+        if (!interface)
+        {
+            continue; // object went away before the flush
+        }
+
+        entry.properties.emplace_back(nullptr);
+        int r = sd_bus_emit_properties_changed_strv(
+            conn->get(), interface->get_object_path().c_str(),
+            interface->get_interface_name().c_str(),
+            const_cast<char**>(entry.properties.data()));
+        if (r < 0 && r != -ENOENT)
+        {
+            std::cerr << "Failed to emit PropertiesChanged on "
+                      << interface->get_object_path() << ": " << strerror(-r)
+                      << "\n";
+        }
+        entry.properties.clear();
+    }
+    used = 0;
+}
+
+PropertyBatcher::PropertyBatcher(boost::asio::io_context& io) :
+    boost::asio::execution_context::service(io), io(io)
+{}
+
+PropertyBatcher& PropertyBatcher::get(boost::asio::io_context& io)
+{
+    return boost::asio::use_service<PropertyBatcher>(io);
+}
+
+void PropertyBatcher::shutdown()
+{
+    for (PropertyChangeSet* changes : queue)
+    {
+        changes->queued = false;
+    }
+    queue.clear();
+}
+
+void PropertyBatcher::enqueue(PropertyChangeSet& changes)
+{
+    if (queue.empty())
+    {
+        boost::asio::post(io, [this]() { run(); });
+    }
+    queue.emplace_back(&changes);
+}
+
+void PropertyBatcher::dequeue(PropertyChangeSet& changes)
+{
+    auto it = std::find(queue.begin(), queue.end(), &changes);
+    if (it != queue.end())
+    {
+        *it = nullptr;
+    }
+    // A set destroyed by an earlier flush of the same run must be skipped
+    it = std::find(flushing.begin(), flushing.end(), &changes);
+    if (it != flushing.end())
+    {
+        *it = nullptr;
+    }
+}
+
+void PropertyBatcher::run()
+{
+    // Sets marked while flushing are queued for the next run
+    std::swap(queue, flushing);
+    for (PropertyChangeSet*& changes : flushing)
+    {
+        if (changes != nullptr)
+        {
+            PropertyChangeSet* current = std::exchange(changes, nullptr);
+            current->queued = false;
+            current->emit();
+        }
+    }
+    flushing.clear();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class PropertyBatcher;
+
+// Properties of one D-Bus object that changed since the last flush. Instead of
+// signalling every set_property() on its own, owners update their state, mark
+// the property dirty here and let the PropertyBatcher emit a single
+// PropertiesChanged per interface once the current handler batch is done.
+//
+// Marked properties must be registered with a getter that reads the owner's
+// state, as the emitted signal fetches the values at flush time.
+class PropertyChangeSet
+{
+  public:
+    explicit PropertyChangeSet(
+        const std::shared_ptr<sdbusplus::asio::connection>& conn);
+    ~PropertyChangeSet();
+
+    PropertyChangeSet(const PropertyChangeSet&) = delete;
+    PropertyChangeSet(PropertyChangeSet&&) = delete;
+    PropertyChangeSet& operator=(const PropertyChangeSet&) = delete;
+    PropertyChangeSet& operator=(PropertyChangeSet&&) = delete;
+
+    // The property name must outlive the flush, string literals and the
+    // thresholds property name tables do.
+    void mark(const std::shared_ptr<sdbusplus::asio::dbus_interface>& interface,
+              const char* property);
+
+    // Emits the pending changes right away.
+    void flush();
+
+  private:
+    friend class PropertyBatcher;
+
+    void emit();
+
+    struct Pending
+    {
+        std::weak_ptr<sdbusplus::asio::dbus_interface> interface;
+        // nullptr terminated once emitted, as sd-bus expects
+        std::vector<const char*> properties;
+    };
+
+    std::shared_ptr<sdbusplus::asio::connection> conn;
+    PropertyBatcher* batcher;
+    // Entries are kept across flushes so steady state marking does not
+    // allocate, only the first `used` are pending.
+    std::vector<Pending> pending;
+    size_t used = 0;
+    bool queued = false;
+};
+
+// Per io_context queue of the change sets marked since the last flush. The
+// flush is posted when the first set is queued, so every change made by the
+// handlers of one poll tick goes out together after the tick.
+class PropertyBatcher : public boost::asio::execution_context::service
+{
+  public:
+    using key_type = PropertyBatcher;
+
+    static boost::asio::execution_context::id id;
+
+    explicit PropertyBatcher(boost::asio::io_context& io);
+    ~PropertyBatcher() override = default;
+
+    PropertyBatcher(const PropertyBatcher&) = delete;
+    PropertyBatcher(PropertyBatcher&&) = delete;
+    PropertyBatcher& operator=(const PropertyBatcher&) = delete;
+    PropertyBatcher& operator=(PropertyBatcher&&) = delete;
+
+    static PropertyBatcher& get(boost::asio::io_context& io);
+
+  private:
+    friend class PropertyChangeSet;
+
+    void shutdown() override;
+
+    void enqueue(PropertyChangeSet& changes);
+    void dequeue(PropertyChangeSet& changes);
+    void run();
+
+    boost::asio::io_context& io;
+    std::vector<PropertyChangeSet*> queue;
+    std::vector<PropertyChangeSet*> flushing;
+};
@@ -0,0 +1,215 @@
+#include "SatelliteDevice.hpp"
+
+#include "I2CBus.hpp"
+#include "I2CExecutor.hpp"
+
+#include <linux/i2c.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+std::vector<SatelliteRange> planSatelliteReads(
+    std::vector<SatelliteRange> ranges, uint16_t maxLength)
+{
+    std::sort(ranges.begin(), ranges.end(),
+              [](const SatelliteRange& lhs, const SatelliteRange& rhs) {
+        return lhs.offset < rhs.offset;
+    });
+
+    std::vector<SatelliteRange> blocks;
+    for (const SatelliteRange& range : ranges)
+    {
+        size_t end = size_t{range.offset} + range.length;
+        if (!blocks.empty())
+        {
+            SatelliteRange& block = blocks.back();
+            size_t blockEnd = size_t{block.offset} + block.length;
+            if (end <= blockEnd)
+            {
+                continue;
+            }
+            if ((range.offset > 255) == (block.offset > 255) &&
+                end - block.offset <= maxLength)
+            {
+                block.length = static_cast<uint16_t>(end - block.offset);
+                continue;
+            }
+        }
+        blocks.push_back(range);
+    }
+    return blocks;
+}
+
+std::span<const uint8_t> satelliteReading(
+    uint16_t blockOffset, std::span<const uint8_t> data, SatelliteRange range,
+    std::array<uint8_t, sizeof(uint64_t)>& reading)
+{
+    reading.fill(0);
+    auto slice = data.subspan(range.offset - blockOffset, range.length);
+    // there is no reading if all bytes are 0xff
+    if (!std::all_of(slice.begin(), slice.end(),
+                     [](uint8_t byte) { return byte == 0xFF; }))
+    {
+        std::copy(slice.begin(), slice.end(), reading.begin());
+    }
+    return std::span(reading.data(), range.length);
+}
+
+// Runs on the I2C worker of the bus. Leaves the length bytes read at offset
+// in data.
+static int i2cCmd(I2CBus& bus, uint8_t addr, SatelliteRange block,
+                  std::vector<uint8_t>& data)
+{
+    std::array<uint8_t, 2> cmd{};
+    data.assign(block.length, 0);
+
+    std::array<i2c_msg, 2> msgs{{
+        {
+            // write offset
+            .addr = addr,
+            .flags = 0,
+            .len = 1,
+            .buf = cmd.data(),
+        },
+        {
+            // read data from the offset
+            .addr = addr,
+            .flags = I2C_M_RD,
+            .len = block.length,
+            .buf = data.data(),
+        },
+    }};
+
+    // handle two bytes offset
+    if (block.offset > 255)
+    {
+        msgs[0].len = 2;
+        cmd[0] = block.offset >> 8;
+        cmd[1] = block.offset & 0xFF;
+    }
+    else
+    {
+        cmd[0] = block.offset & 0xFF;
+    }
+
+    int rc = bus.transfer(msgs);
+    return rc < 0 ? rc : 0;
+}
+
+SatelliteDevice::SatelliteDevice(boost::asio::io_context& io, uint8_t bus,
+                                 uint8_t addr) :
+    io(io), addr(addr), i2c(io, bus)
+{}
+
+std::shared_ptr<SatelliteDevice> SatelliteDevice::get(
+    boost::asio::io_context& io, uint8_t bus, uint8_t addr)
+{
+    // Keyed by io_context too: a device queues its reads on the I2C executor
+    // and posts its flushes to one io_context, which others in the same
+    // process must not share
+    static std::map<std::tuple<boost::asio::io_context*, uint8_t, uint8_t>,
+                    std::weak_ptr<SatelliteDevice>>
+        devices;
+    std::weak_ptr<SatelliteDevice>& entry = devices[{&io, bus, addr}];
+    std::shared_ptr<SatelliteDevice> device = entry.lock();
+    if (!device)
+    {
+        device = std::make_shared<SatelliteDevice>(io, bus, addr);
+        entry = device;
+    }
+    return device;
+}
+
+void SatelliteDevice::read(uint16_t offset, uint8_t length,
+                           std::weak_ptr<void> owner, Completion&& completion,
+                           std::chrono::milliseconds deadline)
+{
+    if (length > sizeof(uint64_t))
+    {
+        completion(-EINVAL, {});
+        return;
+    }
+    if (pending.empty())
+    {
+        boost::asio::post(io, [this, alive = std::weak_ptr<int>(lifetime)]() {
+            if (!alive.expired())
+            {
+                flush();
+            }
+        });
+    }
+    pending.emplace_back(SatelliteRange{offset, length}, std::move(owner),
+                         std::move(completion), deadline);
+}
+
+void SatelliteDevice::flush()
+{
+    std::vector<SatelliteRange> ranges;
+    ranges.reserve(pending.size());
+    for (const Request& request : pending)
+    {
+        ranges.push_back(request.range);
+    }
+
+    std::vector<Request> requests = std::move(pending);
+    pending.clear();
+    for (const SatelliteRange& block :
+         planSatelliteReads(std::move(ranges), satelliteMaxBlockRead))
+    {
+        // Every request lies within exactly one of the blocks
+        auto inBlock = std::stable_partition(
+            requests.begin(), requests.end(),
+            [&block](const Request& request) {
+            return request.range.offset >= block.offset &&
+                   request.range.offset + request.range.length <=
+                       block.offset + block.length;
+        });
+        std::vector<Request> covered(std::make_move_iterator(requests.begin()),
+                                     std::make_move_iterator(inBlock));
+        requests.erase(requests.begin(), inBlock);
+        submit(block, std::move(covered));
+    }
+}
+
+void SatelliteDevice::submit(SatelliteRange block,
+                             std::vector<Request>&& requests)
+{
+    std::chrono::milliseconds deadline = requests.front().deadline;
+    for (const Request& request : requests)
+    {
+        deadline = i2cSharedDeadline(deadline, request.deadline);
+    }
+    i2c.submit([addr{addr}, block](I2CBus& bus, std::vector<uint8_t>& data) {
+        return i2cCmd(bus, addr, block, data);
+    },
+               [block, requests{std::move(requests)}](
+                   int rc, std::vector<uint8_t>& data) {
+        for (const Request& request : requests)
+        {
+            if (request.owner.expired())
+            {
+                continue;
+            }
+            if (rc < 0)
+            {
+                request.completion(rc, {});
+                continue;
+            }
+            std::array<uint8_t, sizeof(uint64_t)> bytes{};
+            request.completion(0, satelliteReading(block.offset, data,
+                                                   request.range, bytes));
+        }
+    }, deadline);
+}
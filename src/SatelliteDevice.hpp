@@ -0,0 +1,98 @@
+#pragma once
+
+#include "I2CExecutor.hpp"
+
+#include <boost/asio/io_context.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Bytes [offset, offset + length) of a satellite device's register map
+struct SatelliteRange
+{
+    uint16_t offset;
+    uint16_t length;
+
+    bool operator==(const SatelliteRange&) const = default;
+};
+
+// Largest single read from a satellite device, the SMBus block size that
+// every adapter driver buffers in one go
+constexpr uint16_t satelliteMaxBlockRead = 32;
+
+// Fewest block reads of at most maxLength bytes covering all of ranges, in
+// offset order. A block never spans offsets addressed with one byte and ones
+// addressed with two, as the device decodes those differently.
+std::vector<SatelliteRange> planSatelliteReads(
+    std::vector<SatelliteRange> ranges, uint16_t maxLength);
+
+// The bytes of range within data, a block read at blockOffset, copied into
+// reading. A range that reads all 0xFF has not been updated by the device
+// yet and is left all zero.
+std::span<const uint8_t> satelliteReading(
+    uint16_t blockOffset, std::span<const uint8_t> data, SatelliteRange range,
+    std::array<uint8_t, sizeof(uint64_t)>& reading);
+
+// The satellite device at an address on a bus, shared by all the sensors
+// reading it. Reads requested while a poll tick is handled are gathered and
+// go out together once the tick is done, as one I2C transaction per block
+// planned by planSatelliteReads, and every sensor gets its slice of the
+// block back.
+class SatelliteDevice
+{
+  public:
+    // Bytes of the reading, all zero if the device has not updated them yet
+    using Completion =
+        std::function<void(int rc, std::span<const uint8_t> bytes)>;
+
+    SatelliteDevice(boost::asio::io_context& io, uint8_t bus, uint8_t addr);
+
+    SatelliteDevice(const SatelliteDevice&) = delete;
+    SatelliteDevice(SatelliteDevice&&) = delete;
+    SatelliteDevice& operator=(const SatelliteDevice&) = delete;
+    SatelliteDevice& operator=(SatelliteDevice&&) = delete;
+    ~SatelliteDevice() = default;
+
+    // The device for bus and addr of io, created on first use and kept while
+    // any sensor holds it
+    static std::shared_ptr<SatelliteDevice> get(boost::asio::io_context& io,
+                                                uint8_t bus, uint8_t addr);
+
+    // Queues a read of length bytes at offset for the next flush. The
+    // completion is dropped if owner has expired by the time the block is
+    // read. The block waits in the queue of the bus for the deadlines of its
+    // reads, see i2cSharedDeadline().
+    void read(uint16_t offset, uint8_t length, std::weak_ptr<void> owner,
+              Completion&& completion,
+              std::chrono::milliseconds deadline = {});
+
+    I2CChannel& channel()
+    {
+        return i2c;
+    }
+
+  private:
+    struct Request
+    {
+        SatelliteRange range;
+        std::weak_ptr<void> owner;
+        Completion completion;
+        std::chrono::milliseconds deadline;
+    };
+
+    void flush();
+    void submit(SatelliteRange block, std::vector<Request>&& requests);
+
+    boost::asio::io_context& io;
+    uint8_t addr;
+    I2CChannel i2c;
+    std::vector<Request> pending;
+    // Token for the posted flush, which must not outlive the device
+    std::shared_ptr<int> lifetime = std::make_shared<int>(0);
+};
@@ -16,33 +16,34 @@
  */
 #include "SatelliteSensor.hpp"
 
+#include "I2CExecutor.hpp"
+#include "SatelliteDevice.hpp"
+#include "SensorInstrumentation.hpp"
 #include "Utils.hpp"
 #include "VariantVisitors.hpp"
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/bus/match.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <limits>
 #include <memory>
 #include <numeric>
+#include <span>
 #include <string>
 #include <vector>
 
-extern "C"
-{
-#include <i2c/smbus.h>
-#include <linux/i2c-dev.h>
-}
-
 constexpr const bool debug = false;
 
 constexpr const char* configInterface =
@@ -61,14 +62,16 @@ SatelliteSensor::SatelliteSensor(
     std::vector<thresholds::Threshold>&& thresholdData, uint8_t busId,
     uint8_t addr, uint16_t offset, std::string& sensorType,
     std::string& valueType, size_t pollTime, double minVal, double maxVal,
-    const PowerState powerState) :
+    const PowerState powerState, const I2CPolicy& i2cPolicy) :
     Sensor(escapeName(sensorName), std::move(thresholdData),
            sensorConfiguration, objType, false, false, maxVal, minVal, conn,
            powerState),
     name(escapeName(sensorName)), busId(busId), addr(addr), offset(offset),
     sensorType(sensorType), valueType(valueType), objectServer(objectServer),
-    waitTimer(io), pollRate(pollTime)
+    waitTimer(io), device(SatelliteDevice::get(io, busId, addr)),
+    pollRate(pollTime), i2cDeadline(i2cPolicy.deadline)
 {
+    device->channel().require(i2cPolicy.priority);
     // make the string to lowercase for Dbus sensor type
     for (auto& c : sensorType)
     {
@@ -138,147 +141,40 @@ void SatelliteSensor::checkThresholds()
     thresholds::checkThresholds(this);
 }
 
-template <typename T>
-int i2cCmd(uint8_t bus, uint8_t addr, size_t offset, T* reading, uint8_t length)
+double SatelliteSensor::readRawEepromData(
+    std::span<const uint8_t> bytes) const
 {
-    std::string i2cBus = "/dev/i2c-" + std::to_string(bus);
-
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    int fd = open(i2cBus.c_str(), O_RDWR);
-    if (fd < 0)
-    {
-        lg2::error(" unable to open i2c device {BUS} err={FD}", "BUS", i2cBus,
-                   "FD", fd);
-        return -1;
-    }
-
-    unsigned long funcs = 0;
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    if (ioctl(fd, I2C_FUNCS, &funcs) < 0)
-    {
-        lg2::error(" not support I2C_FUNCS");
-        close(fd);
-        return -1;
-    }
-
-    int ret = 0;
-    std::array<uint8_t, 8> cmd{};
-    T data = 0;
-
-    if (length > sizeof(data))
-    {
-        lg2::error("wrong i2c data length");
-        close(fd);
-        return -1;
-    }
-
-    struct i2c_msg msgs[2] = {{
-                                  // write offset
-                                  .addr = addr,
-                                  .flags = 0,
-                                  .len = 2,
-                                  .buf = cmd.data(),
-                              },
-                              {// read data from the offset
-                               .addr = addr,
-                               .flags = I2C_M_RD,
-                               .len = length,
-                               .buf = (uint8_t*)&data}};
-
-    struct i2c_rdwr_ioctl_data args = {msgs, 2};
-
-    // handle two bytes offset
-    if (offset > 255)
-    {
-        msgs[0].len = 2;
-        msgs[0].buf[0] = offset >> 8;
-        msgs[0].buf[1] = offset & 0xFF;
-    }
-    else
+    uint64_t reading = 0;
+    std::memcpy(&reading, bytes.data(), bytes.size());
+    if (debug)
     {
-        msgs[0].len = 1;
-        msgs[0].buf[0] = offset & 0xFF;
+        std::cout << "offset: " << offset << std::hex
+                  << " reading: " << reading << "\n";
     }
-
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-    ret = ioctl(fd, I2C_RDWR, &args);
-    if (ret < 0)
+    if (sensorType == "Temperature")
     {
-        close(fd);
-        return ret;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reading2tempEp(reinterpret_cast<uint8_t*>(&reading));
     }
-    // there is no value updated from HMC if reading data is all 0xff
-    uint8_t emptyBytes = 0;
-    uint8_t* ptr = (uint8_t*)&data;
-    for (int i = 0; i < length; i++, ptr++)
+    if (sensorType == "Power")
     {
-        if (*ptr != 0xFF)
-        {
-            continue;
-        }
-        emptyBytes++;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return reading2power(reinterpret_cast<uint8_t*>(&reading));
     }
-
-    // there is no reading if all bytes are 0xff
-    if (emptyBytes == length)
+    if (sensorType == "Energy")
     {
-        *reading = 0;
+        return reading / 1000.0; // mJ to J (double)
     }
-    else
-    {
-        *reading = data;
-    }
-    close(fd);
-    return 0;
+    return reading;
 }
 
-int SatelliteSensor::readRawEepromData(size_t off, uint8_t length,
-                                       double* data) const
-{
-    uint64_t reading = 0;
-    int ret = i2cCmd<uint64_t>(busId, addr, off, &reading, length);
-    if (ret >= 0)
-    {
-        if (debug)
-        {
-            std::cout << "offset: " << off << std::hex
-                      << " reading: " << reading << "\n";
-        }
-        if (sensorType == "Temperature")
-        {
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-            *data = reading2tempEp(reinterpret_cast<uint8_t*>(&reading));
-        }
-        else if (sensorType == "Power")
-        {
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-            *data = reading2power(reinterpret_cast<uint8_t*>(&reading));
-        }
-        else if (sensorType == "Energy")
-        {
-            *data = reading / 1000.0; // mJ to J (double)
-        }
-        else
-        {
-            *data = reading;
-        }
-        return 0;
-    }
-    return ret;
-}
-
-int SatelliteSensor::readPLDMEepromData(size_t off, uint8_t length,
-                                        double* data) const
+double SatelliteSensor::readPLDMEepromData(std::span<const uint8_t> bytes)
 {
     double reading = 0;
-    int ret = i2cCmd<double>(busId, addr, off, &reading, length);
-    if (ret >= 0)
-    {
-        *data = reading;
-        return 0;
-    }
-    return ret;
+    std::memcpy(&reading, bytes.data(), bytes.size());
+    return reading;
 }
+
 void SatelliteSensor::restartRead()
 {
     size_t pollTime = getPollRate(); // in seconds
@@ -309,45 +205,42 @@ void SatelliteSensor::read()
         return;
     }
 
-    double temp = 0;
-    int len = getLength(offset);
+    uint8_t len = getLength(offset);
     if (len == 0)
     {
         lg2::error("no offset is specified");
         return;
     }
 
-    int ret = 0;
     // Sensor reading value types are sensor-specific. So, read
     // and interpret sensor data based on it's value type.
-    if (valueType == "Raw")
-    {
-        ret = readRawEepromData(offset, len, &temp);
-    }
-    else if (valueType == "PLDM")
-    {
-        ret = readPLDMEepromData(offset, len, &temp);
-    }
-    else
+    if (valueType != "Raw" && valueType != "PLDM")
     {
         lg2::error("Invalid ValueType for sensor: {NAME}", "NAME", name);
         return;
     }
 
-    if (ret >= 0)
-    {
-        if constexpr (debug)
+    device->read(offset, len, lifetime,
+                 [this](int rc, std::span<const uint8_t> data) {
+        // A read dropped for waiting too long on a busy bus is no error of
+        // the device, the last reading is kept
+        if (rc >= 0)
         {
-            lg2::error("Value update to {TEMP}", "TEMP", temp);
+            double temp = valueType == "Raw" ? readRawEepromData(data)
+                                             : readPLDMEepromData(data);
+            if constexpr (debug)
+            {
+                lg2::error("Value update to {TEMP}", "TEMP", temp);
+            }
+            updateValueOnly(temp);
         }
-        updateValueOnly(temp);
-    }
-    else
-    {
-        lg2::error("Invalid read getRegsInfo");
-        incrementError();
-    }
-    restartRead();
+        else if (rc != i2cExpired)
+        {
+            lg2::error("Invalid read getRegsInfo");
+            incrementError();
+        }
+        restartRead();
+    }, i2cDeadline);
 }
 
 void createSensors(
@@ -441,7 +334,8 @@ void createSensors(
                 sensor = std::make_unique<SatelliteSensor>(
                     dbusConnection, io, name, pathPair.first, objectType,
                     objectServer, std::move(sensorThresholds), busId, addr, off,
-                    sensorType, valueType, rate, minVal, maxVal, pwrState);
+                    sensorType, valueType, rate, minVal, maxVal, pwrState,
+                    getI2CPolicy(entry.second, {}));
 
                 sensor->init();
             }
@@ -481,6 +375,7 @@ int main()
     auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
     sdbusplus::asio::object_server objectServer(systemBus, true);
     objectServer.add_manager("/xyz/openbmc_project/sensors");
+    registerSensorInstrumentationControl(objectServer);
     systemBus->request_name("xyz.openbmc_project.Satellite");
 
     boost::asio::post(
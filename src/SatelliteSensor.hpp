@@ -16,8 +16,10 @@
  */
 
 #pragma once
+#include "PollScheduler.hpp"
+#include "SatelliteDevice.hpp"
+
 #include <boost/asio/io_context.hpp>
-#include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/asio/object_server.hpp>
@@ -26,6 +28,7 @@
 #include <chrono>
 #include <limits>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -33,10 +36,6 @@
 #include <HmcSensor.hpp>
 #endif
 
-template <typename T>
-int i2cCmd(uint8_t bus, uint8_t addr, size_t offset, T* reading,
-           uint8_t length);
-
 struct SatelliteSensor : public Sensor
 {
     SatelliteSensor(std::shared_ptr<sdbusplus::asio::connection>& conn,
@@ -48,7 +47,7 @@ struct SatelliteSensor : public Sensor
                     uint8_t busId, uint8_t addr, uint16_t offset,
                     std::string& sensorType, std::string& valueType,
                     size_t pollTime, double minVal, double maxVal,
-                    PowerState powerState);
+                    PowerState powerState, const I2CPolicy& i2cPolicy);
     ~SatelliteSensor() override;
 
     void checkThresholds() override;
@@ -69,8 +68,8 @@ struct SatelliteSensor : public Sensor
     std::string valueType;
 
   private:
-    int readRawEepromData(size_t off, uint8_t length, double* data) const;
-    int readPLDMEepromData(size_t off, uint8_t length, double* data) const;
+    double readRawEepromData(std::span<const uint8_t> bytes) const;
+    static double readPLDMEepromData(std::span<const uint8_t> bytes);
     static uint8_t getLength(uint16_t offset)
     {
 #ifdef AUTO_GEN_SENSOR_HEADER
@@ -87,8 +86,15 @@ struct SatelliteSensor : public Sensor
 #endif
     }
     sdbusplus::asio::object_server& objectServer;
-    boost::asio::steady_timer waitTimer;
+    // Shared with the other sensors on the device, see SatelliteDevice
+    PollTimer waitTimer;
+    std::shared_ptr<SatelliteDevice> device;
+    // Keeps the completions of reads still queued on the device from
+    // outliving the sensor
+    std::shared_ptr<int> lifetime = std::make_shared<int>(0);
     size_t pollRate;
+    // How long a read may wait in the queue of the shared bus
+    std::chrono::milliseconds i2cDeadline;
     static double reading2tempEp(const uint8_t* rawData)
     {
         // this automatic convert to int (two's complement integer)
@@ -0,0 +1,76 @@
+#include "SensorHost.hpp"
+
+#include "SensorInstrumentation.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct SensorClass
+{
+    const char* name;
+    SensorClassStart start;
+};
+
+// Filled by static initializers, so it must not be a namespace scope object
+// of its own
+std::vector<SensorClass>& sensorClasses()
+{
+    static std::vector<SensorClass> classes;
+    return classes;
+}
+
+} // namespace
+
+bool registerSensorClass(const char* name, SensorClassStart start)
+{
+    sensorClasses().emplace_back(name, start);
+    return true;
+}
+
+SensorHost::SensorHost() :
+    systemBus(std::make_shared<sdbusplus::asio::connection>(io)),
+    objectServer(systemBus, true)
+{
+    registerSensorInstrumentationControl(objectServer);
+}
+
+void SensorHost::addManager(const std::string& path)
+{
+    if (managers.insert(path).second)
+    {
+        objectServer.add_manager(path);
+    }
+}
+
+void SensorHost::requestName(const std::string& name)
+{
+    systemBus->request_name(name.c_str());
+}
+
+int SensorHost::run()
+{
+    if (sensorClasses().empty())
+    {
+        std::cerr << "No sensor class linked in\n";
+        return 1;
+    }
+    for (const SensorClass& sensorClass : sensorClasses())
+    {
+        if (sensorClasses().size() > 1)
+        {
+            std::cerr << "Starting " << sensorClass.name << "\n";
+        }
+        sensorClass.start(*this);
+    }
+    io.run();
+    return 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The io_context, bus connection and object server the sensor classes linked
+// into an executable run on. Each daemon is a single class; built with the
+// sensor-host option, sensorhost runs several of them in one process. There
+// they also share the services keyed on the io_context, such as the
+// configuration mirror and the sysfs catalog, as well as the power state and
+// manufacturing mode matches.
+class SensorHost
+{
+  public:
+    SensorHost();
+    ~SensorHost() = default;
+
+    SensorHost(const SensorHost&) = delete;
+    SensorHost(SensorHost&&) = delete;
+    SensorHost& operator=(const SensorHost&) = delete;
+    SensorHost& operator=(SensorHost&&) = delete;
+
+    // Adds an ObjectManager at path, unless another class already did
+    void addManager(const std::string& path);
+
+    // Claims the well-known name of a class. The names stay what they were
+    // for the separate daemons, only they now share one connection.
+    void requestName(const std::string& name);
+
+    // Keeps an object alive for as long as the host runs, for the state a
+    // class used to keep on the stack of its main()
+    template <typename T, typename... Args>
+    T& make(Args&&... args)
+    {
+        auto object = std::make_shared<T>(std::forward<Args>(args)...);
+        T& ref = *object;
+        objects.emplace_back(std::move(object));
+        return ref;
+    }
+
+    // Starts every registered class and runs the io_context
+    int run();
+
+    boost::asio::io_context io;
+    std::shared_ptr<sdbusplus::asio::connection> systemBus;
+    sdbusplus::asio::object_server objectServer;
+
+  private:
+    std::set<std::string> managers;
+    std::vector<std::shared_ptr<void>> objects;
+};
+
+// Sets up one sensor class on the host: what its main() did before running
+// the io_context
+using SensorClassStart = void (*)(SensorHost& host);
+
+// Registers a class linked into the executable, from a static initializer
+// in its main source file. Returns true so it can initialize a constant.
+bool registerSensorClass(const char* name, SensorClassStart start);
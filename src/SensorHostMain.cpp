@@ -0,0 +1,10 @@
+#include "SensorHost.hpp"
+
+// main() of every executable built from sensor classes, be it one of the
+// separate daemons or sensorhost: the classes register themselves from the
+// sources linked in.
+int main()
+{
+    SensorHost host;
+    return host.run();
+}
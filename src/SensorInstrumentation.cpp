@@ -0,0 +1,191 @@
+#include "SensorInstrumentation.hpp"
+
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static bool instrumentationEnabled = []() {
+    const char* env = std::getenv("DBUS_SENSORS_INSTRUMENTATION");
+    return env != nullptr && *env != '\0' && std::string_view(env) != "0";
+}();
+
+bool sensorInstrumentationEnabled()
+{
+    return instrumentationEnabled;
+}
+
+void registerSensorInstrumentationControl(
+    sdbusplus::asio::object_server& objectServer)
+{
+    std::shared_ptr<sdbusplus::asio::dbus_interface> control =
+        objectServer.add_interface(sensorInstrumentationControlPath,
+                                   sensorInstrumentationInterfaceName);
+    // Sensors pick the change up with their next reading
+    control->register_property(
+        "Enabled", instrumentationEnabled,
+        [](const bool& request, bool& old) {
+        old = request;
+        instrumentationEnabled = request;
+        return 1;
+    }, [](const bool&) { return instrumentationEnabled; });
+    if (!control->initialize())
+    {
+        std::cerr << "error initializing sensor instrumentation control\n";
+        objectServer.remove_interface(control);
+    }
+}
+
+static uint64_t toMicroseconds(std::chrono::steady_clock::duration duration)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(duration)
+            .count());
+}
+
+void SensorInstrumentation::readStarted()
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (tracksReads)
+    {
+        auto interval = now - lastReadStart;
+        lastIntervalUs = toMicroseconds(interval);
+        if (lastInterval.count() != 0)
+        {
+            auto jitter = interval > lastInterval ? interval - lastInterval
+                                                  : lastInterval - interval;
+            maxJitterUs = std::max(maxJitterUs, toMicroseconds(jitter));
+        }
+        lastInterval = interval;
+    }
+    tracksReads = true;
+    readPending = true;
+    lastReadStart = now;
+}
+
+void SensorInstrumentation::recordLatency(
+    std::chrono::steady_clock::time_point now)
+{
+    uint64_t latencyUs = toMicroseconds(now - lastReadStart);
+    maxLatencyUs = std::max(maxLatencyUs, latencyUs);
+    size_t bucket = std::bit_width(latencyUs >> 1);
+    ++latencyHistogram[std::min(bucket, latencyBuckets - 1)];
+}
+
+void SensorInstrumentation::readCompleted(double value)
+{
+    if (!enabled)
+    {
+        return;
+    }
+    if (tracksReads)
+    {
+        if (!readPending)
+        {
+            return;
+        }
+        readPending = false;
+        recordLatency(std::chrono::steady_clock::now());
+    }
+
+    if (!std::isfinite(value))
+    {
+        ++missedReadings;
+        ++errorStreak;
+        maxErrorStreak = std::max(maxErrorStreak, errorStreak);
+        return;
+    }
+
+    if (goodReadings == 0)
+    {
+        minCollected = value;
+        maxCollected = value;
+    }
+    minCollected = std::min(minCollected, value);
+    maxCollected = std::max(maxCollected, value);
+    ++goodReadings;
+    errorStreak = 0;
+    lastGoodTimestampUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+}
+
+void SensorInstrumentation::updateSuppressed()
+{
+    if (enabled)
+    {
+        ++suppressedUpdates;
+    }
+}
+
+void SensorInstrumentation::registerInterface(
+    const std::shared_ptr<sdbusplus::asio::connection>& conn,
+    const std::string& objectPath)
+{
+    if (interface)
+    {
+        return;
+    }
+    interface = std::make_shared<sdbusplus::asio::dbus_interface>(
+        conn, objectPath, sensorInstrumentationInterfaceName);
+
+    // The statistics change with every reading, so they are only ever read
+    // on request and never signalled.
+    constexpr auto flags = sdbusplus::vtable::property_::none;
+    auto counter = [this](const char* name, const uint64_t& member) {
+        interface->register_property_r<uint64_t>(
+            name, member, flags,
+            [&member](const uint64_t&) { return member; });
+    };
+
+    interface->register_property(
+        "Enabled", enabled, [this](const bool& request, bool& old) {
+        old = request;
+        enabled = request;
+        readPending = false;
+        return 1;
+    }, [this](const bool&) { return enabled; });
+    interface->register_property_r<std::vector<uint64_t>>(
+        "ReadLatencyHistogram", std::vector<uint64_t>(), flags,
+        [this](const std::vector<uint64_t>&) {
+        return std::vector<uint64_t>(latencyHistogram.begin(),
+                                     latencyHistogram.end());
+    });
+    counter("MaxReadLatencyUs", maxLatencyUs);
+    counter("LastPollIntervalUs", lastIntervalUs);
+    counter("MaxPollJitterUs", maxJitterUs);
+    counter("GoodReadings", goodReadings);
+    counter("MissedReadings", missedReadings);
+    counter("ErrorStreak", errorStreak);
+    counter("MaxErrorStreak", maxErrorStreak);
+    counter("SuppressedUpdates", suppressedUpdates);
+    counter("LastGoodTimestampUs", lastGoodTimestampUs);
+    interface->register_property_r<double>(
+        "MinCollected", minCollected, flags,
+        [this](const double&) { return minCollected; });
+    interface->register_property_r<double>(
+        "MaxCollected", maxCollected, flags,
+        [this](const double&) { return maxCollected; });
+
+    if (!interface->initialize())
+    {
+        std::cerr << "error initializing sensor instrumentation interface\n";
+        interface = nullptr;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+constexpr const char* sensorInstrumentationInterfaceName =
+    "xyz.openbmc_project.Debug.SensorInstrumentation";
+
+// The process-wide switch is published as the Enabled property of this
+// interface on sensorInstrumentationControlPath
+constexpr const char* sensorInstrumentationControlPath =
+    "/xyz/openbmc_project/sensors";
+
+// Instrumentation starts off unless the daemon is started with
+// DBUS_SENSORS_INSTRUMENTATION set to a value other than "0", e.g. from a
+// systemd drop-in. Setting the Enabled property of the control object turns
+// it on or off for the whole daemon at runtime.
+bool sensorInstrumentationEnabled();
+
+// Publishes the process-wide switch on objectServer, which keeps it. Every
+// daemon building sensors calls it once, before running its io_context.
+void registerSensorInstrumentationControl(
+    sdbusplus::asio::object_server& objectServer);
+
+// Per-sensor reading statistics, published on a debug interface next to the
+// sensor. Collection can be paused per sensor through its Enabled property.
+class SensorInstrumentation
+{
+  public:
+    // Bucket i counts read latencies below 2^(i+1) microseconds, the last
+    // bucket everything slower.
+    static constexpr size_t latencyBuckets = 16;
+
+    SensorInstrumentation() = default;
+
+    // Called right before a sensor submits a read.
+    void readStarted();
+    // Called with the outcome of a read, NaN for a failed one. Sensors that
+    // report readStarted() have every further update before the next read
+    // ignored, so a failure cascading into updateValue() is counted once.
+    void readCompleted(double value);
+    // Called when a reading is dropped for being within hysteresisPublish of
+    // the published value.
+    void updateSuppressed();
+
+    void registerInterface(
+        const std::shared_ptr<sdbusplus::asio::connection>& conn,
+        const std::string& objectPath);
+
+  private:
+    void recordLatency(std::chrono::steady_clock::time_point now);
+
+    bool enabled = true;
+    bool tracksReads = false;
+    bool readPending = false;
+    std::chrono::steady_clock::time_point lastReadStart;
+    std::chrono::steady_clock::duration lastInterval{0};
+
+    std::array<uint64_t, latencyBuckets> latencyHistogram{};
+    uint64_t maxLatencyUs = 0;
+    uint64_t lastIntervalUs = 0;
+    uint64_t maxJitterUs = 0;
+    uint64_t goodReadings = 0;
+    uint64_t missedReadings = 0;
+    uint64_t errorStreak = 0;
+    uint64_t maxErrorStreak = 0;
+    uint64_t suppressedUpdates = 0;
+    // Wall clock time of the last good reading, 0 if there was none
+    uint64_t lastGoodTimestampUs = 0;
+    double minCollected = 0.0;
+    double maxCollected = 0.0;
+
+    std::shared_ptr<sdbusplus::asio::dbus_interface> interface;
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// Orders ASCII keys ignoring case, entity-manager configurations do not
+// agree on the case of some type names
+struct CaseInsensitiveLess
+{
+    static constexpr char lower(char c) noexcept
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    constexpr bool operator()(std::string_view a,
+                              std::string_view b) const noexcept
+    {
+        return std::lexicographical_compare(
+            a.begin(), a.end(), b.begin(), b.end(),
+            [](char x, char y) { return lower(x) < lower(y); });
+    }
+};
+
+// Read-only view of a StaticMap that does not carry its size in its type,
+// for passing lookup tables of different lengths through the same interface
+template <typename Value, typename Less = std::less<std::string_view>>
+class StaticMapView
+{
+  public:
+    using value_type = std::pair<std::string_view, Value>;
+    using const_iterator = const value_type*;
+
+    constexpr StaticMapView(const_iterator first, const_iterator last) :
+        first(first), last(last)
+    {}
+
+    template <typename Map>
+    constexpr explicit StaticMapView(const Map& map) :
+        first(map.begin()), last(map.end())
+    {}
+
+    constexpr const_iterator begin() const noexcept
+    {
+        return first;
+    }
+
+    constexpr const_iterator end() const noexcept
+    {
+        return last;
+    }
+
+    constexpr size_t size() const noexcept
+    {
+        return static_cast<size_t>(last - first);
+    }
+
+    constexpr const_iterator find(std::string_view key) const noexcept
+    {
+        const_iterator found = std::lower_bound(
+            first, last, key, [](const value_type& entry, std::string_view k) {
+            return Less{}(entry.first, k);
+        });
+        if (found == last || Less{}(key, found->first))
+        {
+            return last;
+        }
+        return found;
+    }
+
+  private:
+    const_iterator first;
+    const_iterator last;
+};
+
+// Lookup table keyed by string literals, sorted while compiling so a lookup
+// is a binary search over constant data. Nothing is allocated or built at
+// startup, and a duplicate key fails the build instead of shadowing an entry.
+template <typename Value, size_t N,
+          typename Less = std::less<std::string_view>>
+class StaticMap
+{
+  public:
+    using value_type = std::pair<std::string_view, Value>;
+    using const_iterator = const value_type*;
+
+    consteval explicit StaticMap(std::array<value_type, N> unsorted) :
+        entries(unsorted)
+    {
+        std::sort(entries.begin(), entries.end(),
+                  [](const value_type& a, const value_type& b) {
+            return Less{}(a.first, b.first);
+        });
+        auto duplicate = std::adjacent_find(
+            entries.begin(), entries.end(),
+            [](const value_type& a, const value_type& b) {
+            return !Less{}(a.first, b.first);
+        });
+        if (duplicate != entries.end())
+        {
+            throw std::logic_error("duplicate key in static map");
+        }
+    }
+
+    constexpr const_iterator begin() const noexcept
+    {
+        return entries.data();
+    }
+
+    constexpr const_iterator end() const noexcept
+    {
+        return entries.data() + N;
+    }
+
+    constexpr size_t size() const noexcept
+    {
+        return N;
+    }
+
+    constexpr const_iterator find(std::string_view key) const noexcept
+    {
+        return StaticMapView<Value, Less>(begin(), end()).find(key);
+    }
+
+  private:
+    std::array<value_type, N> entries;
+};
+
+template <typename Value, typename Less = std::less<std::string_view>,
+          size_t N>
+consteval StaticMap<Value, N, Less>
+    makeStaticMap(std::pair<std::string_view, Value> (&&entries)[N])
+{
+    return StaticMap<Value, N, Less>(std::to_array(std::move(entries)));
+}
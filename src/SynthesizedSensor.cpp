@@ -17,6 +17,7 @@
 
 #include "SynthesizedSensor.hpp"
 
+#include "SensorInstrumentation.hpp"
 #include "SensorPaths.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
@@ -346,6 +347,7 @@ int main()
     auto systemBus = std::make_shared<sdbusplus::asio::connection>(io);
     sdbusplus::asio::object_server objectServer(systemBus, true);
     objectServer.add_manager("/xyz/openbmc_project/sensors");
+    registerSensorInstrumentationControl(objectServer);
     systemBus->request_name("xyz.openbmc_project.SynthesizedSensor");
     std::shared_ptr<SynthesizedSensor> sensor =
         nullptr; // wait until we find the config
@@ -0,0 +1,358 @@
+#include "SysfsCatalog.hpp"
+
+#include "Utils.hpp"
+
+#include <linux/netlink.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/post.hpp>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+boost::asio::execution_context::id SysfsCatalog::id;
+
+static constexpr int ueventBufferSize = 4 * 1024 * 1024;
+
+SysfsCatalog::SysfsCatalog(boost::asio::io_context& io) :
+    boost::asio::execution_context::service(io), io(io)
+{
+    // NOLINTNEXTLINE(hicpp-signed-bitwise)
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    NETLINK_KOBJECT_UEVENT);
+    if (fd >= 0)
+    {
+        sockaddr_nl addr{};
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1; // kernel uevents
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    if (fd < 0)
+    {
+        std::cerr << "Unable to listen for uevents, sysfs scans will not be "
+                     "cached: "
+                  << strerror(errno) << "\n";
+        return;
+    }
+    // Probing a chassis worth of hotplugged devices fires off uevents in
+    // bursts, make room for them. The forced variant takes CAP_NET_ADMIN and
+    // is not bound by net.core.rmem_max.
+    int size = ueventBufferSize;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0)
+    {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    ueventSocket =
+        std::make_unique<boost::asio::posix::stream_descriptor>(io, fd);
+    waitForUevents();
+
+    // NOLINTNEXTLINE(hicpp-signed-bitwise)
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd >= 0)
+    {
+        inotify = std::make_unique<boost::asio::posix::stream_descriptor>(io,
+                                                                          fd);
+        waitForInotify();
+    }
+}
+
+SysfsCatalog::~SysfsCatalog()
+{
+    shutdown();
+}
+
+SysfsCatalog& SysfsCatalog::get(boost::asio::io_context& io)
+{
+    return boost::asio::use_service<SysfsCatalog>(io);
+}
+
+void SysfsCatalog::shutdown()
+{
+    ueventSocket.reset();
+    inotify.reset();
+    watches.clear();
+    listings.clear();
+}
+
+void SysfsCatalog::invalidate()
+{
+    listings.clear();
+    ++invalidations;
+}
+
+void SysfsCatalog::onUevent(UeventHandler&& handler)
+{
+    ueventHandlers.emplace_back(std::move(handler));
+}
+
+bool SysfsCatalog::findFiles(const fs::path& dirPath,
+                             std::string_view matchString,
+                             std::vector<fs::path>& foundPaths,
+                             int symlinkDepth)
+{
+    if (matchString.find('/') != std::string_view::npos)
+    {
+        return ::findFiles(dirPath, matchString, foundPaths, symlinkDepth);
+    }
+
+    // Devices instantiated just before this call announce themselves with
+    // uevents that the io_context has not dispatched yet, take them in now.
+    if (ueventSocket)
+    {
+        readUevents();
+    }
+    if (inotify)
+    {
+        readInotify();
+    }
+
+    const Listing& files = listing(dirPath, symlinkDepth);
+    if (!files.exists)
+    {
+        return false;
+    }
+    const std::regex& search = matcher(matchString);
+    for (const fs::path& file : files.files)
+    {
+        if (std::regex_search(file.native(), search))
+        {
+            foundPaths.emplace_back(file);
+        }
+    }
+    return true;
+}
+
+const std::regex& SysfsCatalog::matcher(std::string_view matchString)
+{
+    std::string key(matchString);
+    auto it = matchers.find(key);
+    if (it == matchers.end())
+    {
+        it = matchers.emplace(key, std::regex(key)).first;
+    }
+    return it->second;
+}
+
+const SysfsCatalog::Listing& SysfsCatalog::listing(const fs::path& dirPath,
+                                                   int symlinkDepth)
+{
+    std::string key = dirPath.string() + '\0' + std::to_string(symlinkDepth);
+    auto it = listings.find(key);
+    if (it != listings.end())
+    {
+        return it->second;
+    }
+
+    // Walked the same way as ::findFiles() does for a single level match
+    Listing result;
+    std::vector<fs::path> directories{dirPath};
+    std::error_code ec;
+    result.exists = fs::exists(dirPath, ec);
+    if (result.exists)
+    {
+        for (auto p = fs::recursive_directory_iterator(
+                 dirPath, fs::directory_options::follow_directory_symlink);
+             p != fs::recursive_directory_iterator(); ++p)
+        {
+            if (!is_directory(*p))
+            {
+                result.files.emplace_back(p->path());
+            }
+            else if (p.depth() < symlinkDepth)
+            {
+                directories.emplace_back(p->path());
+            }
+            if (p.depth() >= symlinkDepth)
+            {
+                p.disable_recursion_pending();
+            }
+        }
+    }
+
+    if (!ueventSocket)
+    {
+        // Nothing would tell us the listing went stale
+        static Listing uncached;
+        uncached = std::move(result);
+        return uncached;
+    }
+    for (const fs::path& directory : directories)
+    {
+        watchDirectory(directory);
+    }
+    return listings.emplace(std::move(key), std::move(result)).first->second;
+}
+
+void SysfsCatalog::watchDirectory(const fs::path& dirPath)
+{
+    if (!inotify || watches.contains(dirPath.string()))
+    {
+        return;
+    }
+    // Real sysfs does not report kernel side changes through inotify, the
+    // uevents cover those. This catches trees under DBUS_SENSORS_SYSFS_ROOT.
+    // NOLINTNEXTLINE(hicpp-signed-bitwise)
+    uint32_t mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                    IN_DELETE_SELF | IN_MOVE_SELF;
+    int wd = inotify_add_watch(inotify->native_handle(), dirPath.c_str(),
+                               mask);
+    if (wd >= 0)
+    {
+        watches.emplace(dirPath.string(), wd);
+    }
+}
+
+void SysfsCatalog::waitForUevents()
+{
+    ueventSocket->async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                             [this](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return; // shut down
+        }
+        readUevents();
+        waitForUevents();
+    });
+}
+
+// A uevent is "<action>@<devpath>" followed by KEY=value pairs, all NUL
+// separated. Only devices coming and going can change what a scan finds.
+std::optional<SysfsCatalog::Uevent>
+    SysfsCatalog::parseUevent(std::string_view message)
+{
+    std::string_view header = message.substr(0, message.find('\0'));
+    std::string_view action = header.substr(0, header.find('@'));
+    if (action != "add" && action != "remove" && action != "bind" &&
+        action != "unbind" && action != "move")
+    {
+        return std::nullopt;
+    }
+
+    Uevent event;
+    event.action = action;
+    size_t pos = header.size() + 1;
+    while (pos < message.size())
+    {
+        std::string_view field = message.substr(pos);
+        field = field.substr(0, field.find('\0'));
+        pos += field.size() + 1;
+        if (field.starts_with("DEVPATH="))
+        {
+            event.devpath = field.substr(std::strlen("DEVPATH="));
+        }
+        else if (field.starts_with("SUBSYSTEM="))
+        {
+            event.subsystem = field.substr(std::strlen("SUBSYSTEM="));
+        }
+    }
+    return event;
+}
+
+void SysfsCatalog::readUevents()
+{
+    std::array<char, 8192> buffer{};
+    std::vector<Uevent> events;
+    bool overflowed = false;
+    while (true)
+    {
+        ssize_t len = recv(ueventSocket->native_handle(), buffer.data(),
+                           buffer.size() - 1, 0);
+        if (len < 0 && errno == ENOBUFS)
+        {
+            // The kernel dropped uevents, any of which could have been a
+            // device we list. The socket stays usable, read on.
+            overflowed = true;
+            continue;
+        }
+        if (len <= 0)
+        {
+            break;
+        }
+        std::optional<Uevent> event = parseUevent(
+            std::string_view(buffer.data(), static_cast<size_t>(len)));
+        if (event)
+        {
+            events.emplace_back(std::move(*event));
+        }
+    }
+    if (overflowed)
+    {
+        std::cerr << "Lost uevents, rescanning sysfs\n";
+        // Whatever was lost is covered by looking at everything again
+        events.clear();
+        events.emplace_back(std::string(rescanAction), "", "");
+    }
+    if (events.empty())
+    {
+        return;
+    }
+    invalidate();
+    if (ueventHandlers.empty())
+    {
+        return;
+    }
+    // This also runs from within findFiles(), which the daemons call while
+    // walking their sensor maps, so never call out from here directly.
+    boost::asio::post(io, [this, events{std::move(events)}]() {
+        for (const Uevent& event : events)
+        {
+            for (const UeventHandler& handler : ueventHandlers)
+            {
+                handler(event);
+            }
+        }
+    });
+}
+
+void SysfsCatalog::waitForInotify()
+{
+    inotify->async_wait(boost::asio::posix::stream_descriptor::wait_read,
+                        [this](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return; // shut down
+        }
+        readInotify();
+        waitForInotify();
+    });
+}
+
+void SysfsCatalog::readInotify()
+{
+    alignas(inotify_event) std::array<char, 4096> buffer{};
+    bool stale = false;
+    while (read(inotify->native_handle(), buffer.data(), buffer.size()) > 0)
+    {
+        stale = true;
+    }
+    if (stale)
+    {
+        // Watches on removed directories are gone, set them up again with
+        // the next listing.
+        watches.clear();
+        invalidate();
+    }
+}
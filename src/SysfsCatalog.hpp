@@ -0,0 +1,121 @@
+#pragma once
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Per io_context cache of the sysfs walks done by findFiles(). The files
+// under a directory are listed once and kept until the kernel reports a
+// device being added, removed, bound or unbound through a uevent, or inotify
+// reports a change to one of the listed directories. Match expressions are
+// compiled once.
+//
+// If the uevent socket cannot be opened nothing is cached, as there would be
+// no way to notice devices appearing; only the compiled expressions are then
+// reused.
+//
+// Daemons can also subscribe to the device uevents themselves, to react to a
+// single device coming or going instead of rescanning everything.
+class SysfsCatalog : public boost::asio::execution_context::service
+{
+  public:
+    using key_type = SysfsCatalog;
+
+    static boost::asio::execution_context::id id;
+
+    explicit SysfsCatalog(boost::asio::io_context& io);
+    ~SysfsCatalog() override;
+
+    SysfsCatalog(const SysfsCatalog&) = delete;
+    SysfsCatalog(SysfsCatalog&&) = delete;
+    SysfsCatalog& operator=(const SysfsCatalog&) = delete;
+    SysfsCatalog& operator=(SysfsCatalog&&) = delete;
+
+    static SysfsCatalog& get(boost::asio::io_context& io);
+
+    // Same contract as ::findFiles(). Match strings spanning directories are
+    // passed through to it uncached.
+    bool findFiles(const std::filesystem::path& dirPath,
+                   std::string_view matchString,
+                   std::vector<std::filesystem::path>& foundPaths,
+                   int symlinkDepth = 1);
+
+    // Whether listings are kept, false without the uevent socket
+    bool caching() const
+    {
+        return ueventSocket != nullptr;
+    }
+
+    // Incremented whenever the cached listings are dropped
+    uint64_t generation() const
+    {
+        return invalidations;
+    }
+
+    // Drops every cached listing
+    void invalidate();
+
+    struct Uevent
+    {
+        std::string action;
+        // Relative to /sys, e.g. "/devices/.../3-0058/hwmon/hwmon7"
+        std::string devpath;
+        std::string subsystem;
+    };
+    using UeventHandler = std::function<void(const Uevent&)>;
+
+    // Action of the event handed to the handlers in place of the uevents
+    // lost to an overflow of the socket, with neither devpath nor subsystem.
+    // Any device may have come or gone since.
+    static constexpr std::string_view rescanAction = "rescan";
+
+    // Parses one netlink message of the kernel, nullopt for actions that
+    // cannot change what a scan finds
+    static std::optional<Uevent> parseUevent(std::string_view message);
+
+    // Called for every add, remove, bind, unbind and move uevent, or once
+    // with a rescanAction event if some were lost, from a handler posted to
+    // the io_context after the listings were dropped.
+    void onUevent(UeventHandler&& handler);
+
+  private:
+    struct Listing
+    {
+        bool exists = false;
+        std::vector<std::filesystem::path> files;
+    };
+
+    void shutdown() override;
+
+    const std::regex& matcher(std::string_view matchString);
+    const Listing& listing(const std::filesystem::path& dirPath,
+                           int symlinkDepth);
+    void watchDirectory(const std::filesystem::path& dirPath);
+
+    void waitForUevents();
+    void readUevents();
+    void waitForInotify();
+    void readInotify();
+
+    boost::asio::io_context& io;
+    std::unordered_map<std::string, std::regex> matchers;
+    // Keyed by directory and depth
+    std::unordered_map<std::string, Listing> listings;
+    std::unordered_map<std::string, int> watches;
+    uint64_t invalidations = 0;
+    std::vector<UeventHandler> ueventHandlers;
+
+    std::unique_ptr<boost::asio::posix::stream_descriptor> ueventSocket;
+    std::unique_ptr<boost::asio::posix::stream_descriptor> inotify;
+};
@@ -0,0 +1,433 @@
+#include "SysfsReader.hpp"
+
+#include <liburing.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/random_access_file.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+boost::asio::execution_context::id SysfsReader::id;
+
+SysfsFile::SysfsFile(boost::asio::io_context& io) :
+    reader(SysfsReader::get(io)), file(io)
+{}
+
+SysfsFile::SysfsFile(boost::asio::io_context& io, const std::string& path,
+                     boost::asio::file_base::flags openFlags) :
+    reader(SysfsReader::get(io)), file(io, path, openFlags)
+{
+    registerFile();
+}
+
+SysfsFile::~SysfsFile()
+{
+    reader.cancel(*this);
+    if (fileSlot >= 0)
+    {
+        reader.unregisterFile(fileSlot);
+    }
+}
+
+void SysfsFile::open(const std::string& path,
+                     boost::asio::file_base::flags openFlags)
+{
+    file.open(path, openFlags);
+    registerFile();
+}
+
+bool SysfsFile::is_open() const
+{
+    return file.is_open();
+}
+
+void SysfsFile::close()
+{
+    reader.cancel(*this);
+    if (fileSlot >= 0)
+    {
+        reader.unregisterFile(fileSlot);
+        fileSlot = -1;
+    }
+    file.close();
+}
+
+void SysfsFile::registerFile()
+{
+    if (reader.available() && file.is_open() && fileSlot < 0)
+    {
+        fileSlot = reader.registerFile(file.native_handle());
+    }
+}
+
+void SysfsFile::async_read_some_at(uint64_t offset,
+                                   const boost::asio::mutable_buffer& buffer,
+                                   ReadHandler&& handler)
+{
+    if (!reader.available())
+    {
+        file.async_read_some_at(offset, buffer, std::move(handler));
+        return;
+    }
+    if (!file.is_open())
+    {
+        boost::asio::post(reader.io, [handler{std::move(handler)}]() {
+            handler(boost::asio::error::bad_descriptor, 0);
+        });
+        return;
+    }
+    reader.queueRead(*this, offset, buffer, std::move(handler));
+}
+
+SysfsReader::SysfsReader(boost::asio::io_context& io) :
+    boost::asio::execution_context::service(io), io(io)
+{
+    int ret = io_uring_queue_init(ringEntries, &ring, 0);
+    if (ret < 0)
+    {
+        std::cerr << "Unable to set up sysfs read ring: " << std::strerror(-ret)
+                  << ", falling back to asio reads\n";
+        return;
+    }
+
+    // Both registrations are optimizations only, reads still work without
+    // them if the kernel or its memlock limit does not allow them.
+    if (io_uring_register_files_sparse(&ring, fileTableSize) == 0)
+    {
+        freeFileSlots.reserve(fileTableSize);
+        for (unsigned slot = fileTableSize; slot > 0; slot--)
+        {
+            freeFileSlots.push_back(static_cast<int>(slot - 1));
+        }
+    }
+
+    buffers.resize(bufferCount);
+    std::vector<iovec> iovecs;
+    iovecs.reserve(bufferCount);
+    freeBuffers.reserve(bufferCount);
+    for (size_t index = bufferCount; index > 0; index--)
+    {
+        freeBuffers.push_back(static_cast<int>(index - 1));
+    }
+    for (auto& buffer : buffers)
+    {
+        iovecs.push_back(iovec{buffer.data(), buffer.size()});
+    }
+    buffersRegistered = io_uring_register_buffers(&ring, iovecs.data(),
+                                                  iovecs.size()) == 0;
+
+    // NOLINTNEXTLINE(hicpp-signed-bitwise)
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0 || io_uring_register_eventfd(&ring, eventFd) < 0)
+    {
+        std::cerr << "Unable to set up sysfs read completion notification, "
+                     "falling back to asio reads\n";
+        if (eventFd >= 0)
+        {
+            ::close(eventFd);
+        }
+        io_uring_queue_exit(&ring);
+        return;
+    }
+    eventDescriptor =
+        std::make_unique<boost::asio::posix::stream_descriptor>(io, eventFd);
+    ringReady = true;
+    waitForCompletions();
+}
+
+SysfsReader::~SysfsReader()
+{
+    shutdown();
+}
+
+SysfsReader& SysfsReader::get(boost::asio::io_context& io)
+{
+    return boost::asio::use_service<SysfsReader>(io);
+}
+
+void SysfsReader::shutdown()
+{
+    if (!ringReady)
+    {
+        return;
+    }
+    ringReady = false;
+    eventDescriptor.reset();
+    io_uring_queue_exit(&ring);
+    // Files outliving the reader must not refer into the table any longer
+    for (const Request& request : requests)
+    {
+        if (request.owner != nullptr)
+        {
+            request.owner->request = -1;
+        }
+    }
+    requests.clear();
+    freeRequests.clear();
+    queued.clear();
+}
+
+int SysfsReader::registerFile(int fd)
+{
+    if (freeFileSlots.empty())
+    {
+        return -1;
+    }
+    int slot = freeFileSlots.back();
+    if (io_uring_register_files_update(&ring, static_cast<unsigned>(slot), &fd,
+                                       1) != 1)
+    {
+        return -1;
+    }
+    freeFileSlots.pop_back();
+    return slot;
+}
+
+void SysfsReader::unregisterFile(int slot)
+{
+    if (!ringReady)
+    {
+        return;
+    }
+    // Reads already submitted hold their own reference to the file, so the
+    // slot can be reused straight away.
+    int fd = -1;
+    io_uring_register_files_update(&ring, static_cast<unsigned>(slot), &fd, 1);
+    freeFileSlots.push_back(slot);
+}
+
+void SysfsReader::queueRead(SysfsFile& file, uint64_t offset,
+                            const boost::asio::mutable_buffer& destination,
+                            SysfsFile::ReadHandler&& handler)
+{
+    // Only one read per file is outstanding, as with the asio object this
+    // replaces.
+    cancel(file);
+
+    int index = 0;
+    if (freeRequests.empty())
+    {
+        index = static_cast<int>(requests.size());
+        requests.emplace_back();
+    }
+    else
+    {
+        index = freeRequests.back();
+        freeRequests.pop_back();
+    }
+
+    Request& request = requests[static_cast<size_t>(index)];
+    request.owner = &file;
+    request.fd = file.file.native_handle();
+    request.fileSlot = file.fileSlot;
+    request.offset = offset;
+    request.destination = destination;
+    request.handler = std::move(handler);
+    file.request = index;
+    queued.push_back(index);
+
+    // Everything queued by the handlers running now, usually one poll tick
+    // worth of sensors, is submitted together once they are done.
+    if (!flushPosted)
+    {
+        flushPosted = true;
+        boost::asio::post(io, [this]() {
+            flushPosted = false;
+            flush();
+        });
+    }
+}
+
+void SysfsReader::cancel(SysfsFile& file)
+{
+    // After shutdown there is neither a request nor an io_context to post to
+    if (file.request < 0 || !ringReady)
+    {
+        file.request = -1;
+        return;
+    }
+    Request& request = requests[static_cast<size_t>(file.request)];
+    file.request = -1;
+    request.owner = nullptr;
+    request.cancelled = true;
+    boost::asio::post(io, [handler{std::move(request.handler)}]() {
+        handler(boost::asio::error::operation_aborted, 0);
+    });
+    request.handler = nullptr;
+    // A queued request is dropped by the next flush, an in-flight one when
+    // its completion arrives.
+}
+
+void SysfsReader::releaseRequest(int index)
+{
+    requests[static_cast<size_t>(index)] = Request{};
+    freeRequests.push_back(index);
+}
+
+void SysfsReader::flush()
+{
+    if (!ringReady)
+    {
+        return;
+    }
+
+    unsigned prepared = 0;
+    while (!queued.empty())
+    {
+        int index = queued.front();
+        Request& request = requests[static_cast<size_t>(index)];
+        if (request.cancelled)
+        {
+            queued.pop_front();
+            releaseRequest(index);
+            continue;
+        }
+        if (freeBuffers.empty())
+        {
+            // Picked up again as completions return buffers
+            break;
+        }
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (sqe == nullptr)
+        {
+            io_uring_submit(&ring);
+            submitCount++;
+            prepared = 0;
+            sqe = io_uring_get_sqe(&ring);
+            if (sqe == nullptr)
+            {
+                break;
+            }
+        }
+        queued.pop_front();
+
+        request.buffer = freeBuffers.back();
+        freeBuffers.pop_back();
+        auto& buffer = buffers[static_cast<size_t>(request.buffer)];
+        auto length = static_cast<unsigned>(
+            std::min(request.destination.size(), buffer.size()));
+
+        int fd = request.fd;
+        if (request.fileSlot >= 0)
+        {
+            fd = request.fileSlot;
+        }
+        if (buffersRegistered)
+        {
+            io_uring_prep_read_fixed(sqe, fd, buffer.data(), length,
+                                     request.offset, request.buffer);
+        }
+        else
+        {
+            io_uring_prep_read(sqe, fd, buffer.data(), length, request.offset);
+        }
+        if (request.fileSlot >= 0)
+        {
+            io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+        }
+        io_uring_sqe_set_data64(sqe, static_cast<uint64_t>(index));
+        request.inFlight = true;
+        prepared++;
+    }
+
+    if (prepared != 0)
+    {
+        int ret = io_uring_submit(&ring);
+        if (ret < 0)
+        {
+            // Entries stay in the submission queue and go out with the next
+            // flush.
+            std::cerr << "Sysfs read submission failed: "
+                      << std::strerror(-ret) << "\n";
+            return;
+        }
+        submitCount++;
+    }
+}
+
+void SysfsReader::waitForCompletions()
+{
+    eventDescriptor->async_read_some(
+        boost::asio::buffer(&eventCount, sizeof(eventCount)),
+        [this](const boost::system::error_code& ec, size_t) {
+        if (ec == boost::asio::error::operation_aborted)
+        {
+            return;
+        }
+        if (ec)
+        {
+            std::cerr << "Sysfs read completion error " << ec.message()
+                      << "\n";
+        }
+        handleCompletions();
+        waitForCompletions();
+    });
+}
+
+void SysfsReader::handleCompletions()
+{
+    io_uring_cqe* cqe = nullptr;
+    while (io_uring_peek_cqe(&ring, &cqe) == 0)
+    {
+        auto index = static_cast<int>(io_uring_cqe_get_data64(cqe));
+        int res = cqe->res;
+        io_uring_cqe_seen(&ring, cqe);
+        completeCount++;
+
+        Request& request = requests[static_cast<size_t>(index)];
+        const auto& buffer = buffers[static_cast<size_t>(request.buffer)];
+        freeBuffers.push_back(request.buffer);
+        if (request.cancelled)
+        {
+            releaseRequest(index);
+            continue;
+        }
+
+        boost::system::error_code ec;
+        size_t bytesRead = 0;
+        if (res < 0)
+        {
+            ec = boost::system::error_code(-res,
+                                           boost::system::system_category());
+        }
+        else if (res == 0)
+        {
+            ec = boost::asio::error::eof;
+        }
+        else
+        {
+            bytesRead = std::min(static_cast<size_t>(res),
+                                 request.destination.size());
+            std::memcpy(request.destination.data(), buffer.data(), bytesRead);
+        }
+
+        // The handler typically starts the next read, which may grow the
+        // request table, so nothing may refer into it past this point.
+        SysfsFile::ReadHandler handler = std::move(request.handler);
+        request.owner->request = -1;
+        releaseRequest(index);
+        handler(ec, bytesRead);
+    }
+
+    if (!queued.empty())
+    {
+        flush();
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <liburing.h>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/file_base.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/random_access_file.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SysfsReader;
+
+// Sysfs attribute opened for polling. It keeps the subset of the
+// boost::asio::random_access_file interface used by the sensors, but routes
+// reads through the process-wide SysfsReader so that every read started in
+// the same poll tick goes to the kernel in a single io_uring submission.
+class SysfsFile
+{
+  public:
+    using ReadHandler =
+        std::function<void(const boost::system::error_code&, size_t)>;
+
+    explicit SysfsFile(boost::asio::io_context& io);
+    SysfsFile(boost::asio::io_context& io, const std::string& path,
+              boost::asio::file_base::flags openFlags);
+    ~SysfsFile();
+
+    SysfsFile(const SysfsFile&) = delete;
+    SysfsFile(SysfsFile&&) = delete;
+    SysfsFile& operator=(const SysfsFile&) = delete;
+    SysfsFile& operator=(SysfsFile&&) = delete;
+
+    void open(const std::string& path, boost::asio::file_base::flags openFlags);
+    bool is_open() const;
+    void close();
+
+    // The buffer must stay valid until the handler runs, as with asio. A
+    // close() completes an outstanding read with operation_aborted.
+    void async_read_some_at(uint64_t offset,
+                            const boost::asio::mutable_buffer& buffer,
+                            ReadHandler&& handler);
+
+  private:
+    friend class SysfsReader;
+
+    void registerFile();
+
+    SysfsReader& reader;
+    boost::asio::random_access_file file;
+    // Index in the ring's registered file table, -1 if not registered
+    int fileSlot = -1;
+    // Outstanding request in the reader, -1 if none
+    int request = -1;
+};
+
+// io_uring based read engine shared by all SysfsFiles of an io_context.
+// Reads are queued as they are started and flushed together once the current
+// handler (normally a PollScheduler tick) returns. Files are registered with
+// the ring and data is read into a pool of registered fixed buffers, so a
+// poll costs no per-read fd lookups or page pinning in the kernel.
+class SysfsReader : public boost::asio::execution_context::service
+{
+  public:
+    using key_type = SysfsReader;
+
+    static boost::asio::execution_context::id id;
+
+    explicit SysfsReader(boost::asio::io_context& io);
+    ~SysfsReader() override;
+
+    SysfsReader(const SysfsReader&) = delete;
+    SysfsReader(SysfsReader&&) = delete;
+    SysfsReader& operator=(const SysfsReader&) = delete;
+    SysfsReader& operator=(SysfsReader&&) = delete;
+
+    static SysfsReader& get(boost::asio::io_context& io);
+
+    // False if the kernel refused to set up the ring, in which case SysfsFile
+    // falls back to plain asio reads.
+    bool available() const
+    {
+        return ringReady;
+    }
+
+    uint64_t submissions() const
+    {
+        return submitCount;
+    }
+
+    uint64_t completions() const
+    {
+        return completeCount;
+    }
+
+  private:
+    friend class SysfsFile;
+
+    static constexpr unsigned ringEntries = 256;
+    static constexpr unsigned fileTableSize = 4096;
+    static constexpr size_t bufferCount = 256;
+    static constexpr size_t bufferSize = 128;
+
+    struct Request
+    {
+        SysfsFile* owner = nullptr;
+        int fd = -1;
+        int fileSlot = -1;
+        uint64_t offset = 0;
+        boost::asio::mutable_buffer destination;
+        SysfsFile::ReadHandler handler;
+        int buffer = -1;
+        bool inFlight = false;
+        bool cancelled = false;
+    };
+
+    void shutdown() override;
+
+    int registerFile(int fd);
+    void unregisterFile(int slot);
+    void queueRead(SysfsFile& file, uint64_t offset,
+                   const boost::asio::mutable_buffer& destination,
+                   SysfsFile::ReadHandler&& handler);
+    void cancel(SysfsFile& file);
+    void releaseRequest(int index);
+    void flush();
+    void waitForCompletions();
+    void handleCompletions();
+
+    boost::asio::io_context& io;
+    io_uring ring{};
+    bool ringReady = false;
+    bool buffersRegistered = false;
+    int eventFd = -1;
+    std::unique_ptr<boost::asio::posix::stream_descriptor> eventDescriptor;
+    uint64_t eventCount = 0;
+    bool flushPosted = false;
+
+    std::vector<std::array<char, bufferSize>> buffers;
+    std::vector<int> freeBuffers;
+    std::vector<int> freeFileSlots;
+
+    std::vector<Request> requests;
+    std::vector<int> freeRequests;
+    // Requests waiting for a submission queue entry or a fixed buffer
+    std::deque<int> queued;
+
+    uint64_t submitCount = 0;
+    uint64_t completeCount = 0;
+};
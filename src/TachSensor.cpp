@@ -64,7 +64,8 @@ TachSensor::TachSensor(const std::string& path, const std::string& objectType,
     objServer(objectServer), redundancy(redundancy),
     presence(std::move(presenceSensor)),
     inputDev(io, path, boost::asio::random_access_file::read_only),
-    waitTimer(io), path(path), led(ledIn), ledReg(ledReg), offset(offset)
+    waitTimer(io), path(path), led(ledIn), io(io), ledReg(ledReg),
+    offset(offset)
 {
     sensorInterface = objectServer.add_interface(
         "/xyz/openbmc_project/sensors/fan_tach/" + name,
@@ -120,6 +121,7 @@ TachSensor::~TachSensor()
 void TachSensor::setupRead()
 {
     std::weak_ptr<TachSensor> weakRef = weak_from_this();
+    markReadStarted();
     inputDev.async_read_some_at(
         0, boost::asio::buffer(readBuf),
         [weakRef](const boost::system::error_code& ec, std::size_t bytesRead) {
@@ -219,7 +221,7 @@ void TachSensor::checkThresholds()
     if (ledReg && offset && ledState != curLed)
     {
         ledState = curLed;
-        setLedReg(*ledReg, *offset, status);
+        setLedReg(io, *ledReg, *offset, status);
     }
 }
 
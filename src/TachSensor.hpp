@@ -1,9 +1,10 @@
 #pragma once
 
+#include "PollScheduler.hpp"
+#include "SysfsReader.hpp"
 #include "Thresholds.hpp"
 #include "sensor.hpp"
 
-#include <boost/asio/random_access_file.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include <gpiod.hpp>
@@ -89,10 +90,12 @@ class TachSensor :
     std::unique_ptr<PresenceSensor> presence;
     std::shared_ptr<sdbusplus::asio::dbus_interface> itemIface;
     std::shared_ptr<sdbusplus::asio::dbus_interface> itemAssoc;
-    boost::asio::random_access_file inputDev;
-    boost::asio::steady_timer waitTimer;
+    SysfsFile inputDev;
+    PollTimer waitTimer;
     std::string path;
     std::optional<std::string> led;
+    // For the FPGA LED register writes
+    boost::asio::io_context& io;
     std::optional<uint8_t> ledReg;
     std::optional<uint8_t> offset;
     bool ledState = false;
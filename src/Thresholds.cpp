@@ -20,6 +20,7 @@
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -205,6 +206,51 @@ void persistThreshold(const std::string& path, const std::string& baseInterface,
     }
 }
 
+namespace
+{
+using PropertyNameTable = std::array<std::string, thresProp.size() * 2>;
+
+PropertyNameTable makePropertyNames(const char* highSuffix,
+                                    const char* lowSuffix)
+{
+    PropertyNameTable names;
+    for (const ThresholdDefinition& prop : thresProp)
+    {
+        auto index = static_cast<size_t>(prop.level) * 2;
+        names[index + static_cast<size_t>(Direction::HIGH)] =
+            std::string(prop.levelName) + highSuffix;
+        names[index + static_cast<size_t>(Direction::LOW)] =
+            std::string(prop.levelName) + lowSuffix;
+    }
+    return names;
+}
+
+const std::string& lookupPropertyName(const PropertyNameTable& names,
+                                      Level level, Direction direction)
+{
+    static const std::string empty;
+    if (alarmBit(level, direction) == 0)
+    {
+        return empty;
+    }
+    return names[(static_cast<size_t>(level) * 2) +
+                 static_cast<size_t>(direction)];
+}
+} // namespace
+
+const std::string& levelPropertyName(Level level, Direction direction)
+{
+    static const PropertyNameTable names = makePropertyNames("High", "Low");
+    return lookupPropertyName(names, level, direction);
+}
+
+const std::string& alarmPropertyName(Level level, Direction direction)
+{
+    static const PropertyNameTable names = makePropertyNames("AlarmHigh",
+                                                             "AlarmLow");
+    return lookupPropertyName(names, level, direction);
+}
+
 void updateThresholds(Sensor* sensor)
 {
     for (const auto& threshold : sensor->thresholds)
@@ -217,8 +263,8 @@ void updateThresholds(Sensor* sensor)
             continue;
         }
 
-        std::string property = Sensor::propertyLevel(threshold.level,
-                                                     threshold.direction);
+        const std::string& property = levelPropertyName(threshold.level,
+                                                        threshold.direction);
         if (property.empty())
         {
             continue;
@@ -237,83 +283,72 @@ static int cLoMidstate = 0;
 static int cDebugThrottle = 0;
 static constexpr int assertLogCount = 10;
 
-struct ChangeParam
+static bool isAlarmAsserted(const Sensor* sensor, const Threshold& threshold)
 {
-    ChangeParam(Threshold whichThreshold, bool status, double value) :
-        threshold(whichThreshold), asserted(status), assertValue(value)
-    {}
-
-    Threshold threshold;
-    bool asserted;
-    double assertValue;
-};
+    return (sensor->thresholdAlarms &
+            alarmBit(threshold.level, threshold.direction)) != 0;
+}
 
-static std::vector<ChangeParam> checkThresholds(Sensor* sensor, double value)
+// Returns the alarm state the given value calls for, or nullopt if the value
+// sits inside the hysteresis band and the alarm should keep its state.
+static std::optional<bool> evaluateThreshold(Sensor* sensor,
+                                             const Threshold& threshold,
+                                             double value)
 {
-    std::vector<ChangeParam> thresholdChanges;
-    if (sensor->thresholds.empty())
-    {
-        return thresholdChanges;
-    }
-
-    for (auto& threshold : sensor->thresholds)
+    // Use "Schmitt trigger" logic to avoid threshold trigger spam,
+    // if value is noisy while hovering very close to a threshold.
+    // When a threshold is crossed, indicate true immediately,
+    // but require more distance to be crossed the other direction,
+    // before resetting the indicator back to false.
+    if (threshold.direction == thresholds::Direction::HIGH)
     {
-        // Use "Schmitt trigger" logic to avoid threshold trigger spam,
-        // if value is noisy while hovering very close to a threshold.
-        // When a threshold is crossed, indicate true immediately,
-        // but require more distance to be crossed the other direction,
-        // before resetting the indicator back to false.
-        if (threshold.direction == thresholds::Direction::HIGH)
+        if (value >= threshold.value)
         {
-            if (value >= threshold.value)
-            {
-                thresholdChanges.emplace_back(threshold, true, value);
-                if (++cHiTrue < assertLogCount)
-                {
-                    std::cerr << "Sensor " << sensor->name << " high threshold "
-                              << threshold.value << " assert: value " << value
-                              << " raw data " << sensor->rawValue << "\n";
-                }
-            }
-            else if (value < (threshold.value - threshold.hysteresis))
+            if (!isAlarmAsserted(sensor, threshold) &&
+                ++cHiTrue < assertLogCount)
             {
-                thresholdChanges.emplace_back(threshold, false, value);
-                ++cHiFalse;
-            }
-            else
-            {
-                ++cHiMidstate;
+                std::cerr << "Sensor " << sensor->name << " high threshold "
+                          << threshold.value << " assert: value " << value
+                          << " raw data " << sensor->rawValue << "\n";
             }
+            return true;
         }
-        else if (threshold.direction == thresholds::Direction::LOW)
+        if (value < (threshold.value - threshold.hysteresis))
         {
-            if (value <= threshold.value)
-            {
-                thresholdChanges.emplace_back(threshold, true, value);
-                if (++cLoTrue < assertLogCount)
-                {
-                    std::cerr << "Sensor " << sensor->name << " low threshold "
-                              << threshold.value << " assert: value "
-                              << sensor->value << " raw data "
-                              << sensor->rawValue << "\n";
-                }
-            }
-            else if (value > (threshold.value + threshold.hysteresis))
-            {
-                thresholdChanges.emplace_back(threshold, false, value);
-                ++cLoFalse;
-            }
-            else
+            ++cHiFalse;
+            return false;
+        }
+        ++cHiMidstate;
+        return std::nullopt;
+    }
+    if (threshold.direction == thresholds::Direction::LOW)
+    {
+        if (value <= threshold.value)
+        {
+            if (!isAlarmAsserted(sensor, threshold) &&
+                ++cLoTrue < assertLogCount)
             {
-                ++cLoMidstate;
+                std::cerr << "Sensor " << sensor->name << " low threshold "
+                          << threshold.value << " assert: value "
+                          << sensor->value << " raw data " << sensor->rawValue
+                          << "\n";
             }
+            return true;
         }
-        else
+        if (value > (threshold.value + threshold.hysteresis))
         {
-            std::cerr << "Error determining threshold direction\n";
+            ++cLoFalse;
+            return false;
         }
+        ++cLoMidstate;
+        return std::nullopt;
     }
+    std::cerr << "Error determining threshold direction\n";
+    return std::nullopt;
+}
 
+static void logThresholdCounters()
+{
     // Throttle debug output, so that it does not continuously spam
     ++cDebugThrottle;
     if (cDebugThrottle >= 1000)
@@ -327,8 +362,6 @@ static std::vector<ChangeParam> checkThresholds(Sensor* sensor, double value)
                       << " M=" << cLoMidstate << "\n";
         }
     }
-
-    return thresholdChanges;
 }
 
 void ThresholdTimer::startTimer(const std::weak_ptr<Sensor>& weakSensor,
@@ -386,20 +419,24 @@ void ThresholdTimer::startTimer(const std::weak_ptr<Sensor>& weakSensor,
 
 bool checkThresholds(Sensor* sensor)
 {
-    bool status = true;
-    std::vector<ChangeParam> changes = checkThresholds(sensor, sensor->value);
-    for (const auto& change : changes)
+    constexpr uint16_t criticalAlarms =
+        alarmBit(Level::CRITICAL, Direction::HIGH) |
+        alarmBit(Level::CRITICAL, Direction::LOW);
+
+    double value = sensor->value;
+    for (const auto& threshold : sensor->thresholds)
     {
-        assertThresholds(sensor, change.assertValue, change.threshold.level,
-                         change.threshold.direction, change.asserted);
-        if (change.threshold.level == thresholds::Level::CRITICAL &&
-            change.asserted)
+        std::optional<bool> assert = evaluateThreshold(sensor, threshold,
+                                                       value);
+        if (assert)
         {
-            status = false;
+            assertThresholds(sensor, value, threshold.level,
+                             threshold.direction, *assert);
         }
     }
+    logThresholdCounters();
 
-    return status;
+    return (sensor->thresholdAlarms & criticalAlarms) == 0;
 }
 
 void checkThresholdsPowerDelay(const std::weak_ptr<Sensor>& weakSensor,
@@ -412,70 +449,95 @@ void checkThresholdsPowerDelay(const std::weak_ptr<Sensor>& weakSensor,
     }
 
     Sensor* sensor = sensorPtr.get();
-    std::vector<ChangeParam> changes = checkThresholds(sensor, sensor->value);
-    for (const auto& change : changes)
+    double value = sensor->value;
+    for (const auto& threshold : sensor->thresholds)
     {
+        std::optional<bool> assert = evaluateThreshold(sensor, threshold,
+                                                       value);
+        if (!assert)
+        {
+            continue;
+        }
         // When CPU is powered off, some volatges are expected to
         // go below low thresholds. Filter these events with thresholdTimer.
         // 1. always delay the assertion of low events to see if they are
         //   caused by power off event.
-        // 2. conditional delay the de-assertion of low events if there is
-        //   an existing timer for assertion.
-        // 3. no delays for de-assert of low events if there is an existing
-        //   de-assert for low event. This means 2nd de-assert would happen
-        //   first and when timer expires for the previous one, no additional
-        //   signal will be logged.
+        // 2. if a low event clears while its assertion is still delayed,
+        //   drop the pending assertion, it was a transient.
+        // 3. no delays for de-assert of low events.
         // 4. no delays for all high events.
-        if (change.threshold.direction == thresholds::Direction::LOW)
+        if (threshold.direction == thresholds::Direction::LOW)
         {
-            if (change.asserted || thresholdTimer.hasActiveTimer(
-                                       change.threshold, !change.asserted))
+            if (*assert)
             {
-                thresholdTimer.startTimer(weakSensor, change.threshold,
-                                          change.asserted, change.assertValue);
+                if (!isAlarmAsserted(sensor, threshold) &&
+                    !thresholdTimer.hasActiveTimer(threshold, true))
+                {
+                    thresholdTimer.startTimer(weakSensor, threshold, true,
+                                              value);
+                }
                 continue;
             }
+            if (thresholdTimer.hasActiveTimer(threshold, true))
+            {
+                thresholdTimer.stopTimer(threshold, true);
+            }
         }
-        assertThresholds(sensor, change.assertValue, change.threshold.level,
-                         change.threshold.direction, change.asserted);
+        assertThresholds(sensor, value, threshold.level, threshold.direction,
+                         *assert);
     }
+    logThresholdCounters();
 }
 
 void assertThresholds(Sensor* sensor, double assertValue,
                       thresholds::Level level, thresholds::Direction direction,
                       bool assert)
 {
-    std::shared_ptr<sdbusplus::asio::dbus_interface> interface =
-        sensor->getThresholdInterface(level);
+    uint16_t bit = alarmBit(level, direction);
+    if (bit == 0)
+    {
+        std::cout << "Alarm property is empty \n";
+        return;
+    }
+    // Only real transitions reach D-Bus
+    if (((sensor->thresholdAlarms & bit) != 0) == assert)
+    {
+        return;
+    }
 
+    const std::shared_ptr<sdbusplus::asio::dbus_interface>& interface =
+        sensor->thresholdInterfaces[static_cast<size_t>(level)];
     if (!interface)
     {
         return;
     }
 
-    std::string property = Sensor::propertyAlarm(level, direction);
-    if (property.empty())
+    if (assert)
     {
-        std::cout << "Alarm property is empty \n";
-        return;
+        sensor->thresholdAlarms |= bit;
     }
-    if (interface->set_property<bool, true>(property, assert))
+    else
     {
-        try
-        {
-            // msg.get_path() is interface->get_object_path()
-            sdbusplus::message_t msg =
-                interface->new_signal("ThresholdAsserted");
+        sensor->thresholdAlarms &= static_cast<uint16_t>(~bit);
+    }
 
-            msg.append(sensor->name, interface->get_interface_name(), property,
-                       assert, assertValue);
-            msg.signal_send();
-        }
-        catch (const sdbusplus::exception_t& e)
-        {
-            std::cerr
-                << "Failed to send thresholdAsserted signal with assertValue\n";
-        }
+    // The alarm property reads the bit back, only the PropertiesChanged is
+    // queued and goes out with the rest of this reading's changes.
+    const std::string& property = alarmPropertyName(level, direction);
+    sensor->propertyChanges.mark(interface, property.c_str());
+    try
+    {
+        // msg.get_path() is interface->get_object_path()
+        sdbusplus::message_t msg = interface->new_signal("ThresholdAsserted");
+
+        msg.append(sensor->name, interface->get_interface_name(), property,
+                   assert, assertValue);
+        msg.signal_send();
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        std::cerr
+            << "Failed to send thresholdAsserted signal with assertValue\n";
     }
 }
 
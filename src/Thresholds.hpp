@@ -6,6 +6,8 @@
 #include <boost/asio/steady_timer.hpp>
 #include <nlohmann/json.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
@@ -145,13 +147,32 @@ constexpr static std::array<thresholds::ThresholdDefinition, 5> thresProp = {
 
 std::string getInterface(Level level);
 
+// Property names of each (level, direction) pair, built once so that the
+// per-reading path never has to assemble them. Empty for invalid pairs.
+const std::string& levelPropertyName(Level level, Direction direction);
+const std::string& alarmPropertyName(Level level, Direction direction);
+
+// Bit tracking the alarm of a (level, direction) pair in
+// Sensor::thresholdAlarms, 0 for invalid pairs.
+constexpr uint16_t alarmBit(Level level, Direction direction)
+{
+    auto levelIndex = static_cast<size_t>(level);
+    auto directionIndex = static_cast<size_t>(direction);
+    if (levelIndex >= thresProp.size() || direction == Direction::ERROR)
+    {
+        return 0;
+    }
+    return static_cast<uint16_t>(1U << ((levelIndex * 2) + directionIndex));
+}
+
 void persistThreshold(const std::string& path, const std::string& baseInterface,
                       const thresholds::Threshold& threshold,
                       std::shared_ptr<sdbusplus::asio::connection>& conn,
                       size_t thresholdCount, const std::string& label);
 
 void updateThresholds(Sensor* sensor);
-// returns false if a critical threshold has been crossed, true otherwise
+// Updates the alarms whose state changed with the sensor's current value.
+// Returns false if a critical alarm is asserted, true otherwise.
 bool checkThresholds(Sensor* sensor);
 void checkThresholdsPowerDelay(const std::weak_ptr<Sensor>& weakSensor,
                                ThresholdTimer& thresholdTimer);
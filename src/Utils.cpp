@@ -23,6 +23,7 @@
 #include "sharedMemUtils.hpp"
 
 #include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
 #include <sdbusplus/asio/connection.hpp>
@@ -37,9 +38,12 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -71,6 +75,19 @@ static std::unique_ptr<sdbusplus::bus::match_t> powerMatch = nullptr;
 static std::unique_ptr<sdbusplus::bus::match_t> postMatch = nullptr;
 static std::unique_ptr<sdbusplus::bus::match_t> chassisMatch = nullptr;
 
+// One set of power matches serves every sensor class of a process, each
+// class adds its callback
+static std::vector<std::function<void(PowerState type, bool state)>>
+    powerCallbacks;
+
+static void notifyPowerState(PowerState type, bool state)
+{
+    for (size_t ii = 0; ii < powerCallbacks.size(); ii++)
+    {
+        powerCallbacks[ii](type, state);
+    }
+}
+
 /**
  * return the contents of a file
  * @param[in] hwmonFile - the path to the file to read
@@ -158,48 +175,238 @@ std::set<std::string> getPermitSet(const SensorBaseConfigMap& config)
     return permitSet;
 }
 
-bool getSensorConfiguration(
-    const std::string& type,
-    const std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
-    ManagedObjectType& resp, bool useCache)
+void GetSensorConfiguration::getConfiguration(
+    const std::vector<std::string>& types, size_t retries)
 {
-    static ManagedObjectType managedObj;
-    std::string typeIntf = configInterfaceName(type);
+    std::shared_ptr<GetSensorConfiguration> self = shared_from_this();
+    // Posted, so the callback never runs from within this call
+    boost::asio::post(dbusConnection->get_io_context(),
+                      [self, types, retries]() {
+        self->started = std::chrono::steady_clock::now();
+        if (getMirroredConfiguration(self->dbusConnection, types,
+                                     self->respData))
+        {
+            self->complete();
+            return;
+        }
 
-    if (!useCache)
+        std::vector<std::string> interfaces;
+        interfaces.reserve(types.size());
+        for (const auto& type : types)
+        {
+            if (!type.empty())
+            {
+                interfaces.push_back(configInterfaceName(type));
+            }
+        }
+        self->getSubTree(interfaces, retries, 0);
+    });
+}
+
+GetSensorConfiguration::~GetSensorConfiguration()
+{
+    // Dropped with reads still outstanding, when the io_context was stopped
+    if (!completed)
     {
-        managedObj.clear();
-        sdbusplus::message_t getManagedObjects =
-            dbusConnection->new_method_call(
-                entityManagerName, "/xyz/openbmc_project/inventory",
-                "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
-        try
+        incomplete = true;
+    }
+    complete();
+}
+
+void GetSensorConfiguration::getSubTree(
+    const std::vector<std::string>& interfaces, size_t retries, size_t attempt)
+{
+    std::shared_ptr<GetSensorConfiguration> self = shared_from_this();
+    dbusConnection->async_method_call(
+        [self, interfaces, retries, attempt](const boost::system::error_code ec,
+                                             const GetSubTreeType& ret) {
+        if (ec)
         {
-            sdbusplus::message_t reply =
-                dbusConnection->call(getManagedObjects);
-            reply.read(managedObj);
+            std::cerr << "Error calling mapper\n";
+            if (attempt >= retries)
+            {
+                self->incomplete = true;
+                self->subTreeDone = true;
+                self->requestDone();
+                return;
+            }
+            auto timer = std::make_shared<boost::asio::steady_timer>(
+                self->dbusConnection->get_io_context());
+            timer->expires_after(
+                backoffDelay(attempt + 1, retryDelay, maxRetryDelay));
+            timer->async_wait([self, timer, interfaces, retries,
+                               attempt](boost::system::error_code ec) {
+                if (ec)
+                {
+                    std::cerr << "Timer error!\n";
+                    self->incomplete = true;
+                    self->subTreeDone = true;
+                    self->requestDone();
+                    return;
+                }
+                self->getSubTree(interfaces, retries, attempt + 1);
+            });
+            return;
         }
-        catch (const sdbusplus::exception_t& e)
+
+        for (const auto& [path, objDict] : ret)
         {
-            std::cerr << "While calling GetManagedObjects on service:"
-                      << entityManagerName << " exception name:" << e.name()
-                      << "and description:" << e.description()
-                      << " was thrown\n";
-            return false;
+            if (objDict.empty())
+            {
+                continue;
+            }
+            const std::string& owner = objDict.begin()->first;
+            // Only the requested interfaces and those under them, such as
+            // the thresholds next to the one matched, are read
+            for (const std::string& interface : objDict.begin()->second)
+            {
+                if (std::ranges::none_of(
+                        interfaces, [&interface](const std::string& possible) {
+                    return interface.starts_with(possible);
+                }))
+                {
+                    continue;
+                }
+                self->queued.emplace_back(Request{path, interface, owner});
+            }
         }
-    }
-    for (const auto& pathPair : managedObj)
+        self->subTreeDone = true;
+        self->fetchNext();
+        self->requestDone();
+    },
+        mapper::busName, mapper::path, mapper::interface, mapper::subtree, "/",
+        0, interfaces);
+}
+
+void GetSensorConfiguration::fetchNext()
+{
+    while (inFlight < maxInFlight && !queued.empty())
     {
-        for (const auto& [intf, cfg] : pathPair.second)
+        Request request = std::move(queued.front());
+        queued.pop_front();
+        fetch(std::move(request));
+    }
+}
+
+void GetSensorConfiguration::fetch(Request&& request)
+{
+    std::shared_ptr<GetSensorConfiguration> self = shared_from_this();
+    ++inFlight;
+    ++request.attempt;
+    auto start = std::chrono::steady_clock::now();
+    // The request is moved into the handler, its strings are copied into the
+    // call first.
+    std::string path = request.path;
+    std::string owner = request.owner;
+    std::string interface = request.interface;
+    dbusConnection->async_method_call(
+        [self, start, request{std::move(request)}](
+            const boost::system::error_code ec,
+            SensorBaseConfigMap& data) mutable {
+        --self->inFlight;
+        self->slowest = std::max(self->slowest,
+                                 std::chrono::steady_clock::now() - start);
+        if (ec)
         {
-            if (intf.starts_with(typeIntf))
+            if (request.attempt >= maxAttempts)
             {
-                resp.emplace(pathPair);
-                break;
+                std::cerr << "Error getting " << request.path << " "
+                          << request.interface << ", giving up\n";
+                self->incomplete = true;
+            }
+            else
+            {
+                std::chrono::milliseconds delay =
+                    backoffDelay(request.attempt, retryDelay, maxRetryDelay);
+                std::cerr << "Error getting " << request.path << " "
+                          << request.interface << ", retrying in "
+                          << delay.count() << "ms\n";
+                ++self->delayed;
+                auto timer = std::make_shared<boost::asio::steady_timer>(
+                    self->dbusConnection->get_io_context());
+                timer->expires_after(delay);
+                timer->async_wait([self, timer, request{std::move(request)}](
+                                      boost::system::error_code ec) mutable {
+                    --self->delayed;
+                    if (ec)
+                    {
+                        std::cerr << "Timer error!\n";
+                        self->incomplete = true;
+                    }
+                    else
+                    {
+                        self->queued.emplace_back(std::move(request));
+                    }
+                    self->fetchNext();
+                    self->requestDone();
+                });
             }
         }
+        else
+        {
+            self->respData[request.path][request.interface] = std::move(data);
+        }
+        self->fetchNext();
+        self->requestDone();
+    },
+        owner, path, "org.freedesktop.DBus.Properties", "GetAll", interface);
+}
+
+void GetSensorConfiguration::requestDone()
+{
+    if (subTreeDone && inFlight == 0 && delayed == 0 && queued.empty())
+    {
+        complete();
     }
-    return true;
+}
+
+void GetSensorConfiguration::complete()
+{
+    if (completed)
+    {
+        return;
+    }
+    completed = true;
+
+    if (slowest > slowRequest)
+    {
+        std::cerr << "Configuration fetch of " << respData.size()
+                  << " objects took "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - started)
+                         .count()
+                  << "ms, slowest GetAll "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(
+                         slowest)
+                         .count()
+                  << "ms\n";
+    }
+    callback(respData, incomplete);
+}
+
+const std::string& sysfsRoot()
+{
+    static const std::string root = []() -> std::string {
+        const char* env = std::getenv("DBUS_SENSORS_SYSFS_ROOT");
+        if (env == nullptr)
+        {
+            return "";
+        }
+        std::string_view value(env);
+        while (value.ends_with('/'))
+        {
+            value.remove_suffix(1);
+        }
+        return std::string(value);
+    }();
+    return root;
+}
+
+std::string sysfsPath(std::string_view path)
+{
+    std::string result = sysfsRoot();
+    result += path;
+    return result;
 }
 
 bool findFiles(const fs::path& dirPath, std::string_view matchString,
@@ -279,8 +486,7 @@ bool findFiles(const fs::path& dirPath, std::string_view matchString,
             }
             std::smatch match;
             std::string component = pathIt->string();
-            std::regex regexPiece(*matchPiece);
-            if (!std::regex_match(component, match, regexPiece))
+            if (!std::regex_match(component, match, *matchPiece))
             {
                 // path prefix doesn't match, no need to iterate further
                 p.disable_recursion_pending();
@@ -456,6 +662,7 @@ void setupPowerMatchCallback(
 {
     static boost::asio::steady_timer timer(conn->get_io_context());
     static boost::asio::steady_timer timerChassisOn(conn->get_io_context());
+    powerCallbacks.emplace_back(std::move(hostStatusCallback));
     // create a match for powergood changes, first time do a method call to
     // cache the correct value
     if (powerMatch)
@@ -468,7 +675,7 @@ void setupPowerMatchCallback(
         "type='signal',interface='" + std::string(properties::interface) +
             "',path='" + std::string(power::path) + "',arg0='" +
             std::string(power::interface) + "'",
-        [hostStatusCallback](sdbusplus::message_t& message) {
+        [](sdbusplus::message_t& message) {
         std::string objectName;
         boost::container::flat_map<std::string, std::variant<std::string>>
             values;
@@ -482,13 +689,13 @@ void setupPowerMatchCallback(
             {
                 timer.cancel();
                 powerStatusOn = false;
-                hostStatusCallback(PowerState::on, powerStatusOn);
+                notifyPowerState(PowerState::on, powerStatusOn);
                 return;
             }
             // on comes too quickly
             timer.expires_after(std::chrono::seconds(10));
             timer.async_wait(
-                [hostStatusCallback](boost::system::error_code ec) {
+                [](boost::system::error_code ec) {
                 if (ec == boost::asio::error::operation_aborted)
                 {
                     return;
@@ -499,7 +706,7 @@ void setupPowerMatchCallback(
                     return;
                 }
                 powerStatusOn = true;
-                hostStatusCallback(PowerState::on, powerStatusOn);
+                notifyPowerState(PowerState::on, powerStatusOn);
             });
         }
     });
@@ -509,7 +716,7 @@ void setupPowerMatchCallback(
         "type='signal',interface='" + std::string(properties::interface) +
             "',path='" + std::string(post::path) + "',arg0='" +
             std::string(post::interface) + "'",
-        [hostStatusCallback](sdbusplus::message_t& message) {
+        [](sdbusplus::message_t& message) {
         std::string objectName;
         boost::container::flat_map<std::string, std::variant<std::string>>
             values;
@@ -521,7 +728,7 @@ void setupPowerMatchCallback(
             biosHasPost = (value != "Inactive") &&
                           (value != "xyz.openbmc_project.State.OperatingSystem."
                                     "Status.OSStatus.Inactive");
-            hostStatusCallback(PowerState::biosPost, biosHasPost);
+            notifyPowerState(PowerState::biosPost, biosHasPost);
         }
     });
 
@@ -530,8 +737,7 @@ void setupPowerMatchCallback(
         "type='signal',interface='" + std::string(properties::interface) +
             "',path='" + std::string(chassis::path) + "',arg0='" +
             std::string(chassis::interface) + "'",
-        [hostStatusCallback = std::move(hostStatusCallback)](
-            sdbusplus::message_t& message) {
+        [](sdbusplus::message_t& message) {
         std::string objectName;
         boost::container::flat_map<std::string, std::variant<std::string>>
             values;
@@ -545,13 +751,13 @@ void setupPowerMatchCallback(
             {
                 timerChassisOn.cancel();
                 chassisStatusOn = false;
-                hostStatusCallback(PowerState::chassisOn, chassisStatusOn);
+                notifyPowerState(PowerState::chassisOn, chassisStatusOn);
                 return;
             }
             // on comes too quickly
             timerChassisOn.expires_after(std::chrono::seconds(10));
             timerChassisOn.async_wait(
-                [hostStatusCallback](boost::system::error_code ec) {
+                [](boost::system::error_code ec) {
                 if (ec == boost::asio::error::operation_aborted)
                 {
                     return;
@@ -562,7 +768,7 @@ void setupPowerMatchCallback(
                     return;
                 }
                 chassisStatusOn = true;
-                hostStatusCallback(PowerState::chassisOn, chassisStatusOn);
+                notifyPowerState(PowerState::chassisOn, chassisStatusOn);
             });
         }
     });
@@ -597,6 +803,106 @@ void findLimits(std::pair<double, double>& limits,
     }
 }
 
+// Reads a non-negative Publish* number from the configuration, invalid
+// values are reported and ignored.
+static std::optional<double> getPublishSetting(const SensorBaseConfigMap& cfg,
+                                               const char* key)
+{
+    auto find = cfg.find(key);
+    if (find == cfg.end())
+    {
+        return std::nullopt;
+    }
+    double seconds = std::visit(VariantToDoubleVisitor(), find->second);
+    if (!std::isfinite(seconds) || seconds < 0.0)
+    {
+        std::cerr << "Ignoring invalid " << key << " " << seconds << "\n";
+        return std::nullopt;
+    }
+    return seconds;
+}
+
+PublishPolicy getPublishPolicy(const SensorBaseConfigMap& cfg)
+{
+    PublishPolicy policy;
+
+    std::optional<double> deadband = getPublishSetting(cfg, "PublishDeadband");
+    if (deadband)
+    {
+        policy.deadband = *deadband;
+    }
+    std::optional<double> percent = getPublishSetting(cfg,
+                                                      "PublishDeadbandPercent");
+    if (percent)
+    {
+        policy.relativeDeadband = *percent / 100.0;
+    }
+
+    std::optional<double> minInterval = getPublishSetting(cfg,
+                                                          "PublishMinInterval");
+    if (minInterval)
+    {
+        policy.minInterval = std::chrono::milliseconds(
+            static_cast<int64_t>(*minInterval * 1000));
+    }
+    std::optional<double> heartbeat = getPublishSetting(cfg,
+                                                        "PublishHeartbeat");
+    if (heartbeat)
+    {
+        policy.heartbeat = std::chrono::milliseconds(
+            static_cast<int64_t>(*heartbeat * 1000));
+    }
+
+    if (policy.heartbeat.count() != 0 &&
+        policy.heartbeat < policy.minInterval)
+    {
+        std::cerr << "PublishHeartbeat shorter than PublishMinInterval, "
+                     "using PublishMinInterval\n";
+        policy.heartbeat = policy.minInterval;
+    }
+    return policy;
+}
+
+bool ValuePublisher::update(const PublishPolicy& policy,
+                            double defaultDeadband, double reading,
+                            std::chrono::steady_clock::time_point now)
+{
+    bool nanChanged = std::isnan(published) != std::isnan(reading);
+    // Judged on every reading, so a value that went back within the
+    // deadband of the published one is not published once minInterval
+    // has passed
+    bool publishPending = exceedsDeadband(policy, defaultDeadband, reading);
+
+    auto sincePublish = now - lastPublish;
+    bool heartbeatDue = policy.heartbeat.count() != 0 &&
+                        sincePublish >= policy.heartbeat;
+    if (!nanChanged && !heartbeatDue &&
+        (!publishPending || sincePublish < policy.minInterval))
+    {
+        return false;
+    }
+    published = reading;
+    lastPublish = now;
+    return true;
+}
+
+bool ValuePublisher::exceedsDeadband(const PublishPolicy& policy,
+                                     double defaultDeadband,
+                                     double reading) const
+{
+    const auto lNan = std::isnan(published);
+    const auto rNan = std::isnan(reading);
+    if (lNan || rNan)
+    {
+        return (lNan != rNan);
+    }
+    double deadband = std::isnan(policy.deadband) ? defaultDeadband
+                                                  : policy.deadband;
+    deadband = std::max(deadband,
+                        policy.relativeDeadband * std::abs(published));
+    return std::abs(published - reading) > deadband;
+}
+
 void createAssociation(
     std::shared_ptr<sdbusplus::asio::dbus_interface>& association,
     const std::string& path)
@@ -717,6 +1023,42 @@ std::optional<double> readFile(const std::string& thresholdFile,
     return std::nullopt;
 }
 
+bool replaceFileIfChanged(const fs::path& file, const std::string& contents)
+{
+    std::ifstream previous(file);
+    if (previous.good())
+    {
+        std::string old((std::istreambuf_iterator<char>(previous)),
+                        std::istreambuf_iterator<char>());
+        if (old == contents)
+        {
+            return true;
+        }
+    }
+
+    std::error_code ec;
+    fs::create_directories(file.parent_path(), ec);
+    fs::path temporary = file;
+    temporary += ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::trunc);
+        output << contents;
+        if (!output.good())
+        {
+            std::cerr << "Unable to write " << temporary << "\n";
+            return false;
+        }
+    }
+    fs::rename(temporary, file, ec);
+    if (ec)
+    {
+        std::cerr << "Unable to replace " << file << ": " << ec.message()
+                  << "\n";
+        return false;
+    }
+    return true;
+}
+
 std::optional<std::tuple<std::string, std::string, std::string>>
     splitFileName(const fs::path& filePath)
 {
@@ -811,6 +1153,13 @@ void setupManufacturingModeMatch(sdbusplus::asio::connection& conn)
         handleSpecialModeChange(*manufacturingModeStatus);
     });
 
+    // The matches above keep the mode current for every later caller
+    static bool modeRequested = false;
+    if (modeRequested)
+    {
+        return;
+    }
+    modeRequested = true;
     conn.async_method_call(
         [](const boost::system::error_code ec,
            const std::variant<std::string>& getManufactMode) {
@@ -929,18 +1278,25 @@ void getSensorParamMapValues(double& maxValue, double& minValue,
 }
 
 #ifdef NVIDIA_SHMEM
-void updateTelemetry(const std::string& objPath, const std::string& ifaceName,
-                     const char* propertyName, const double& value,
-                     const std::string& parentChassis)
+void TelemetryHandle::bind(const std::string& objectPath,
+                           const std::string& interfaceName,
+                           const std::string& configurationPath)
+{
+    objPath = objectPath;
+    ifaceName = interfaceName;
+    parentChassis =
+        sdbusplus::message::object_path(configurationPath).parent_path();
+}
+
+void TelemetryHandle::update(const char* propertyName, double value)
 {
     // Update Shared Memory Space
-    DbusVariantType propValue = value;
+    propValue = value;
     uint16_t retCode = 0;
     uint64_t timestamp =
         std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::steady_clock::now().time_since_epoch())
             .count();
-    std::vector<uint8_t> rawPropValue = {};
 
     tal::TelemetryAggregator::updateTelemetry(objPath, ifaceName, propertyName,
                                               rawPropValue, timestamp, retCode,
@@ -9,14 +9,20 @@
 #include <sdbusplus/asio/object_server.hpp>
 #include <sdbusplus/message/types.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
 #include <filesystem>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <regex>
 #include <span>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 #include <variant>
@@ -71,6 +77,11 @@ bool findFiles(const std::filesystem::path& dirPath,
                std::string_view matchString,
                std::vector<std::filesystem::path>& foundPaths,
                int symlinkDepth = 1);
+// Sysfs discovery paths are resolved against this root. It is empty on a real
+// system; DBUS_SENSORS_SYSFS_ROOT points it at a generated tree, e.g. for
+// the scale test harness.
+const std::string& sysfsRoot();
+std::string sysfsPath(std::string_view path);
 bool isPowerOn();
 bool hasBiosPost();
 bool isChassisOn();
@@ -78,10 +89,6 @@ void setupPowerMatchCallback(
     const std::shared_ptr<sdbusplus::asio::connection>& conn,
     std::function<void(PowerState type, bool state)>&& callback);
 void setupPowerMatch(const std::shared_ptr<sdbusplus::asio::connection>& conn);
-bool getSensorConfiguration(
-    const std::string& type,
-    const std::shared_ptr<sdbusplus::asio::connection>& dbusConnection,
-    ManagedObjectType& resp, bool useCache);
 
 void createAssociation(
     std::shared_ptr<sdbusplus::asio::dbus_interface>& association,
@@ -96,15 +103,11 @@ bool readingStateGood(const PowerState& powerState);
 constexpr const char* configInterfacePrefix =
     "xyz.openbmc_project.Configuration.";
 
-#ifdef NVIDIA_SHMEM
-void updateTelemetry(const std::string& objPath, const std::string& ifaceName,
-                     const char* propertyName, const double& value,
-                     const std::string& parentChassis);
-#endif
-
-inline std::string configInterfaceName(const std::string& type)
+inline std::string configInterfaceName(std::string_view type)
 {
-    return std::string(configInterfacePrefix) + type;
+    std::string name(configInterfacePrefix);
+    name += type;
+    return name;
 }
 
 namespace mapper
@@ -233,6 +236,44 @@ inline float getPollRate(const SensorBaseConfigMap& cfg, float dflt)
     return pollRate;
 }
 
+// How a sensor publishes its Value, read from the optional Publish*
+// properties of its configuration. The defaults keep the historical
+// behaviour: publish every change larger than the sensor's own hysteresis.
+struct PublishPolicy
+{
+    // Smallest change worth publishing, NaN for the sensor's default
+    double deadband = std::numeric_limits<double>::quiet_NaN();
+    // Smallest change as a fraction of the published value, 0 to disable
+    double relativeDeadband = 0.0;
+    // Changes are held back until this long after the previous publish
+    std::chrono::milliseconds minInterval{0};
+    // Value is republished after this long without a publish, 0 to disable
+    std::chrono::milliseconds heartbeat{0};
+};
+
+PublishPolicy getPublishPolicy(const SensorBaseConfigMap& cfg);
+
+// What a sensor last published as its Value property. Decides whether a
+// reading is published under the sensor's PublishPolicy: changes within the
+// deadband are dropped, others wait for minInterval since the previous
+// publish, and the value is republished every heartbeat. Going to or from
+// NaN is always published immediately.
+struct ValuePublisher
+{
+    double published = std::numeric_limits<double>::quiet_NaN();
+    std::chrono::steady_clock::time_point lastPublish;
+
+    // defaultDeadband applies when the policy has none. Returns whether the
+    // reading is to be published, it then counts as published at now.
+    bool update(const PublishPolicy& policy, double defaultDeadband,
+                double reading, std::chrono::steady_clock::time_point now);
+
+    // Whether reading differs from the published value by more than the
+    // deadband
+    bool exceedsDeadband(const PublishPolicy& policy, double defaultDeadband,
+                         double reading) const;
+};
+
 inline void setLed(const std::shared_ptr<sdbusplus::asio::connection>& conn,
                    const std::string& name, bool on)
 {
@@ -254,140 +295,117 @@ void createInventoryAssoc(
     const std::shared_ptr<sdbusplus::asio::dbus_interface>& association,
     const std::string& path);
 
+// Defined with the ConfigurationMirror. Fills resp from the io_context's
+// mirror of the entity-manager configuration, which starts watching the types
+// on first use. Returns false until the mirror has them.
+bool getMirroredConfiguration(
+    const std::shared_ptr<sdbusplus::asio::connection>& conn,
+    std::span<const std::string> types, ManagedObjectType& resp);
+
+// Fetches the entity-manager objects of the given configuration types and
+// passes them to the callback, with all of their interfaces. Once the
+// ConfigurationMirror is in sync it answers from there, until then the
+// objects are found through the mapper and read with one GetAll per
+// interface, at most maxInFlight at a time. The callback runs once, as soon
+// as every read has completed or given up. It is told the configuration is
+// incomplete when the mapper or any GetAll gave up, as objects can then be
+// missing or lack some of their interfaces.
 struct GetSensorConfiguration :
     std::enable_shared_from_this<GetSensorConfiguration>
 {
+    // GetAll calls kept in flight at once
+    static constexpr size_t maxInFlight = 16;
+    // Failed GetAll calls are retried after retryDelay, doubling every
+    // attempt up to maxRetryDelay
+    static constexpr size_t maxAttempts = 6;
+    static constexpr std::chrono::milliseconds retryDelay{500};
+    static constexpr std::chrono::milliseconds maxRetryDelay{16000};
+    // A fetch with a GetAll slower than this is reported
+    static constexpr std::chrono::milliseconds slowRequest{1000};
+
     GetSensorConfiguration(
         std::shared_ptr<sdbusplus::asio::connection> connection,
-        std::function<void(ManagedObjectType& resp)>&& callbackFunc) :
+        std::function<void(ManagedObjectType& resp, bool incomplete)>&&
+            callbackFunc) :
         dbusConnection(std::move(connection)),
         callback(std::move(callbackFunc))
     {}
 
-    void getPath(const std::string& path, const std::string& interface,
-                 const std::string& owner, size_t retries = 5)
-    {
-        if (retries > 5)
-        {
-            retries = 5;
-        }
-        std::shared_ptr<GetSensorConfiguration> self = shared_from_this();
-
-        self->dbusConnection->async_method_call(
-            [self, path, interface, owner, retries](
-                const boost::system::error_code ec, SensorBaseConfigMap& data) {
-            if (ec)
-            {
-                std::cerr << "Error getting " << path << ": retries left"
-                          << retries - 1 << "\n";
-                if (retries == 0U)
-                {
-                    return;
-                }
-                auto timer = std::make_shared<boost::asio::steady_timer>(
-                    self->dbusConnection->get_io_context());
-                timer->expires_after(std::chrono::seconds(10));
-                timer->async_wait([self, timer, path, interface, owner,
-                                   retries](boost::system::error_code ec) {
-                    if (ec)
-                    {
-                        std::cerr << "Timer error!\n";
-                        return;
-                    }
-                    self->getPath(path, interface, owner, retries - 1);
-                });
-                return;
-            }
-
-            self->respData[path][interface] = std::move(data);
-        },
-            owner, path, "org.freedesktop.DBus.Properties", "GetAll",
-            interface);
-    }
-
-    void getConfiguration(const std::vector<std::string>& types,
-                          size_t retries = 0)
-    {
-        if (retries > 5)
-        {
-            retries = 5;
-        }
+    GetSensorConfiguration(
+        std::shared_ptr<sdbusplus::asio::connection> connection,
+        std::function<void(ManagedObjectType& resp)>&& callbackFunc) :
+        dbusConnection(std::move(connection)),
+        callback([callbackFunc{std::move(callbackFunc)}](
+                     ManagedObjectType& resp, bool) { callbackFunc(resp); })
+    {}
 
-        std::vector<std::string> interfaces(types.size());
-        for (const auto& type : types)
-        {
-            interfaces.push_back(configInterfaceName(type));
-        }
+    GetSensorConfiguration(const GetSensorConfiguration&) = delete;
+    GetSensorConfiguration(GetSensorConfiguration&&) = delete;
+    GetSensorConfiguration& operator=(const GetSensorConfiguration&) = delete;
+    GetSensorConfiguration& operator=(GetSensorConfiguration&&) = delete;
 
-        std::shared_ptr<GetSensorConfiguration> self = shared_from_this();
-        dbusConnection->async_method_call(
-            [self, interfaces, retries](const boost::system::error_code ec,
-                                        const GetSubTreeType& ret) {
-            if (ec)
-            {
-                std::cerr << "Error calling mapper\n";
-                if (retries == 0U)
-                {
-                    return;
-                }
-                auto timer = std::make_shared<boost::asio::steady_timer>(
-                    self->dbusConnection->get_io_context());
-                timer->expires_after(std::chrono::seconds(10));
-                timer->async_wait([self, timer, interfaces,
-                                   retries](boost::system::error_code ec) {
-                    if (ec)
-                    {
-                        std::cerr << "Timer error!\n";
-                        return;
-                    }
-                    self->getConfiguration(interfaces, retries - 1);
-                });
-
-                return;
-            }
-            for (const auto& [path, objDict] : ret)
-            {
-                if (objDict.empty())
-                {
-                    return;
-                }
-                const std::string& owner = objDict.begin()->first;
-
-                for (const std::string& interface : objDict.begin()->second)
-                {
-                    // anything that starts with a requested configuration
-                    // is good
-                    if (std::find_if(interfaces.begin(), interfaces.end(),
-                                     [interface](const std::string& possible) {
-                        return interface.starts_with(possible);
-                    }) == interfaces.end())
-                    {
-                        continue;
-                    }
-                    self->getPath(path, interface, owner);
-                }
-            }
-        },
-            mapper::busName, mapper::path, mapper::interface, mapper::subtree,
-            "/", 0, interfaces);
-    }
+    // retries is the number of times a failed mapper call is repeated
+    void getConfiguration(const std::vector<std::string>& types,
+                          size_t retries = 0);
 
-    ~GetSensorConfiguration()
-    {
-        callback(respData);
-    }
+    ~GetSensorConfiguration();
 
     std::shared_ptr<sdbusplus::asio::connection> dbusConnection;
-    std::function<void(ManagedObjectType& resp)> callback;
+    std::function<void(ManagedObjectType& resp, bool incomplete)> callback;
     ManagedObjectType respData;
+
+  private:
+    struct Request
+    {
+        std::string path;
+        std::string interface;
+        std::string owner;
+        size_t attempt = 0;
+    };
+
+    void getSubTree(const std::vector<std::string>& interfaces, size_t retries,
+                    size_t attempt);
+    void fetchNext();
+    void fetch(Request&& request);
+    void requestDone();
+    void complete();
+
+    std::deque<Request> queued;
+    size_t inFlight = 0;
+    // Requests waiting out their retry delay
+    size_t delayed = 0;
+    bool subTreeDone = false;
+    // The mapper or a GetAll gave up
+    bool incomplete = false;
+    bool completed = false;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::duration slowest{};
 };
 
+// Delay before the given retry, doubling from base up to cap
+inline std::chrono::milliseconds backoffDelay(size_t attempt,
+                                              std::chrono::milliseconds base,
+                                              std::chrono::milliseconds cap)
+{
+    std::chrono::milliseconds delay = base;
+    for (size_t ii = 1; ii < attempt && delay < cap; ii++)
+    {
+        delay *= 2;
+    }
+    return std::min(delay, cap);
+}
+
 // The common scheme for sysfs files naming is: <type><number>_<item>.
 // This function returns optionally these 3 elements as a tuple.
 std::optional<std::tuple<std::string, std::string, std::string>>
     splitFileName(const std::filesystem::path& filePath);
 std::optional<double> readFile(const std::string& thresholdFile,
                                const double& scaleFactor);
+// Replaces file with contents unless it holds them already, sparing the
+// flash a write. They are written aside and renamed over the file, so a
+// reader never sees half of it. False, logged, if that failed.
+bool replaceFileIfChanged(const std::filesystem::path& file,
+                          const std::string& contents);
 void setupManufacturingModeMatch(sdbusplus::asio::connection& conn);
 bool getManufacturingMode();
 std::vector<std::unique_ptr<sdbusplus::bus::match_t>>
@@ -424,6 +442,31 @@ bool getDeviceBusAddr(const std::string& deviceName, T& bus, T& addr)
     return true;
 }
 
+// Destroys the active sensors reading files below directory, the hwmon or
+// iio directory of a device that went away, returns how many were.
+// Deactivated sensors are kept, as their device was removed along with them.
+template <typename SensorMap>
+size_t removeDeviceSensors(SensorMap& sensors, const std::string& directory)
+{
+    size_t count = 0;
+    auto sensorIt = sensors.begin();
+    while (sensorIt != sensors.end())
+    {
+        const auto& sensor = sensorIt->second;
+        if (sensor != nullptr && sensor->isActive() &&
+            sensor->getPath().starts_with(directory + "/"))
+        {
+            sensorIt = sensors.erase(sensorIt);
+            ++count;
+        }
+        else
+        {
+            sensorIt++;
+        }
+    }
+    return count;
+}
+
 void addEventLog(const std::shared_ptr<sdbusplus::asio::connection>& conn,
                  const std::string& messageId, const std::string& severity,
                  std::map<std::string, std::string>& addData);
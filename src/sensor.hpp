@@ -2,6 +2,9 @@
 
 #include "dbus-sensor_config.h"
 
+#include "AdaptivePoll.hpp"
+#include "PropertyBatcher.hpp"
+#include "SensorInstrumentation.hpp"
 #include "SensorPaths.hpp"
 #include "Thresholds.hpp"
 #include "Utils.hpp"
@@ -11,18 +14,18 @@
 #include <sdbusplus/exception.hpp>
 #include <tal.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 constexpr size_t sensorFailedPollTimeMs = 5000;
 
-// Enable useful logging with sensor instrumentation
-// This is intentionally not DEBUG, avoid clash with usage in .cpp files
-constexpr bool enableInstrumentation = false;
-
 constexpr const char* sensorValueInterface = "xyz.openbmc_project.Sensor.Value";
 constexpr const char* valueMutabilityInterfaceName =
     "xyz.openbmc_project.Sensor.ValueMutability";
@@ -32,17 +35,6 @@ constexpr const char* operationalInterfaceName =
     "xyz.openbmc_project.State.Decorator.OperationalStatus";
 constexpr const size_t errorThreshold = 5;
 
-struct SensorInstrumentation
-{
-    // These are for instrumentation for debugging
-    int numCollectsGood = 0;
-    int numCollectsMiss = 0;
-    int numStreakGreats = 0;
-    int numStreakMisses = 0;
-    double minCollected = 0.0;
-    double maxCollected = 0.0;
-};
-
 struct SetSensorError : sdbusplus::exception_t
 {
     const char* name() const noexcept override
@@ -74,10 +66,7 @@ struct Sensor
         minValue(min), thresholds(std::move(thresholdData)),
         hysteresisTrigger((max - min) * 0.01),
         hysteresisPublish((max - min) * 0.0001), dbusConnection(conn),
-        readState(readState),
-        instrumentation(enableInstrumentation
-                            ? std::make_unique<SensorInstrumentation>()
-                            : nullptr)
+        propertyChanges(conn), readState(readState)
     {}
     virtual ~Sensor() = default;
     virtual void checkThresholds() = 0;
@@ -100,16 +89,32 @@ struct Sensor
     std::shared_ptr<sdbusplus::asio::dbus_interface> availableInterface;
     std::shared_ptr<sdbusplus::asio::dbus_interface> operationalInterface;
     std::shared_ptr<sdbusplus::asio::dbus_interface> valueMutabilityInterface;
+    // Latest reading, what thresholds are checked against
     double value = std::numeric_limits<double>::quiet_NaN();
     double rawValue = std::numeric_limits<double>::quiet_NaN();
     bool overriddenState = false;
-    bool internalSet = false;
+    bool functional = true;
+    bool available = true;
     double hysteresisTrigger;
     double hysteresisPublish;
+    // Assigned by the owning daemon from getPublishPolicy()
+    PublishPolicy publishPolicy;
+    // Reading last sent out as the Value property
+    ValuePublisher valuePublisher;
+    // Set by the owning daemon from getAdaptivePoll(), see nextPollMs()
+    std::optional<AdaptivePoll> adaptivePoll;
     std::shared_ptr<sdbusplus::asio::connection> dbusConnection;
+    // Value, Functional, Available and the alarms are published through here
+    // so that a reading results in one PropertiesChanged per interface.
+    PropertyChangeSet propertyChanges;
     PowerState readState;
     size_t errCount{0};
+    // Only allocated while instrumentation is enabled, see
+    // activeInstrumentation()
     std::unique_ptr<SensorInstrumentation> instrumentation;
+#ifdef NVIDIA_SHMEM
+    TelemetryHandle telemetry;
+#endif
 
     // This member variable provides a hook that can be used to receive
     // notification whenever this Sensor's value is externally set via D-Bus.
@@ -123,6 +128,8 @@ struct Sensor
     std::array<std::shared_ptr<sdbusplus::asio::dbus_interface>,
                thresholds::thresProp.size()>
         thresholdInterfaces;
+    // Asserted alarms, one thresholds::alarmBit() per (level, direction)
+    uint16_t thresholdAlarms = 0;
 
     std::shared_ptr<sdbusplus::asio::dbus_interface>
         getThresholdInterface(Level lev)
@@ -138,117 +145,75 @@ struct Sensor
         return interface;
     }
 
-    void updateInstrumentation(double readValue) const
+    // Sensors that time their reads call this right before submitting one
+    void markReadStarted()
     {
-        // Do nothing if this feature is not enabled
-        if constexpr (!enableInstrumentation)
+        if (SensorInstrumentation* stats = activeInstrumentation())
         {
-            return;
+            stats->readStarted();
         }
-        if (!instrumentation)
+    }
+
+    void updateInstrumentation(double readValue)
+    {
+        if (SensorInstrumentation* stats = activeInstrumentation())
         {
-            return;
+            stats->readCompleted(readValue);
         }
+    }
 
-        // Save some typing
-        auto& inst = *instrumentation;
-
-        // Show constants if first reading (even if unsuccessful)
-        if ((inst.numCollectsGood == 0) && (inst.numCollectsMiss == 0))
+    // Allocates the instrumentation and its interface once the process-wide
+    // switch is turned on, and drops both when it is turned off again
+    SensorInstrumentation* activeInstrumentation()
+    {
+        if (!sensorInstrumentationEnabled())
         {
-            std::cerr << "Sensor " << name << ": Configuration min=" << minValue
-                      << ", max=" << maxValue << ", type=" << configInterface
-                      << ", path=" << configurationPath << "\n";
+            instrumentation.reset();
+            return nullptr;
         }
-
-        // Sensors can use "nan" to indicate unavailable reading
-        if (!std::isfinite(readValue))
+        if (!instrumentation)
         {
-            // Only show this if beginning a new streak
-            if (inst.numStreakMisses == 0)
+            instrumentation = std::make_unique<SensorInstrumentation>();
+            if (sensorInterface)
             {
-                std::cerr << "Sensor " << name
-                          << ": Missing reading, Reading counts good="
-                          << inst.numCollectsGood
-                          << ", miss=" << inst.numCollectsMiss
-                          << ", Prior good streak=" << inst.numStreakGreats
-                          << "\n";
+                instrumentation->registerInterface(
+                    dbusConnection, sensorInterface->get_object_path());
             }
-
-            inst.numStreakGreats = 0;
-            ++(inst.numCollectsMiss);
-            ++(inst.numStreakMisses);
-
-            return;
-        }
-
-        // Only show this if beginning a new streak and not the first time
-        if ((inst.numStreakGreats == 0) && (inst.numCollectsGood != 0))
-        {
-            std::cerr << "Sensor " << name
-                      << ": Recovered reading, Reading counts good="
-                      << inst.numCollectsGood
-                      << ", miss=" << inst.numCollectsMiss
-                      << ", Prior miss streak=" << inst.numStreakMisses << "\n";
-        }
-
-        // Initialize min/max if the first successful reading
-        if (inst.numCollectsGood == 0)
-        {
-            std::cerr << "Sensor " << name << ": First reading=" << readValue
-                      << "\n";
-
-            inst.minCollected = readValue;
-            inst.maxCollected = readValue;
-        }
-
-        inst.numStreakMisses = 0;
-        ++(inst.numCollectsGood);
-        ++(inst.numStreakGreats);
-
-        // Only provide subsequent output if new min/max established
-        if (readValue < inst.minCollected)
-        {
-            std::cerr << "Sensor " << name << ": Lowest reading=" << readValue
-                      << "\n";
-
-            inst.minCollected = readValue;
         }
+        return instrumentation.get();
+    }
 
-        if (readValue > inst.maxCollected)
+    // Polled sensors wait this long before their next read, nominalMs being
+    // their configured PollRate
+    unsigned int nextPollMs(unsigned int nominalMs)
+    {
+        if (!adaptivePoll)
         {
-            std::cerr << "Sensor " << name << ": Highest reading=" << readValue
-                      << "\n";
-
-            inst.maxCollected = readValue;
+            return nominalMs;
         }
+        return static_cast<unsigned int>(
+            adaptivePoll->next(value, thresholds, hysteresisTrigger).count());
     }
 
     int setSensorValue(const double& newValue, double& oldValue)
     {
-        if (!internalSet)
+        if (insecureSensorOverride == 0 && !isSensorSettable &&
+            !getManufacturingMode())
         {
-            if (insecureSensorOverride == 0 && !isSensorSettable &&
-                !getManufacturingMode())
-            {
-                throw SetSensorError();
-            }
+            throw SetSensorError();
+        }
 
-            oldValue = newValue;
-            overriddenState = true;
-            // check thresholds for external set
-            value = newValue;
-            checkThresholds();
+        oldValue = newValue;
+        overriddenState = true;
+        // check thresholds for external set
+        value = newValue;
+        valuePublisher.published = newValue;
+        checkThresholds();
 
-            // Trigger the hook, as an external set has just happened
-            if (externalSetHook)
-            {
-                externalSetHook();
-            }
-        }
-        else if (!overriddenState)
+        // Trigger the hook, as an external set has just happened
+        if (externalSetHook)
         {
-            oldValue = newValue;
+            externalSetHook();
         }
         return 1;
     }
@@ -265,15 +230,19 @@ struct Sensor
 
         createAssociation(association, configurationPath);
 
+#ifdef NVIDIA_SHMEM
+        bindTelemetry();
+#endif
+
         sensorInterface->register_property("Unit", unit);
         sensorInterface->register_property("MaxValue", maxValue);
         sensorInterface->register_property("MinValue", minValue);
         sensorInterface->register_property(
             "Value", value, [this](const double& newValue, double& oldValue) {
             return setSensorValue(newValue, oldValue);
-        });
+        }, [this](const double&) { return valuePublisher.published; });
 
-        fillMissingThresholds();
+        fillMissingThresholds(thresholds);
 
         for (auto& threshold : thresholds)
         {
@@ -291,10 +260,10 @@ struct Sensor
                 continue;
             }
 
-            std::string level = propertyLevel(threshold.level,
-                                              threshold.direction);
-            std::string alarm = propertyAlarm(threshold.level,
-                                              threshold.direction);
+            const std::string& level = propertyLevel(threshold.level,
+                                                     threshold.direction);
+            const std::string& alarm = propertyAlarm(threshold.level,
+                                                     threshold.direction);
 
             if ((level.empty()) || (alarm.empty()))
             {
@@ -321,7 +290,13 @@ struct Sensor
                 // poweron, etc., before raising any event.
                 return 1;
             });
-            iface->register_property(alarm, false);
+            uint16_t bit = thresholds::alarmBit(threshold.level,
+                                                threshold.direction);
+            iface->register_property_r<bool>(
+                alarm, false, sdbusplus::vtable::property_::emits_change,
+                [this, bit](const bool&) {
+                return (thresholdAlarms & bit) != 0;
+            });
         }
         if (!sensorInterface->initialize())
         {
@@ -339,6 +314,12 @@ struct Sensor
             }
         }
 
+        if (SensorInstrumentation* stats = activeInstrumentation())
+        {
+            stats->registerInterface(dbusConnection,
+                                     sensorInterface->get_object_path());
+        }
+
         if (isValueMutable)
         {
             valueMutabilityInterface =
@@ -361,18 +342,20 @@ struct Sensor
                     dbusConnection, sensorInterface->get_object_path(),
                     availableInterfaceName);
             availableInterface->register_property(
-                "Available", true, [this](const bool propIn, bool& old) {
-                if (propIn == old)
+                "Available", available,
+                [this](const bool propIn, bool& old) {
+                if (propIn == available)
                 {
                     return 1;
                 }
                 old = propIn;
+                available = propIn;
                 if (!propIn)
                 {
                     updateValue(std::numeric_limits<double>::quiet_NaN());
                 }
                 return 1;
-            });
+            }, [this](const bool&) { return available; });
             availableInterface->initialize();
         }
         if (!operationalInterface)
@@ -381,49 +364,80 @@ struct Sensor
                 std::make_shared<sdbusplus::asio::dbus_interface>(
                     dbusConnection, sensorInterface->get_object_path(),
                     operationalInterfaceName);
-            operationalInterface->register_property("Functional", true);
+            operationalInterface->register_property_r<bool>(
+                "Functional", functional,
+                sdbusplus::vtable::property_::emits_change,
+                [this](const bool&) { return functional; });
             operationalInterface->initialize();
         }
     }
 
-    static std::string propertyLevel(const Level lev, const Direction dir)
+    // Takes a new MaxValue and MinValue, and the hysteresis that follows
+    // from them, for a configuration that changed in place
+    void updateRange(double max, double min)
     {
-        for (const thresholds::ThresholdDefinition& prop :
-             thresholds::thresProp)
-        {
-            if (prop.level == lev)
-            {
-                if (dir == Direction::HIGH)
-                {
-                    return std::string(prop.levelName) + "High";
-                }
-                if (dir == Direction::LOW)
-                {
-                    return std::string(prop.levelName) + "Low";
-                }
-            }
-        }
-        return "";
+        hysteresisTrigger = (max - min) * 0.01;
+        hysteresisPublish = (max - min) * 0.0001;
+        updateProperty(sensorInterface, maxValue, max, "MaxValue");
+        updateProperty(sensorInterface, minValue, min, "MinValue");
     }
 
-    static std::string propertyAlarm(const Level lev, const Direction dir)
+    // Takes the thresholds of a configuration that changed in place, see
+    // ConfigReconciler::canUpdate(). Their properties are updated on the
+    // existing interfaces; if they are not for the same levels and
+    // directions as before, nothing is changed and false is returned, as
+    // the interfaces would have to change and with them the sensor rebuilt.
+    bool updateThresholds(std::vector<thresholds::Threshold>&& newThresholds)
     {
-        for (const thresholds::ThresholdDefinition& prop :
-             thresholds::thresProp)
+        fillMissingThresholds(newThresholds);
+        if (newThresholds.size() != thresholds.size())
+        {
+            return false;
+        }
+        // The property callbacks refer to the thresholds they were
+        // registered for, so those are updated rather than replaced
+        std::vector<thresholds::Threshold*> targets;
+        targets.reserve(newThresholds.size());
+        for (const thresholds::Threshold& newThreshold : newThresholds)
         {
-            if (prop.level == lev)
+            auto found = std::ranges::find_if(
+                thresholds, [&newThreshold](const auto& threshold) {
+                return threshold.level == newThreshold.level &&
+                       threshold.direction == newThreshold.direction;
+            });
+            if (found == thresholds.end())
             {
-                if (dir == Direction::HIGH)
-                {
-                    return std::string(prop.levelName) + "AlarmHigh";
-                }
-                if (dir == Direction::LOW)
-                {
-                    return std::string(prop.levelName) + "AlarmLow";
-                }
+                return false;
             }
+            targets.push_back(&*found);
+        }
+
+        for (size_t index = 0; index < targets.size(); index++)
+        {
+            const thresholds::Threshold& newThreshold = newThresholds[index];
+            targets[index]->value = newThreshold.value;
+            targets[index]->hysteresis = std::isnan(newThreshold.hysteresis)
+                                             ? hysteresisTrigger
+                                             : newThreshold.hysteresis;
         }
-        return "";
+        // Only the levels that changed are signalled
+        thresholds::updateThresholds(this);
+        // As after a threshold set through D-Bus, have the next reading
+        // checked against the new thresholds even if it does not change
+        value = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+
+    static const std::string& propertyLevel(const Level lev,
+                                            const Direction dir)
+    {
+        return thresholds::levelPropertyName(lev, dir);
+    }
+
+    static const std::string& propertyAlarm(const Level lev,
+                                            const Direction dir)
+    {
+        return thresholds::alarmPropertyName(lev, dir);
     }
 
     bool readingStateGood() const
@@ -433,9 +447,10 @@ struct Sensor
 
     void markFunctional(bool isFunctional)
     {
-        if (operationalInterface)
+        if (functional != isFunctional)
         {
-            operationalInterface->set_property("Functional", isFunctional);
+            functional = isFunctional;
+            propertyChanges.mark(operationalInterface, "Functional");
         }
         if (isFunctional)
         {
@@ -451,13 +466,19 @@ struct Sensor
     {
         if (availableInterface)
         {
-            availableInterface->set_property("Available", isAvailable);
+            if (available != isAvailable)
+            {
+                available = isAvailable;
+                propertyChanges.mark(availableInterface, "Available");
+            }
             errCount = 0;
         }
     }
 
     void incrementError()
     {
+        updateInstrumentation(std::numeric_limits<double>::quiet_NaN());
+
         if (!readingStateGood())
         {
             markAvailable(false);
@@ -523,12 +544,11 @@ struct Sensor
         updateValueOnly(newValue);
 
 #ifdef NVIDIA_SHMEM
-        std::string objPath = sensorInterface->get_object_path();
-        std::string ifaceName = sensorInterface->get_interface_name();
-        std::string parentChassis =
-            sdbusplus::message::object_path(configurationPath).parent_path();
-
-        updateTelemetry(objPath, ifaceName, "Value", newValue, parentChassis);
+        if (!telemetry.isBound())
+        {
+            bindTelemetry();
+        }
+        telemetry.update("Value", newValue);
 #endif
     }
 
@@ -561,22 +581,32 @@ struct Sensor
     }
 
   private:
+#ifdef NVIDIA_SHMEM
+    void bindTelemetry()
+    {
+        telemetry.bind(sensorInterface->get_object_path(),
+                       sensorInterface->get_interface_name(),
+                       configurationPath);
+    }
+#endif
+
     // If one of the thresholds for a dbus interface is provided
     // we have to set the other one as dbus properties are never
     // optional.
-    void fillMissingThresholds()
+    static void fillMissingThresholds(
+        std::vector<thresholds::Threshold>& thresholdData)
     {
-        const std::size_t thresholdsLen = thresholds.size();
+        const std::size_t thresholdsLen = thresholdData.size();
         for (std::size_t index = 0; index < thresholdsLen; ++index)
         {
-            const thresholds::Threshold& thisThreshold = thresholds[index];
+            const thresholds::Threshold& thisThreshold = thresholdData[index];
             bool foundOpposite = false;
             thresholds::Direction opposite = thresholds::Direction::HIGH;
             if (thisThreshold.direction == thresholds::Direction::HIGH)
             {
                 opposite = thresholds::Direction::LOW;
             }
-            for (thresholds::Threshold& otherThreshold : thresholds)
+            for (thresholds::Threshold& otherThreshold : thresholdData)
             {
                 if (thisThreshold.level != otherThreshold.level)
                 {
@@ -593,16 +623,29 @@ struct Sensor
             {
                 continue;
             }
-            thresholds.emplace_back(thisThreshold.level, opposite,
-                                    std::numeric_limits<double>::quiet_NaN());
+            thresholdData.emplace_back(
+                thisThreshold.level, opposite,
+                std::numeric_limits<double>::quiet_NaN());
         }
     }
 
+    // Applies publishPolicy, see ValuePublisher
     void updateValueProperty(const double& newValue)
     {
-        // Indicate that it is internal set call, not an external overwrite
-        internalSet = true;
-        updateProperty(sensorInterface, value, newValue, "Value");
-        internalSet = false;
+        value = newValue;
+        if (!valuePublisher.update(publishPolicy, hysteresisPublish, newValue,
+                                   std::chrono::steady_clock::now()))
+        {
+            SensorInstrumentation* stats = activeInstrumentation();
+            if (stats != nullptr && !std::isnan(newValue))
+            {
+                stats->updateSuppressed();
+            }
+            return;
+        }
+
+        // Value is read back through its getter, so the set_property() of
+        // updateProperty() is not needed, only the change notification.
+        propertyChanges.mark(sensorInterface, "Value");
     }
 };
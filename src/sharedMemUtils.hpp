@@ -26,3 +26,30 @@ using DbusVariantType = std::variant<
     std::vector<std::tuple<uint8_t, std::string>>, std::tuple<size_t, bool>,
     std::tuple<bool, uint32_t>, std::map<std::string, uint64_t>,
     std::tuple<std::string, std::string, std::string, uint64_t>>;
+
+#ifdef NVIDIA_SHMEM
+// Shared-memory publishing slot of one sensor property. The object path,
+// interface and parent chassis are resolved once in bind(), so publishing a
+// reading afterwards does not allocate.
+class TelemetryHandle
+{
+  public:
+    bool isBound() const
+    {
+        return !objPath.empty();
+    }
+
+    void bind(const std::string& objectPath, const std::string& interfaceName,
+              const std::string& configurationPath);
+    void update(const char* propertyName, double value);
+
+  private:
+    std::string objPath;
+    std::string ifaceName;
+    std::string parentChassis;
+    // Reused between readings; assigning a double to a variant already
+    // holding one does not allocate.
+    DbusVariantType propValue = 0.0;
+    std::vector<uint8_t> rawPropValue;
+};
+#endif
@@ -0,0 +1,151 @@
+#include "PSULabel.hpp"
+
+#include <boost/algorithm/string/replace.hpp>
+
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+constexpr const char* hwmonDir = "/sys/bus/i2c/devices/7-0058/hwmon/hwmon12/";
+
+struct Attribute
+{
+    const char* fileName;
+    // Contents of the matching *_label file, nullptr if there is none
+    const char* label;
+};
+
+// What pmbus_core exposes for a dual output PSU and a two page VR, in the
+// order findFiles() returns the *_input and *_max attributes psusensor
+// creates sensors from.
+constexpr std::array<Attribute, 34> pmbusCorpus{{
+    {"curr1_input", "iin"},      {"curr1_max", "iin"},
+    {"curr2_input", "iout1"},    {"curr2_max", "iout1"},
+    {"curr3_input", "iout2"},    {"curr3_max", "iout2"},
+    {"fan1_input", "fan1"},      {"fan2_input", "fan2"},
+    {"in1_input", "vin"},        {"in1_max", "vin"},
+    {"in2_input", "vout1"},      {"in2_max", "vout1"},
+    {"in3_input", "vout2"},      {"in3_max", "vout2"},
+    {"in4_input", "vcap"},       {"power1_input", "pin"},
+    {"power1_max", "pin"},       {"power2_input", "pout1"},
+    {"power3_input", "pout2"},   {"temp1_input", nullptr},
+    {"temp1_max", nullptr},      {"temp2_input", nullptr},
+    {"temp2_max", nullptr},      {"temp3_input", nullptr},
+    {"curr4_input", "iin"},      {"curr5_input", "iout1"},
+    {"curr6_input", "iout2"},    {"in5_input", "vin"},
+    {"in6_input", "vout1"},      {"in7_input", "vout2"},
+    {"power4_input", "pin"},     {"power5_input", "pout1"},
+    {"power6_input", "pout2"},   {"temp4_input", nullptr},
+}};
+
+// Label head of an attribute as createSensorsCallback() builds it
+std::string labelHeadOf(const Attribute& attribute)
+{
+    std::string_view fileName(attribute.fileName);
+    std::string head;
+    if (attribute.label != nullptr)
+    {
+        std::string_view label(attribute.label);
+        head = label.substr(0, label.find(' '));
+    }
+    else
+    {
+        head = fileName.substr(0, fileName.find('_'));
+    }
+    if (fileName.ends_with("_max"))
+    {
+        head.insert(0, "max");
+    }
+    return head;
+}
+
+// One scan of the corpus the way psusensor did it: a regex per device for the
+// sensor type, a regex per label for its index and string rewriting for the
+// label path and scale factor key.
+void psuLabelRegex(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        std::regex sensorNameRegEx("([A-Za-z]+)[0-9]*_");
+        std::smatch matches;
+        for (const Attribute& attribute : pmbusCorpus)
+        {
+            std::string sensorPathStr =
+                std::string(hwmonDir) + attribute.fileName;
+            std::string sensorNameStr = attribute.fileName;
+            if (!std::regex_search(sensorNameStr, matches, sensorNameRegEx))
+            {
+                continue;
+            }
+            std::string sensorNameSubStr = matches[1];
+            std::string labelPath =
+                sensorNameStr.ends_with("_max")
+                    ? boost::replace_all_copy(sensorPathStr, "max", "label")
+                    : boost::replace_all_copy(sensorPathStr, "input", "label");
+            std::string labelHead = labelHeadOf(attribute);
+
+            std::regex rgx("[A-Za-z]+([0-9]+)");
+            std::string nameIndexStr = "1";
+            if (std::regex_search(labelHead, matches, rgx))
+            {
+                nameIndexStr = matches[1];
+            }
+            char firstChar =
+                static_cast<char>(std::toupper(sensorNameSubStr[0]));
+            std::string strScaleFactor =
+                firstChar + sensorNameSubStr.substr(1) + "ScaleFactor";
+
+            benchmark::DoNotOptimize(labelPath);
+            benchmark::DoNotOptimize(nameIndexStr);
+            benchmark::DoNotOptimize(strScaleFactor);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * pmbusCorpus.size());
+}
+BENCHMARK(psuLabelRegex);
+
+// The same scan through the label engine
+void psuLabelEngine(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        for (const Attribute& attribute : pmbusCorpus)
+        {
+            std::string sensorPathStr =
+                std::string(hwmonDir) + attribute.fileName;
+            std::string_view sensorNameSubStr =
+                psuSensorType(DevTypes::HWMON, attribute.fileName);
+            if (sensorNameSubStr.empty())
+            {
+                continue;
+            }
+            std::string labelPath = psuSiblingAttribute(sensorPathStr,
+                                                        "label");
+            std::string labelHead = labelHeadOf(attribute);
+
+            std::string_view nameIndexStr = psuLabelIndex(labelHead);
+            const PSUPropertyDefaults* defaults =
+                psuPropertyDefaults(sensorNameSubStr);
+            std::string strScaleFactor = psuScaleFactorKey(sensorNameSubStr);
+
+            benchmark::DoNotOptimize(labelPath);
+            benchmark::DoNotOptimize(nameIndexStr);
+            benchmark::DoNotOptimize(defaults);
+            benchmark::DoNotOptimize(strScaleFactor);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * pmbusCorpus.size());
+}
+BENCHMARK(psuLabelEngine);
+
+} // namespace
+
+BENCHMARK_MAIN();
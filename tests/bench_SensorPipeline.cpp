@@ -0,0 +1,401 @@
+#include "HwmonTempSensor.hpp"
+#include "PSUSensor.hpp"
+#include "SensorPaths.hpp"
+#include "Thresholds.hpp"
+#include "sensor.hpp"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-id128.h>
+#include <unistd.h>
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// Counts every heap allocation made by the process, the benchmarks report the
+// difference over their timed loop.
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+
+constexpr const char* benchConfiguration =
+    "/xyz/openbmc_project/inventory/system/board/Bench_Board/Bench";
+
+// A peer-to-peer bus over a socketpair. The sensors get a real
+// sdbusplus::asio::connection, so property registration and signal
+// marshalling are measured, while the other end is a bare sd-bus server in
+// this process that simply drops whatever it receives.
+class BenchBus
+{
+  public:
+    BenchBus()
+    {
+        std::array<int, 2> fds{};
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0,
+                       fds.data()) < 0)
+        {
+            throw std::runtime_error("socketpair failed");
+        }
+
+        sd_id128_t serverId{};
+        sd_id128_randomize(&serverId);
+        sd_bus_new(&server);
+        sd_bus_set_fd(server, fds[1], fds[1]);
+        sd_bus_set_server(server, 1, serverId);
+        sd_bus_start(server);
+
+        sd_bus* client = nullptr;
+        sd_bus_new(&client);
+        sd_bus_set_fd(client, fds[0], fds[0]);
+        sd_bus_start(client);
+        while (sd_bus_is_ready(client) <= 0)
+        {
+            sd_bus_process(server, nullptr);
+            sd_bus_process(client, nullptr);
+        }
+
+        conn = std::make_shared<sdbusplus::asio::connection>(io, client);
+        objectServer = std::make_unique<sdbusplus::asio::object_server>(conn);
+    }
+
+    ~BenchBus()
+    {
+        objectServer.reset();
+        conn.reset();
+        sd_bus_flush_close_unref(server);
+    }
+
+    BenchBus(const BenchBus&) = delete;
+    BenchBus(BenchBus&&) = delete;
+    BenchBus& operator=(const BenchBus&) = delete;
+    BenchBus& operator=(BenchBus&&) = delete;
+
+    // Runs the posted work, e.g. the PropertiesChanged flush, and throws away
+    // everything that reached the other end of the bus.
+    void settle()
+    {
+        io.poll();
+        conn->flush();
+        while (sd_bus_process(server, nullptr) > 0)
+        {}
+    }
+
+    // Runs handlers until done() holds. False if it still does not after
+    // timeout, or once there is nothing left that could make it hold.
+    template <typename Predicate>
+    bool runUntil(Predicate done, std::chrono::milliseconds timeout =
+                                      std::chrono::seconds(1))
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!done())
+        {
+            if (io.run_one_until(deadline) == 0)
+            {
+                io.restart();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    boost::asio::io_context io;
+    std::shared_ptr<sdbusplus::asio::connection> conn;
+    std::unique_ptr<sdbusplus::asio::object_server> objectServer;
+
+  private:
+    sd_bus* server = nullptr;
+};
+
+BenchBus& benchBus()
+{
+    static BenchBus bus;
+    return bus;
+}
+
+// Fake sysfs attribute on tmpfs, rewritten by the benchmark so that every
+// reading differs from the last one and takes the full publish path. Writes
+// go through a raw descriptor so they do not show up as allocations.
+class FakeAttribute
+{
+  public:
+    explicit FakeAttribute(const std::string& name)
+    {
+        std::filesystem::path dir = "/dev/shm";
+        if (!std::filesystem::is_directory(dir))
+        {
+            dir = std::filesystem::temp_directory_path();
+        }
+        path = dir / ("dbus-sensors-bench-" + std::to_string(getpid()) + "-" +
+                      name);
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0)
+        {
+            throw std::runtime_error("cannot create " + path.string());
+        }
+    }
+
+    ~FakeAttribute()
+    {
+        close(fd);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    FakeAttribute(const FakeAttribute&) = delete;
+    FakeAttribute(FakeAttribute&&) = delete;
+    FakeAttribute& operator=(const FakeAttribute&) = delete;
+    FakeAttribute& operator=(FakeAttribute&&) = delete;
+
+    // Every value written by a benchmark has the same length, so the file
+    // never needs truncating.
+    void write(const std::string& content) const
+    {
+        if (pwrite(fd, content.data(), content.size(), 0) !=
+            static_cast<ssize_t>(content.size()))
+        {
+            throw std::runtime_error("cannot write " + path.string());
+        }
+    }
+
+    std::filesystem::path path;
+
+  private:
+    int fd = -1;
+};
+
+std::vector<thresholds::Threshold> benchThresholds()
+{
+    return {
+        {thresholds::Level::WARNING, thresholds::Direction::HIGH, 80.0},
+        {thresholds::Level::WARNING, thresholds::Direction::LOW, 5.0},
+        {thresholds::Level::CRITICAL, thresholds::Direction::HIGH, 95.0},
+        {thresholds::Level::CRITICAL, thresholds::Direction::LOW, 0.0},
+    };
+}
+
+class BenchSensor : public Sensor
+{
+  public:
+    BenchSensor(sdbusplus::asio::object_server& objectServer,
+                std::shared_ptr<sdbusplus::asio::connection>& conn) :
+        Sensor("Bench_Temp", benchThresholds(), benchConfiguration,
+               "xyz.openbmc_project.Configuration.Bench", false, false, 127.0,
+               -128.0, conn),
+        objServer(objectServer)
+    {
+        std::string path = "/xyz/openbmc_project/sensors/temperature/" + name;
+        sensorInterface = objectServer.add_interface(path,
+                                                     sensorValueInterface);
+        for (const auto& threshold : thresholds)
+        {
+            thresholdInterfaces[static_cast<size_t>(threshold.level)] =
+                objectServer.add_interface(
+                    path, thresholds::getInterface(threshold.level));
+        }
+        association = objectServer.add_interface(path, association::interface);
+        setInitialProperties(sensor_paths::unitDegreesC);
+    }
+
+    ~BenchSensor() override
+    {
+        for (const auto& iface : thresholdInterfaces)
+        {
+            objServer.remove_interface(iface);
+        }
+        objServer.remove_interface(sensorInterface);
+        objServer.remove_interface(association);
+    }
+
+    BenchSensor(const BenchSensor&) = delete;
+    BenchSensor(BenchSensor&&) = delete;
+    BenchSensor& operator=(const BenchSensor&) = delete;
+    BenchSensor& operator=(BenchSensor&&) = delete;
+
+    void checkThresholds() override
+    {
+        thresholds::checkThresholds(this);
+    }
+
+  private:
+    sdbusplus::asio::object_server& objServer;
+};
+
+void reportPerReading(benchmark::State& state, size_t allocationsBefore)
+{
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs_per_reading"] = benchmark::Counter(
+        static_cast<double>(allocations - allocationsBefore),
+        benchmark::Counter::kAvgIterations);
+}
+
+// sysfs read -> parse -> Value publish -> threshold check, one reading per
+// iteration. Each reading also pays for rewriting the fake attribute.
+void hwmonTempRead(benchmark::State& state)
+{
+    BenchBus& bus = benchBus();
+    FakeAttribute attribute("temp1_input");
+    SensorParams params{-128.0, 127.0, 0.0, 0.001, sensor_paths::unitDegreesC,
+                        "temperature", "", ""};
+    auto sensor = std::make_shared<HwmonTempSensor>(
+        attribute.path.string(), "xyz.openbmc_project.Configuration.TMP75",
+        *bus.objectServer, bus.conn, bus.io, "Bench Hwmon Temp",
+        benchThresholds(), params, 1.0F, benchConfiguration,
+        PowerState::always, nullptr, "");
+
+    std::array<std::string, 2> contents{"40000\n", "41000\n"};
+    // Same arithmetic as the sensor, so the comparison below is exact
+    std::array<double, 2> expected{40000 * params.scaleValue,
+                                   41000 * params.scaleValue};
+    size_t index = 0;
+
+    size_t allocationsBefore = allocations;
+    for (auto _ : state)
+    {
+        attribute.write(contents[index]);
+        sensor->setupRead();
+        if (!bus.runUntil([&] { return sensor->value == expected[index]; }))
+        {
+            state.SkipWithError("reading was not published within 1 s");
+            break;
+        }
+        bus.settle();
+        index ^= 1;
+    }
+    reportPerReading(state, allocationsBefore);
+    sensor->deactivate();
+    bus.settle();
+}
+BENCHMARK(hwmonTempRead);
+
+void psuRead(benchmark::State& state)
+{
+    BenchBus& bus = benchBus();
+    FakeAttribute attribute("in1_input");
+    auto sensor = std::make_shared<PSUSensor>(
+        attribute.path.string(), "xyz.openbmc_project.Configuration.pmbus",
+        *bus.objectServer, bus.conn, bus.io, "Bench PSU Voltage",
+        benchThresholds(), benchConfiguration, PowerState::always,
+        sensor_paths::unitVolts, 1000, 255.0, 0.0, 0.0, "", 0, 1.0, nullptr);
+
+    std::array<std::string, 2> contents{"12000\n", "12100\n"};
+    std::array<double, 2> expected{12.0, 12.1};
+    size_t index = 0;
+
+    size_t allocationsBefore = allocations;
+    for (auto _ : state)
+    {
+        attribute.write(contents[index]);
+        sensor->setupRead();
+        if (!bus.runUntil([&] { return sensor->value == expected[index]; }))
+        {
+            state.SkipWithError("reading was not published within 1 s");
+            break;
+        }
+        bus.settle();
+        index ^= 1;
+    }
+    reportPerReading(state, allocationsBefore);
+    sensor->deactivate();
+    bus.settle();
+}
+BENCHMARK(psuRead);
+
+// Sensor::updateValue() with a changing value, including the coalesced
+// PropertiesChanged flush.
+void updateValue(benchmark::State& state)
+{
+    BenchBus& bus = benchBus();
+    BenchSensor sensor(*bus.objectServer, bus.conn);
+    std::array<double, 2> readings{40.0, 41.0};
+    size_t index = 0;
+
+    size_t allocationsBefore = allocations;
+    for (auto _ : state)
+    {
+        sensor.updateValue(readings[index]);
+        bus.settle();
+        index ^= 1;
+    }
+    reportPerReading(state, allocationsBefore);
+}
+BENCHMARK(updateValue);
+
+// thresholds::checkThresholds() with the value in the normal band, the
+// common case where no alarm changes.
+void checkThresholdsSteady(benchmark::State& state)
+{
+    BenchBus& bus = benchBus();
+    BenchSensor sensor(*bus.objectServer, bus.conn);
+    sensor.value = 40.0;
+
+    size_t allocationsBefore = allocations;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(thresholds::checkThresholds(&sensor));
+    }
+    reportPerReading(state, allocationsBefore);
+}
+BENCHMARK(checkThresholdsSteady);
+
+// thresholds::checkThresholds() crossing the high warning on every reading,
+// so each one asserts or deasserts an alarm.
+void checkThresholdsTransition(benchmark::State& state)
+{
+    BenchBus& bus = benchBus();
+    BenchSensor sensor(*bus.objectServer, bus.conn);
+    std::array<double, 2> readings{40.0, 85.0};
+    size_t index = 0;
+
+    size_t allocationsBefore = allocations;
+    for (auto _ : state)
+    {
+        sensor.value = readings[index];
+        benchmark::DoNotOptimize(thresholds::checkThresholds(&sensor));
+        bus.settle();
+        index ^= 1;
+    }
+    reportPerReading(state, allocationsBefore);
+}
+BENCHMARK(checkThresholdsTransition);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,464 @@
+// Scale test harness for hwmontempsensor and psusensor discovery.
+//
+// Generates a fake sysfs tree with <count> I2C hwmon devices and the matching
+// entity-manager configuration, starts a private dbus-daemon, serves the
+// configuration on it as entity-manager and the object mapper would, then
+// runs the daemon against both and measures how long it takes until every
+// sensor publishes a reading, along with the daemon's RSS at that point.
+//
+//   scale_sensor_discovery <hwmon|psu> <count> <daemon> [timeout-seconds]
+//
+// The daemon is pointed at the tree through DBUS_SENSORS_SYSFS_ROOT and at
+// the bus through DBUS_SYSTEM_BUS_ADDRESS. dbus-daemon must be in PATH.
+
+#include "Utils.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <systemd/sd-bus.h>
+#include <unistd.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+constexpr const char* entityManagerBusName = "xyz.openbmc_project.EntityManager";
+constexpr const char* boardPath =
+    "/xyz/openbmc_project/inventory/system/board/Scale_Board";
+constexpr auto pollInterval = std::chrono::milliseconds(100);
+
+struct DaemonKind
+{
+    const char* busName;
+    const char* configType;
+    const char* driverName;
+    const char* namePrefix;
+};
+
+constexpr DaemonKind hwmonKind{"xyz.openbmc_project.HwmonTempSensor", "TMP75",
+                               "tmp75", "Scale_Temp_"};
+constexpr DaemonKind psuKind{"xyz.openbmc_project.PSUSensor", "pmbus",
+                             "pmbus", "Scale_PSU_"};
+
+struct FakeDevice
+{
+    uint64_t bus;
+    uint64_t address;
+    std::string name;
+    std::string configPath;
+};
+
+void writeFile(const fs::path& path, const std::string& content)
+{
+    std::ofstream file(path);
+    file << content;
+    if (!file)
+    {
+        throw std::runtime_error("cannot write " + path.string());
+    }
+}
+
+// Every device is a static (of_node) I2C client with one hwmon directory,
+// so the daemons find them present and never try to instantiate them.
+std::vector<FakeDevice> generateTree(const fs::path& root,
+                                     const DaemonKind& kind, size_t count)
+{
+    std::vector<FakeDevice> devices;
+    devices.reserve(count);
+    for (size_t ii = 0; ii < count; ii++)
+    {
+        FakeDevice device{1 + (ii / 100), 0x10 + (ii % 100),
+                          kind.namePrefix + std::to_string(ii),
+                          std::string(boardPath) + "/Sensor_" +
+                              std::to_string(ii)};
+
+        std::ostringstream clientName;
+        clientName << device.bus << "-" << std::hex << std::setw(4)
+                   << std::setfill('0') << device.address;
+        fs::path client = root / "sys/bus/i2c/devices" /
+                          ("i2c-" + std::to_string(device.bus)) /
+                          clientName.str();
+        fs::create_directories(client / "hwmon");
+        writeFile(client / "of_node", "");
+
+        fs::path hwmon = root / "sys/class/hwmon" /
+                         ("hwmon" + std::to_string(ii));
+        fs::create_directories(hwmon);
+        fs::create_directory_symlink(client, hwmon / "device");
+        writeFile(hwmon / "name", std::string(kind.driverName) + "\n");
+        if (&kind == &psuKind)
+        {
+            writeFile(hwmon / "in1_input", "12000\n");
+            writeFile(hwmon / "in1_label", "vout1\n");
+        }
+        else
+        {
+            writeFile(hwmon / "temp1_input", "25000\n");
+        }
+
+        devices.emplace_back(std::move(device));
+    }
+    return devices;
+}
+
+pid_t spawn(const std::vector<std::string>& args,
+            const std::vector<std::string>& extraEnv, int stdoutFd,
+            const std::string& logPath)
+{
+    std::vector<char*> argv;
+    for (const std::string& arg : args)
+    {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    std::vector<char*> envp;
+    for (char** env = environ; *env != nullptr; env++)
+    {
+        envp.push_back(*env);
+    }
+    for (const std::string& env : extraEnv)
+    {
+        envp.push_back(const_cast<char*>(env.c_str()));
+    }
+    envp.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (stdoutFd >= 0)
+    {
+        posix_spawn_file_actions_adddup2(&actions, stdoutFd, STDOUT_FILENO);
+    }
+    if (!logPath.empty())
+    {
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO,
+                                         logPath.c_str(),
+                                         O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    pid_t pid = 0;
+    int ret = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(),
+                           envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    if (ret != 0)
+    {
+        throw std::runtime_error("cannot start " + args[0] + ": " +
+                                 std::strerror(ret));
+    }
+    return pid;
+}
+
+void stop(pid_t pid)
+{
+    if (pid > 0)
+    {
+        kill(pid, SIGTERM);
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+// Starts a private bus and returns its address.
+std::string startBus(pid_t& busPid)
+{
+    std::array<int, 2> pipeFds{};
+    if (pipe(pipeFds.data()) != 0)
+    {
+        throw std::runtime_error("pipe failed");
+    }
+    busPid = spawn({"dbus-daemon", "--session", "--nofork", "--print-address"},
+                   {}, pipeFds[1], "");
+    close(pipeFds[1]);
+
+    std::string address;
+    std::array<char, 256> buf{};
+    ssize_t len = 0;
+    while ((len = read(pipeFds[0], buf.data(), buf.size())) > 0)
+    {
+        address.append(buf.data(), static_cast<size_t>(len));
+        if (address.find('\n') != std::string::npos)
+        {
+            break;
+        }
+    }
+    close(pipeFds[0]);
+    address = address.substr(0, address.find('\n'));
+    if (address.empty())
+    {
+        throw std::runtime_error("dbus-daemon did not report its address");
+    }
+    return address;
+}
+
+std::shared_ptr<sdbusplus::asio::connection>
+    connectBus(boost::asio::io_context& io, const std::string& address)
+{
+    sd_bus* bus = nullptr;
+    sd_bus_new(&bus);
+    sd_bus_set_address(bus, address.c_str());
+    sd_bus_set_bus_client(bus, 1);
+    if (sd_bus_start(bus) < 0)
+    {
+        throw std::runtime_error("cannot connect to " + address);
+    }
+    return std::make_shared<sdbusplus::asio::connection>(io, bus);
+}
+
+// Serves the generated configuration the way entity-manager and the object
+// mapper present it to GetSensorConfiguration.
+class FakeEntityManager
+{
+  public:
+    FakeEntityManager(std::shared_ptr<sdbusplus::asio::connection>& conn,
+                      const DaemonKind& kind,
+                      const std::vector<FakeDevice>& devices) :
+        objectServer(conn, true)
+    {
+        std::string interface = configInterfaceName(kind.configType);
+        for (const FakeDevice& device : devices)
+        {
+            auto iface = objectServer.add_interface(device.configPath,
+                                                    interface);
+            iface->register_property("Name", device.name);
+            iface->register_property("Type", std::string(kind.configType));
+            iface->register_property("Bus", device.bus);
+            iface->register_property("Address", device.address);
+            iface->initialize();
+            interfaces.emplace_back(std::move(iface));
+            subtree.emplace_back(
+                device.configPath,
+                std::vector<std::pair<std::string, std::vector<std::string>>>{
+                    {entityManagerBusName, {interface}}});
+        }
+
+        mapperInterface = objectServer.add_interface(mapper::path,
+                                                     mapper::interface);
+        mapperInterface->register_method(
+            mapper::subtree,
+            [this](const std::string& /*path*/, int32_t /*depth*/,
+                   const std::vector<std::string>& /*interfaces*/) {
+            return subtree;
+        });
+        mapperInterface->initialize();
+
+        conn->request_name(entityManagerBusName);
+        conn->request_name(mapper::busName);
+    }
+
+  private:
+    sdbusplus::asio::object_server objectServer;
+    std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> interfaces;
+    std::shared_ptr<sdbusplus::asio::dbus_interface> mapperInterface;
+    GetSubTreeType subtree;
+};
+
+// Counts the objects under /xyz/openbmc_project/sensors whose Sensor.Value
+// holds a reading. Parsed with the raw sd-bus API so that the daemon's other
+// interfaces, whatever their property types, are simply skipped.
+size_t countPublished(sd_bus_message* reply)
+{
+    size_t published = 0;
+    sd_bus_message_enter_container(reply, 'a', "{oa{sa{sv}}}");
+    while (sd_bus_message_enter_container(reply, 'e', "oa{sa{sv}}") > 0)
+    {
+        const char* path = nullptr;
+        sd_bus_message_read_basic(reply, 'o', &path);
+        sd_bus_message_enter_container(reply, 'a', "{sa{sv}}");
+        while (sd_bus_message_enter_container(reply, 'e', "sa{sv}") > 0)
+        {
+            const char* interface = nullptr;
+            sd_bus_message_read_basic(reply, 's', &interface);
+            bool isValue = std::strcmp(interface,
+                                       "xyz.openbmc_project.Sensor.Value") == 0;
+            sd_bus_message_enter_container(reply, 'a', "{sv}");
+            while (sd_bus_message_enter_container(reply, 'e', "sv") > 0)
+            {
+                const char* property = nullptr;
+                sd_bus_message_read_basic(reply, 's', &property);
+                double value = NAN;
+                if (isValue && std::strcmp(property, "Value") == 0 &&
+                    sd_bus_message_enter_container(reply, 'v', "d") > 0)
+                {
+                    sd_bus_message_read_basic(reply, 'd', &value);
+                    sd_bus_message_exit_container(reply);
+                    if (std::isfinite(value))
+                    {
+                        published++;
+                    }
+                }
+                else
+                {
+                    sd_bus_message_skip(reply, "v");
+                }
+                sd_bus_message_exit_container(reply);
+            }
+            sd_bus_message_exit_container(reply);
+            sd_bus_message_exit_container(reply);
+        }
+        sd_bus_message_exit_container(reply);
+        sd_bus_message_exit_container(reply);
+    }
+    sd_bus_message_exit_container(reply);
+    return published;
+}
+
+std::optional<uint64_t> readStatusKb(pid_t pid, const std::string& field)
+{
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.starts_with(field + ":"))
+        {
+            return std::stoull(line.substr(field.size() + 1));
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "usage: " << argv[0]
+                  << " <hwmon|psu> <count> <daemon> [timeout-seconds]\n";
+        return 2;
+    }
+    std::string kindName = argv[1];
+    const DaemonKind& kind = kindName == "psu" ? psuKind : hwmonKind;
+    size_t count = std::stoul(argv[2]);
+    std::string daemon = argv[3];
+    auto timeout = std::chrono::seconds(argc > 4 ? std::stoul(argv[4]) : 300);
+
+    std::string rootTemplate = (fs::temp_directory_path() /
+                                "dbus-sensors-scale-XXXXXX")
+                                   .string();
+    if (mkdtemp(rootTemplate.data()) == nullptr)
+    {
+        std::cerr << "cannot create the fake sysfs root\n";
+        return 1;
+    }
+    fs::path root(rootTemplate);
+
+    pid_t busPid = -1;
+    pid_t daemonPid = -1;
+    int result = 1;
+    try
+    {
+        auto genStart = std::chrono::steady_clock::now();
+        std::vector<FakeDevice> devices = generateTree(root, kind, count);
+        auto genTime = std::chrono::steady_clock::now() - genStart;
+
+        std::string address = startBus(busPid);
+        boost::asio::io_context io;
+        auto conn = connectBus(io, address);
+        FakeEntityManager entityManager(conn, kind, devices);
+
+        auto start = std::chrono::steady_clock::now();
+        daemonPid = spawn({daemon},
+                          {"DBUS_SYSTEM_BUS_ADDRESS=" + address,
+                           "DBUS_SESSION_BUS_ADDRESS=" + address,
+                           "DBUS_SENSORS_SYSFS_ROOT=" + root.string()},
+                          -1, (root / "daemon.log").string());
+
+        boost::asio::steady_timer pollTimer(io);
+        size_t published = 0;
+        std::function<void()> poll = [&]() {
+            pollTimer.expires_after(pollInterval);
+            pollTimer.async_wait([&](const boost::system::error_code& ec) {
+                if (ec)
+                {
+                    return;
+                }
+                if (std::chrono::steady_clock::now() - start > timeout)
+                {
+                    std::cerr << "timed out with " << published << " of "
+                              << count << " sensors published\n";
+                    io.stop();
+                    return;
+                }
+                auto msg = conn->new_method_call(
+                    kind.busName, "/xyz/openbmc_project/sensors",
+                    "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+                conn->async_send(msg, [&](const boost::system::error_code& ec,
+                                          sdbusplus::message_t reply) {
+                    if (!ec && !reply.is_method_error())
+                    {
+                        published = countPublished(reply.get());
+                    }
+                    if (published >= count)
+                    {
+                        io.stop();
+                        return;
+                    }
+                    poll();
+                });
+            });
+        };
+        poll();
+        io.run();
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        auto ms = [](auto duration) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       duration)
+                .count();
+        };
+        std::cout << "daemon=" << daemon << " sensors=" << published << "/"
+                  << count << " tree_ms=" << ms(genTime)
+                  << " published_ms=" << ms(elapsed)
+                  << " rss_kb=" << readStatusKb(daemonPid, "VmRSS").value_or(0)
+                  << " hwm_kb=" << readStatusKb(daemonPid, "VmHWM").value_or(0)
+                  << "\n";
+        result = published >= count ? 0 : 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+    }
+
+    stop(daemonPid);
+    stop(busPid);
+    std::error_code ec;
+    if (result == 0)
+    {
+        fs::remove_all(root, ec);
+    }
+    else
+    {
+        std::cerr << "tree and daemon log kept in " << root << "\n";
+    }
+    return result;
+}
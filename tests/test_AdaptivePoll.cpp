@@ -0,0 +1,81 @@
+#include "AdaptivePoll.hpp"
+#include "Thresholds.hpp"
+#include "Utils.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using std::chrono::milliseconds;
+
+namespace
+{
+
+std::vector<thresholds::Threshold> highWarning()
+{
+    return {{thresholds::Level::WARNING, thresholds::Direction::HIGH, 80.0}};
+}
+
+} // namespace
+
+TEST(AdaptivePoll, BacksOffWhileStable)
+{
+    AdaptivePoll poll(milliseconds(100), milliseconds(4000),
+                      milliseconds(1000));
+    std::vector<milliseconds> intervals;
+    for (size_t ii = 0; ii < 3 * AdaptivePoll::stableReadings; ii++)
+    {
+        intervals.push_back(poll.next(40.0, highWarning(), 1.0));
+    }
+    EXPECT_EQ(intervals.front(), milliseconds(1000));
+    EXPECT_EQ(intervals[AdaptivePoll::stableReadings - 1], milliseconds(2000));
+    EXPECT_EQ(intervals.back(), milliseconds(4000));
+}
+
+TEST(AdaptivePoll, FastNearThreshold)
+{
+    AdaptivePoll poll(milliseconds(100), milliseconds(4000),
+                      milliseconds(1000));
+    EXPECT_EQ(poll.next(77.0, highWarning(), 1.0), milliseconds(100));
+    // Far from the threshold again, but it moved by more than the band
+    EXPECT_EQ(poll.next(40.0, highWarning(), 1.0), milliseconds(100));
+}
+
+TEST(AdaptivePoll, FastOnQuickChange)
+{
+    AdaptivePoll poll(milliseconds(100), milliseconds(4000),
+                      milliseconds(1000));
+    EXPECT_EQ(poll.next(40.0, highWarning(), 1.0), milliseconds(1000));
+    EXPECT_EQ(poll.next(42.0, highWarning(), 1.0), milliseconds(100));
+}
+
+TEST(AdaptivePoll, NominalWithoutReading)
+{
+    AdaptivePoll poll(milliseconds(100), milliseconds(4000),
+                      milliseconds(1000));
+    EXPECT_EQ(poll.next(77.0, highWarning(), 1.0), milliseconds(100));
+    EXPECT_EQ(poll.next(std::numeric_limits<double>::quiet_NaN(),
+                        highWarning(), 1.0),
+              milliseconds(1000));
+}
+
+TEST(AdaptivePoll, Config)
+{
+    SensorBaseConfigMap cfg;
+    EXPECT_FALSE(getAdaptivePoll(cfg, 1.0F));
+
+    cfg["FastPollRate"] = 0.25;
+    std::optional<AdaptivePoll> poll = getAdaptivePoll(cfg, 1.0F);
+    ASSERT_TRUE(poll);
+    EXPECT_EQ(poll->fastInterval(), milliseconds(250));
+    EXPECT_EQ(poll->slowInterval(), milliseconds(1000));
+
+    cfg["SlowPollRate"] = uint64_t{10};
+    poll = getAdaptivePoll(cfg, 1.0F);
+    ASSERT_TRUE(poll);
+    EXPECT_EQ(poll->slowInterval(), milliseconds(10000));
+}
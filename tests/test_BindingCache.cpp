@@ -0,0 +1,159 @@
+#include "BindingCache.hpp"
+#include "Utils.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+class BindingCacheTest : public testing::Test
+{
+  protected:
+    BindingCacheTest()
+    {
+        auto dir = std::to_array("./testDirXXXXXX");
+        testDir = mkdtemp(dir.data());
+        if (testDir.empty())
+        {
+            throw std::bad_alloc();
+        }
+
+        hwmonDir = fs::path(testDir) / "hwmon";
+        fs::create_directories(hwmonDir / "hwmon10");
+        std::ofstream{hwmonDir / "hwmon10/temp1_input"};
+        std::ofstream{hwmonDir / "hwmon10/temp2_input"};
+    }
+
+    ~BindingCacheTest() override
+    {
+        fs::remove_all(testDir);
+    }
+
+    BindingCacheTest(const BindingCacheTest&) = delete;
+    BindingCacheTest(BindingCacheTest&&) = delete;
+    BindingCacheTest& operator=(const BindingCacheTest&) = delete;
+    BindingCacheTest& operator=(BindingCacheTest&&) = delete;
+
+    std::string testDir;
+    fs::path hwmonDir;
+};
+
+} // namespace
+
+TEST_F(BindingCacheTest, warmStart)
+{
+    // Symlink targets are taken relative to the link, so keep them absolute
+    fs::path devices = fs::absolute(testDir) / "devices";
+    fs::create_directories(devices / "3-0048/hwmon/hwmon3");
+    fs::create_directories(devices / "3-0049/hwmon/hwmon3");
+    std::ofstream{devices / "3-0048/hwmon/hwmon3/temp1_input"};
+    std::ofstream{devices / "3-0049/hwmon/hwmon3/temp1_input"};
+    fs::path link = fs::path(testDir) / "hwmon3";
+    fs::create_directory_symlink(devices / "3-0048/hwmon/hwmon3", link);
+
+    const std::vector<std::string> types{"TMP75"};
+    const std::string tmp75 = configInterfaceName("TMP75");
+    ManagedObjectType configs;
+    const std::string config = "/xyz/openbmc_project/inventory/system/b/T";
+    const std::string absent = "/xyz/openbmc_project/inventory/system/b/U";
+    const std::string foreign = "/xyz/openbmc_project/inventory/system/b/P";
+    configs[sdbusplus::message::object_path(config)][tmp75]["Bus"] = 3.0;
+    configs[sdbusplus::message::object_path(absent)][tmp75]["Bus"] = 4.0;
+    configs[sdbusplus::message::object_path(foreign)]
+           [configInterfaceName("pmbus")]["Bus"] = 3.0;
+    fs::path cacheFile = fs::path(testDir) / "cache/hwmon.json";
+
+    {
+        BindingCache cache(cacheFile);
+        EXPECT_FALSE(cache.warmStart(configs, types));
+        cache.bind(config, link / "temp1_input");
+        // Only objects of the daemon's types are left to discover
+        ManagedObjectType unbound = cache.unbound(configs, types);
+        ASSERT_EQ(unbound.size(), 1U);
+        EXPECT_EQ(unbound.begin()->first.str, absent);
+        cache.save(configs, types);
+    }
+    {
+        // The absent device does not keep the other from binding warm
+        BindingCache cache(cacheFile);
+        auto paths = cache.warmStart(configs, types);
+        ASSERT_TRUE(paths);
+        EXPECT_EQ(*paths, std::vector<fs::path>{link / "temp1_input"});
+        EXPECT_EQ(cache.unbound(configs, types).size(), 2U);
+        // Only the first scan binds from the cache
+        EXPECT_FALSE(cache.warmStart(configs, types));
+    }
+
+    // The same hwmon directory now belongs to another device
+    fs::remove(link);
+    fs::create_directory_symlink(devices / "3-0049/hwmon/hwmon3", link);
+    BindingCache cache(cacheFile);
+    EXPECT_FALSE(cache.warmStart(configs, types));
+}
+
+TEST_F(BindingCacheTest, save_prunes)
+{
+    fs::path hwmon10 = hwmonDir / "hwmon10";
+    const std::vector<std::string> types{"TMP75"};
+    const std::string tmp75 = configInterfaceName("TMP75");
+    const std::string kept = "/xyz/openbmc_project/inventory/system/b/T";
+    const std::string gone = "/xyz/openbmc_project/inventory/system/b/U";
+    ManagedObjectType configs;
+    configs[sdbusplus::message::object_path(kept)][tmp75]["Bus"] = 3.0;
+    configs[sdbusplus::message::object_path(gone)][tmp75]["Bus"] = 4.0;
+    fs::path cacheFile = fs::path(testDir) / "cache/hwmon.json";
+    {
+        BindingCache cache(cacheFile);
+        cache.bind(kept, hwmon10 / "temp1_input");
+        cache.bind(gone, hwmon10 / "temp2_input");
+        cache.save(configs, types);
+    }
+
+    // The object went away; an incomplete configuration may just have
+    // missed it, so it keeps its binding
+    configs.erase(sdbusplus::message::object_path(gone));
+    {
+        BindingCache cache(cacheFile);
+        cache.save(configs, types, true);
+    }
+    {
+        BindingCache cache(cacheFile);
+        configs[sdbusplus::message::object_path(gone)][tmp75]["Bus"] = 4.0;
+        auto paths = cache.warmStart(configs, types);
+        ASSERT_TRUE(paths);
+        EXPECT_EQ(paths->size(), 2U);
+        configs.erase(sdbusplus::message::object_path(gone));
+        // A complete one drops it
+        cache.save(configs, types);
+    }
+    {
+        BindingCache cache(cacheFile);
+        configs[sdbusplus::message::object_path(gone)][tmp75]["Bus"] = 4.0;
+        auto paths = cache.warmStart(configs, types);
+        ASSERT_TRUE(paths);
+        EXPECT_EQ(*paths, std::vector<fs::path>{hwmon10 / "temp1_input"});
+    }
+
+    // As does one where the object is no longer of the daemon's types
+    configs.erase(sdbusplus::message::object_path(gone));
+    configs[sdbusplus::message::object_path(kept)].erase(tmp75);
+    configs[sdbusplus::message::object_path(kept)]
+           [configInterfaceName("pmbus")]["Bus"] = 3.0;
+    {
+        BindingCache cache(cacheFile);
+        cache.save(configs, types);
+    }
+    configs[sdbusplus::message::object_path(kept)][tmp75]["Bus"] = 3.0;
+    BindingCache cache(cacheFile);
+    EXPECT_FALSE(cache.warmStart(configs, types));
+}
@@ -0,0 +1,148 @@
+#include "ConfigReconcile.hpp"
+#include "Utils.hpp"
+
+#include <boost/container/flat_map.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(ConfigReconcilerTest, RebuildsOnlyChangedObjects)
+{
+    struct FakeSensor
+    {
+        std::string configurationPath;
+    };
+    const std::string board = "/xyz/openbmc_project/inventory/system/board/B/";
+
+    ManagedObjectType configs;
+    configs[sdbusplus::message::object_path(board + "A")]["Type"]["X"] = 1.0;
+    configs[sdbusplus::message::object_path(board + "B")]["Type"]["X"] = 1.0;
+    configs[sdbusplus::message::object_path(board + "C")]["Type"]["X"] = 1.0;
+
+    ConfigReconciler reconciler;
+    EXPECT_EQ(reconciler.update(configs).added.size(), 3U);
+    EXPECT_TRUE(reconciler.needsRebuild(board + "A"));
+
+    // Re-reading identical configuration rebuilds nothing
+    EXPECT_TRUE(reconciler.update(configs).empty());
+    EXPECT_FALSE(reconciler.needsRebuild(board + "A"));
+
+    configs[sdbusplus::message::object_path(board + "B")]["Type"]["X"] = 2.0;
+    configs.erase(sdbusplus::message::object_path(board + "C"));
+    configs[sdbusplus::message::object_path(board + "D")]["Type"]["X"] = 1.0;
+    const ConfigDiff& diff = reconciler.update(configs);
+    EXPECT_EQ(diff.added, std::vector<std::string>{board + "D"});
+    EXPECT_EQ(diff.changed, std::vector<std::string>{board + "B"});
+    EXPECT_EQ(diff.removed, std::vector<std::string>{board + "C"});
+    EXPECT_FALSE(reconciler.needsRebuild(board + "A"));
+    EXPECT_TRUE(reconciler.needsRebuild(board + "B"));
+    EXPECT_TRUE(reconciler.needsRebuild(board + "D"));
+
+    boost::container::flat_map<std::string, std::shared_ptr<FakeSensor>>
+        sensors;
+    sensors["a"] = std::make_shared<FakeSensor>(board + "A");
+    sensors["c"] = std::make_shared<FakeSensor>(board + "C");
+    sensors["none"] = nullptr;
+    EXPECT_EQ(reconciler.removeSensors(sensors), 1U);
+    EXPECT_TRUE(sensors.contains("a"));
+    EXPECT_FALSE(sensors.contains("c"));
+}
+
+TEST(ConfigReconcilerTest, IncompleteFetchRemovesNothing)
+{
+    struct FakeSensor
+    {
+        std::string configurationPath;
+    };
+    const std::string board = "/xyz/openbmc_project/inventory/system/board/B/";
+
+    ManagedObjectType configs;
+    configs[sdbusplus::message::object_path(board + "A")]["Type"]["X"] = 1.0;
+    configs[sdbusplus::message::object_path(board + "A")]["Thresholds"]["X"] =
+        1.0;
+    configs[sdbusplus::message::object_path(board + "B")]["Type"]["X"] = 1.0;
+    configs[sdbusplus::message::object_path(board + "C")]["Type"]["X"] = 1.0;
+
+    ConfigReconciler reconciler;
+    reconciler.update(configs);
+
+    // A lost B, A its thresholds and C changed, as far as the fetch got
+    ManagedObjectType partial = configs;
+    partial.erase(sdbusplus::message::object_path(board + "B"));
+    partial[sdbusplus::message::object_path(board + "A")].erase("Thresholds");
+    partial[sdbusplus::message::object_path(board + "A")]["Type"]["X"] = 2.0;
+    partial[sdbusplus::message::object_path(board + "C")]["Type"]["X"] = 2.0;
+    partial[sdbusplus::message::object_path(board + "D")]["Type"]["X"] = 1.0;
+    const ConfigDiff& diff = reconciler.update(partial, true);
+    EXPECT_TRUE(diff.removed.empty());
+    EXPECT_EQ(diff.changed, std::vector<std::string>{board + "C"});
+    EXPECT_EQ(diff.added, std::vector<std::string>{board + "D"});
+    EXPECT_FALSE(reconciler.needsRebuild(board + "A"));
+
+    boost::container::flat_map<std::string, std::shared_ptr<FakeSensor>>
+        sensors;
+    sensors["b"] = std::make_shared<FakeSensor>(board + "B");
+    EXPECT_EQ(reconciler.removeSensors(sensors), 0U);
+    EXPECT_TRUE(sensors.contains("b"));
+
+    // The next complete fetch does not report C and D again, only A, which
+    // was not read in full before
+    configs[sdbusplus::message::object_path(board + "A")]["Type"]["X"] = 2.0;
+    configs[sdbusplus::message::object_path(board + "C")]["Type"]["X"] = 2.0;
+    configs[sdbusplus::message::object_path(board + "D")]["Type"]["X"] = 1.0;
+    const ConfigDiff& complete = reconciler.update(configs);
+    EXPECT_TRUE(complete.added.empty());
+    EXPECT_EQ(complete.changed, std::vector<std::string>{board + "A"});
+    EXPECT_TRUE(complete.removed.empty());
+    configs.erase(sdbusplus::message::object_path(board + "B"));
+    EXPECT_EQ(reconciler.update(configs).removed,
+              std::vector<std::string>{board + "B"});
+    EXPECT_EQ(reconciler.removeSensors(sensors), 1U);
+}
+
+TEST(ConfigReconcilerTest, UpdatesInPlaceChanges)
+{
+    const std::string board = "/xyz/openbmc_project/inventory/system/board/B/";
+    const std::string base = "xyz.openbmc_project.Configuration.ADC";
+    const std::string thresholds = base + ".Thresholds0";
+
+    ManagedObjectType configs;
+    for (const char* name : {"A", "B", "C", "D"})
+    {
+        auto& object = configs[sdbusplus::message::object_path(board + name)];
+        object[base]["Name"] = std::string(name);
+        object[base]["ScaleFactor"] = 1.0;
+        object[thresholds]["Value"] = 1.0;
+    }
+
+    ConfigReconciler reconciler({"ScaleFactor"});
+    reconciler.update(configs);
+    EXPECT_FALSE(reconciler.canUpdate(board + "A"));
+
+    // A changed its threshold, B its scale, C its name and D lost its
+    // thresholds
+    configs[sdbusplus::message::object_path(board + "A")][thresholds]["Value"] =
+        2.0;
+    configs[sdbusplus::message::object_path(board + "B")][base]["ScaleFactor"] =
+        2.0;
+    configs[sdbusplus::message::object_path(board + "C")][base]["Name"] =
+        std::string("E");
+    configs[sdbusplus::message::object_path(board + "D")].erase(thresholds);
+    EXPECT_EQ(reconciler.update(configs).changed.size(), 4U);
+    EXPECT_TRUE(reconciler.canUpdate(board + "A"));
+    EXPECT_TRUE(reconciler.canUpdate(board + "B"));
+    EXPECT_FALSE(reconciler.canUpdate(board + "C"));
+    EXPECT_TRUE(reconciler.canUpdate(board + "D"));
+    EXPECT_TRUE(reconciler.needsRebuild(board + "A"));
+
+    // Without ScaleFactor taken in place, a new one rebuilds
+    ConfigReconciler strict;
+    strict.update(configs);
+    configs[sdbusplus::message::object_path(board + "B")][base]["ScaleFactor"] =
+        3.0;
+    strict.update(configs);
+    EXPECT_FALSE(strict.canUpdate(board + "B"));
+}
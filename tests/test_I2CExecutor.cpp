@@ -0,0 +1,313 @@
+#include "I2CBus.hpp"
+#include "I2CExecutor.hpp"
+#include "Utils.hpp"
+
+#include <unistd.h>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+// Regular files standing in for /dev/i2c-N
+class I2CExecutorTest : public testing::Test
+{
+  protected:
+    I2CExecutorTest()
+    {
+        std::string dirTemplate = "/tmp/i2c-executor-XXXXXX";
+        dir = mkdtemp(dirTemplate.data());
+        for (unsigned bus = 0; bus < 2; bus++)
+        {
+            std::ofstream(dir / ("i2c-" + std::to_string(bus)))
+                << static_cast<char>('a' + bus);
+        }
+        I2CExecutor::get(io).setDevicePrefix((dir / "i2c-").string());
+    }
+
+    ~I2CExecutorTest() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    I2CExecutorTest(const I2CExecutorTest&) = delete;
+    I2CExecutorTest(I2CExecutorTest&&) = delete;
+    I2CExecutorTest& operator=(const I2CExecutorTest&) = delete;
+    I2CExecutorTest& operator=(I2CExecutorTest&&) = delete;
+
+    boost::asio::io_context io;
+    std::filesystem::path dir;
+};
+
+int readByte(I2CBus& bus, std::vector<uint8_t>& data)
+{
+    data.resize(1);
+    if (::pread(bus.fd(), data.data(), 1, 0) != 1)
+    {
+        return -EIO;
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST_F(I2CExecutorTest, CompletesInOrderOnTheIoContext)
+{
+    I2CChannel channel(io, 1);
+    std::vector<int> completed;
+    std::thread::id ioThread = std::this_thread::get_id();
+    for (int ii = 0; ii < 5; ii++)
+    {
+        channel.submit([ii](I2CBus& bus, std::vector<uint8_t>& data) {
+            int rc = readByte(bus, data);
+            return rc < 0 ? rc : ii;
+        },
+                       [&completed, ioThread](int rc,
+                                              std::vector<uint8_t>& data) {
+            EXPECT_EQ(std::this_thread::get_id(), ioThread);
+            ASSERT_EQ(data.size(), 1U);
+            EXPECT_EQ(data[0], 'b');
+            completed.push_back(rc);
+        });
+    }
+    io.run();
+    EXPECT_EQ(completed, (std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+TEST_F(I2CExecutorTest, SlowBusDoesNotBlockOthers)
+{
+    using namespace std::chrono_literals;
+    I2CChannel slow(io, 0);
+    I2CChannel fast(io, 1);
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration slowDone{};
+    std::chrono::steady_clock::duration fastDone{};
+    std::chrono::steady_clock::duration timerDone{};
+
+    slow.submit([](I2CBus&, std::vector<uint8_t>&) {
+        std::this_thread::sleep_for(300ms);
+        return 0;
+    },
+                [&](int rc, std::vector<uint8_t>&) {
+        EXPECT_EQ(rc, 0);
+        slowDone = std::chrono::steady_clock::now() - start;
+    });
+    fast.submit(readByte, [&](int rc, std::vector<uint8_t>& data) {
+        EXPECT_EQ(rc, 0);
+        EXPECT_EQ(data.at(0), 'b');
+        fastDone = std::chrono::steady_clock::now() - start;
+    });
+    boost::asio::steady_timer timer(io, 50ms);
+    timer.async_wait([&](const boost::system::error_code&) {
+        timerDone = std::chrono::steady_clock::now() - start;
+    });
+    io.run();
+
+    EXPECT_GE(slowDone, 300ms);
+    EXPECT_LT(fastDone, 200ms);
+    EXPECT_LT(timerDone, 200ms);
+}
+
+TEST_F(I2CExecutorTest, MissingBusFailsWithoutRunningTransfer)
+{
+    I2CChannel channel(io, 7);
+    bool transferred = false;
+    int result = 0;
+    channel.submit([&transferred](I2CBus&, std::vector<uint8_t>&) {
+        transferred = true;
+        return 0;
+    },
+                   [&result](int rc, std::vector<uint8_t>&) { result = rc; });
+    io.run();
+    EXPECT_FALSE(transferred);
+    EXPECT_EQ(result, -ENOENT);
+}
+
+TEST_F(I2CExecutorTest, DestroyedChannelDropsCompletion)
+{
+    bool completed = false;
+    {
+        I2CChannel channel(io, 0);
+        channel.submit(readByte, [&completed](int, std::vector<uint8_t>&) {
+            completed = true;
+        });
+    }
+    io.run();
+    EXPECT_FALSE(completed);
+}
+
+TEST_F(I2CExecutorTest, CriticalTransfersOvertakeQueuedBulk)
+{
+    using namespace std::chrono_literals;
+    I2CChannel normal(io, 0);
+    I2CChannel bulk(io, 0, {.priority = I2CPriority::bulk});
+    I2CChannel critical(io, 0, {.priority = I2CPriority::critical});
+    std::vector<std::string> completed;
+    auto record = [&completed](const std::string& what) {
+        return [&completed, what](int rc, std::vector<uint8_t>&) {
+            EXPECT_EQ(rc, 0);
+            completed.push_back(what);
+        };
+    };
+
+    // Keeps the worker busy while the rest is queued
+    normal.submit([](I2CBus&, std::vector<uint8_t>&) {
+        std::this_thread::sleep_for(100ms);
+        return 0;
+    },
+                  record("normal"));
+    for (int ii = 0; ii < 3; ii++)
+    {
+        bulk.submit(readByte, record("bulk"));
+    }
+    critical.submit(readByte, record("critical"));
+    io.run();
+
+    ASSERT_EQ(completed.size(), 5U);
+    auto firstBulk = std::find(completed.begin(), completed.end(), "bulk");
+    auto firstCritical = std::find(completed.begin(), completed.end(),
+                                   "critical");
+    EXPECT_LT(firstCritical, firstBulk);
+}
+
+TEST_F(I2CExecutorTest, TransferPastItsDeadlineIsDropped)
+{
+    using namespace std::chrono_literals;
+    I2CChannel busy(io, 0);
+    I2CChannel limited(io, 0, {.deadline = 20ms});
+    bool transferred = false;
+    int result = 0;
+
+    busy.submit([](I2CBus&, std::vector<uint8_t>&) {
+        std::this_thread::sleep_for(100ms);
+        return 0;
+    },
+                [](int, std::vector<uint8_t>&) {});
+    limited.submit([&transferred](I2CBus&, std::vector<uint8_t>&) {
+        transferred = true;
+        return 0;
+    },
+                   [&result](int rc, std::vector<uint8_t>&) { result = rc; });
+    io.run();
+
+    EXPECT_FALSE(transferred);
+    EXPECT_EQ(result, i2cExpired);
+}
+
+TEST_F(I2CExecutorTest, DeadlineOfTheRequestOverridesTheChannel)
+{
+    using namespace std::chrono_literals;
+    I2CChannel busy(io, 0);
+    I2CChannel limited(io, 0, {.deadline = 20ms});
+    std::vector<int> results;
+    auto record = [&results](int rc, std::vector<uint8_t>&) {
+        results.push_back(rc);
+    };
+
+    busy.submit([](I2CBus&, std::vector<uint8_t>&) {
+        std::this_thread::sleep_for(100ms);
+        return 0;
+    },
+                [](int, std::vector<uint8_t>&) {});
+    limited.submit(readByte, record, 0ms);
+    busy.submit(readByte, record, 20ms);
+    io.run();
+
+    EXPECT_EQ(results, (std::vector<int>{0, i2cExpired}));
+}
+
+TEST_F(I2CExecutorTest, TransferFailureIsNotTakenForExpiry)
+{
+    I2CChannel channel(io, 0);
+    std::vector<int> results;
+    for (int failure : {-ETIMEDOUT, i2cExpired})
+    {
+        channel.submit([failure](I2CBus&, std::vector<uint8_t>&) {
+            return failure;
+        },
+                       [&results](int rc, std::vector<uint8_t>&) {
+            results.push_back(rc);
+        });
+    }
+    io.run();
+    EXPECT_EQ(results, (std::vector<int>{-ETIMEDOUT, -EIO}));
+}
+
+TEST_F(I2CExecutorTest, BusStaysOpenAcrossTransfers)
+{
+    I2CChannel channel(io, 0);
+    std::vector<int> fds;
+    for (int ii = 0; ii < 3; ii++)
+    {
+        channel.submit([](I2CBus& bus, std::vector<uint8_t>& /*data*/) {
+            return bus.fd();
+        },
+                       [&fds](int rc, std::vector<uint8_t>& /*data*/) {
+            fds.push_back(rc);
+        });
+    }
+    io.run();
+    ASSERT_EQ(fds.size(), 3U);
+    EXPECT_GE(fds[0], 0);
+    EXPECT_EQ(fds[1], fds[0]);
+    EXPECT_EQ(fds[2], fds[0]);
+}
+
+TEST_F(I2CExecutorTest, HelpersNeedAdapterFunctionality)
+{
+    // A regular file answers no I2C_FUNCS, so nothing is supported
+    I2CBus bus((dir / "i2c-0").string());
+    ASSERT_EQ(bus.open(), 0);
+    std::vector<uint8_t> block;
+    EXPECT_EQ(bus.readByteData(0x50, 0), -EOPNOTSUPP);
+    EXPECT_EQ(bus.readWordData(0x50, 0), -EOPNOTSUPP);
+    EXPECT_EQ(bus.readBlockData(0x50, 0, block), -EOPNOTSUPP);
+    EXPECT_TRUE(block.empty());
+    std::array<uint8_t, 1> byte{};
+    EXPECT_EQ(bus.write(0x50, byte), -EOPNOTSUPP);
+}
+
+TEST(I2CPolicy, ReadFromConfiguration)
+{
+    using namespace std::chrono_literals;
+    I2CPolicy defaults{.priority = I2CPriority::bulk};
+    I2CPolicy policy = getI2CPolicy({}, defaults);
+    EXPECT_EQ(policy.priority, I2CPriority::bulk);
+    EXPECT_EQ(policy.deadline, 0ms);
+
+    SensorBaseConfigMap cfg{{"I2CPriority", std::string("Critical")},
+                            {"I2CDeadline", 0.25}};
+    policy = getI2CPolicy(cfg, defaults);
+    EXPECT_EQ(policy.priority, I2CPriority::critical);
+    EXPECT_EQ(policy.deadline, 250ms);
+
+    cfg = {{"I2CPriority", std::string("Urgent")}, {"I2CDeadline", -1.0}};
+    policy = getI2CPolicy(cfg, defaults);
+    EXPECT_EQ(policy.priority, I2CPriority::bulk);
+    EXPECT_EQ(policy.deadline, 0ms);
+}
+
+TEST(I2CPolicy, SharedDeadlineIsTheLoosest)
+{
+    using namespace std::chrono_literals;
+    EXPECT_EQ(i2cSharedDeadline(20ms, 50ms), 50ms);
+    EXPECT_EQ(i2cSharedDeadline(50ms, 20ms), 50ms);
+    EXPECT_EQ(i2cSharedDeadline(20ms, 0ms), 0ms);
+    EXPECT_EQ(i2cSharedDeadline(0ms, 20ms), 0ms);
+}
@@ -0,0 +1,195 @@
+#include "I2CBus.hpp"
+#include "I2CExecutor.hpp"
+#include "PLXBus.hpp"
+
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+
+#include <boost/asio/io_context.hpp>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(PLXReadTransaction, SequencesEverySwitchInTurn)
+{
+    const std::vector<uint8_t> switches = {0x38, 0x39, 0x5a};
+    for (size_t count = 1; count <= switches.size(); count++)
+    {
+        std::span<const uint8_t> addresses(switches.data(), count);
+        PLXReadCommands commands;
+        std::vector<uint8_t> data;
+        std::vector<i2c_msg> msgs = plxReadTransaction(addresses, commands,
+                                                       data);
+        ASSERT_EQ(msgs.size(), count * plxReadMessages);
+        ASSERT_EQ(data.size(), count * arrayLenRead);
+
+        for (size_t ii = 0; ii < count; ii++)
+        {
+            const i2c_msg* msg = &msgs[ii * plxReadMessages];
+            for (PLXWrite& write : commands.writes)
+            {
+                EXPECT_EQ(msg->addr, switches[ii]);
+                EXPECT_EQ(msg->flags, 0);
+                EXPECT_EQ(msg->len, arrayLenWrite);
+                EXPECT_EQ(msg->buf, write.data());
+                msg++;
+            }
+            for (PLXSelect& select : commands.selects)
+            {
+                EXPECT_EQ(msg->addr, switches[ii]);
+                EXPECT_EQ(msg->flags, 0);
+                EXPECT_EQ(msg->len, arrayLenRead);
+                EXPECT_EQ(msg->buf, select.data());
+                msg++;
+            }
+            EXPECT_EQ(msg->addr, switches[ii]);
+            EXPECT_EQ(msg->flags, I2C_M_RD);
+            EXPECT_EQ(msg->len, arrayLenRead);
+            EXPECT_EQ(msg->buf, &data[ii * arrayLenRead]);
+        }
+    }
+
+    // The register sequence itself, starting and ending as the Atlas
+    // documents it
+    PLXReadCommands commands;
+    EXPECT_EQ(commands.writes.front(),
+              (PLXWrite{0x03, 0x58, 0x3c, 0x40, 0xff, 0xe7, 0x85, 0x04}));
+    EXPECT_EQ(commands.writes.back(),
+              (PLXWrite{0x03, 0x58, 0x3c, 0x42, 0x00, 0x00, 0x00, 0x02}));
+    EXPECT_EQ(commands.selects,
+              (std::array<PLXSelect, 2>{{{0x04, 0x58, 0x3c, 0x42},
+                                         {0x04, 0x58, 0x3c, 0x41}}}));
+    EXPECT_LE(plxReadGroup * plxReadMessages, I2C_RDWR_IOCTL_MAX_MSGS);
+}
+
+TEST(PLXBus, FailedGroupIsReadSwitchBySwitch)
+{
+    std::string dirTemplate = "/tmp/plx-bus-XXXXXX";
+    std::filesystem::path dir = mkdtemp(dirTemplate.data());
+    std::ofstream(dir / "i2c-5") << "device";
+
+    boost::asio::io_context io;
+    I2CExecutor::get(io).setDevicePrefix((dir / "i2c-").string());
+
+    // The group fails, as does the switch at 0x5a on its own; the others
+    // read back their address
+    std::mutex lock;
+    std::vector<std::vector<uint8_t>> transfers;
+    auto transfer = [&lock, &transfers](I2CBus&,
+                                        std::span<const uint8_t> addresses,
+                                        std::vector<uint8_t>& data) {
+        std::lock_guard guard(lock);
+        transfers.emplace_back(addresses.begin(), addresses.end());
+        if (addresses.size() > 1 || addresses[0] == 0x5a)
+        {
+            return -EIO;
+        }
+        data.assign(arrayLenRead, addresses[0]);
+        return 0;
+    };
+    auto plx = std::make_shared<PLXBus>(io, 5, transfer);
+
+    auto live = std::make_shared<int>(0);
+    auto gone = std::make_shared<int>(0);
+    std::map<uint8_t, std::vector<std::pair<int, std::vector<uint8_t>>>>
+        results;
+    auto record = [&results](uint8_t address) {
+        return [&results, address](int rc, std::vector<uint8_t>& data) {
+            results[address].emplace_back(rc, data);
+        };
+    };
+    plx->read(0x38, live, record(0x38));
+    plx->read(0x39, gone, record(0x39));
+    plx->read(0x5a, live, record(0x5a));
+    plx->read(0x5b, live, record(0x5b));
+    gone.reset();
+    io.run();
+
+    // Three switches fit a transaction, the fourth goes in one of its own
+    ASSERT_EQ(plxReadGroup, 3U);
+    EXPECT_EQ(transfers,
+              (std::vector<std::vector<uint8_t>>{
+                  {0x38, 0x39, 0x5a}, {0x5b}, {0x38}, {0x39}, {0x5a}}));
+
+    // Every live request completes once, with its own outcome
+    ASSERT_EQ(results.size(), 3U);
+    ASSERT_EQ(results[0x38].size(), 1U);
+    EXPECT_EQ(results[0x38][0].first, 0);
+    EXPECT_EQ(results[0x38][0].second, std::vector<uint8_t>(4, 0x38));
+    ASSERT_EQ(results[0x5a].size(), 1U);
+    EXPECT_EQ(results[0x5a][0].first, -EIO);
+    EXPECT_TRUE(results[0x5a][0].second.empty());
+    ASSERT_EQ(results[0x5b].size(), 1U);
+    EXPECT_EQ(results[0x5b][0].first, 0);
+    EXPECT_EQ(results[0x5b][0].second, std::vector<uint8_t>(4, 0x5b));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PLXBus, ExpiredGroupIsNotSplit)
+{
+    using namespace std::chrono_literals;
+    std::string dirTemplate = "/tmp/plx-bus-XXXXXX";
+    std::filesystem::path dir = mkdtemp(dirTemplate.data());
+    std::ofstream(dir / "i2c-5") << "device";
+
+    boost::asio::io_context io;
+    I2CExecutor::get(io).setDevicePrefix((dir / "i2c-").string());
+
+    std::atomic<int> transfers = 0;
+    auto plx = std::make_shared<PLXBus>(
+        io, 5,
+        [&transfers](I2CBus&, std::span<const uint8_t>,
+                     std::vector<uint8_t>&) {
+        transfers++;
+        return -EIO;
+    });
+
+    // Keeps the bus busy past the deadline of the readings
+    plx->channel().submit([](I2CBus&, std::vector<uint8_t>&) {
+        std::this_thread::sleep_for(100ms);
+        return 0;
+    },
+                          [](int, std::vector<uint8_t>&) {});
+    auto live = std::make_shared<int>(0);
+    std::vector<int> results;
+    for (uint8_t address : {0x38, 0x39})
+    {
+        plx->read(address, live,
+                  [&results](int rc, std::vector<uint8_t>&) {
+            results.push_back(rc);
+        }, 20ms);
+    }
+    io.run();
+
+    EXPECT_EQ(transfers, 0);
+    EXPECT_EQ(results, (std::vector<int>{i2cExpired, i2cExpired}));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PLXBus, SharedPerBusAndIoContext)
+{
+    boost::asio::io_context io;
+    std::shared_ptr<PLXBus> plx = PLXBus::get(io, 5);
+    EXPECT_EQ(PLXBus::get(io, 5), plx);
+    EXPECT_NE(PLXBus::get(io, 6), plx);
+
+    boost::asio::io_context other;
+    EXPECT_NE(PLXBus::get(other, 5), plx);
+}
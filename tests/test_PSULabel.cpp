@@ -0,0 +1,118 @@
+#include "PSULabel.hpp"
+
+#include <array>
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+// What the patterns psusensor used to build regexes from capture, for
+// checking the engine against them
+std::string regexCapture(const char* pattern, const std::string& name,
+                         size_t group)
+{
+    std::smatch matches;
+    std::regex regex(pattern);
+    if (!std::regex_search(name, matches, regex))
+    {
+        return {};
+    }
+    return matches[group];
+}
+
+} // namespace
+
+TEST(PSULabel, SensorTypeMatchesRegex)
+{
+    constexpr std::array<const char*, 10> hwmonNames{
+        "in1_input",
+        "curr12_input",
+        "power1_max",
+        "temp1_input",
+        "fan2_input",
+        "in_input",
+        "1in1_input",
+        "a1b2_input",
+        "vout1_input",
+        "noseparator",
+    };
+    for (const char* name : hwmonNames)
+    {
+        EXPECT_EQ(psuSensorType(DevTypes::HWMON, name),
+                  regexCapture("([A-Za-z]+)[0-9]*_", name, 1))
+            << name;
+    }
+
+    constexpr std::array<const char*, 8> iioNames{
+        "in_voltage0_raw",
+        "in_temp_input",
+        "in_pressure_input",
+        "out_current1_raw",
+        "in_voltage0",
+        "iio_voltage0_raw",
+        "in__raw",
+        "in_humidityrelative_input",
+    };
+    for (const char* name : iioNames)
+    {
+        EXPECT_EQ(psuSensorType(DevTypes::IIO, name),
+                  regexCapture("^(in|out)_([A-Za-z]+)[0-9]*_", name, 2))
+            << name;
+    }
+}
+
+TEST(PSULabel, LabelIndexMatchesRegex)
+{
+    constexpr std::array<const char*, 9> labelHeads{
+        "vout1",
+        "maxiout2",
+        "vin",
+        "temp12",
+        "fan1",
+        "1vout2",
+        "in_voltage0",
+        "a_b3",
+        "",
+    };
+    for (const char* head : labelHeads)
+    {
+        EXPECT_EQ(psuLabelIndex(head),
+                  regexCapture("[A-Za-z]+([0-9]+)", head, 1))
+            << head;
+    }
+}
+
+TEST(PSULabel, SiblingAttribute)
+{
+    EXPECT_EQ(psuSiblingAttribute("/sys/class/hwmon/hwmon3/in1_input",
+                                  "label"),
+              "/sys/class/hwmon/hwmon3/in1_label");
+    EXPECT_EQ(psuSiblingAttribute("/sys/class/hwmon/hwmon3/curr2_max",
+                                  "label"),
+              "/sys/class/hwmon/hwmon3/curr2_label");
+    EXPECT_EQ(psuSiblingAttribute("/sys/bus/i2c_x/devices/fan1_input",
+                                  "target"),
+              "/sys/bus/i2c_x/devices/fan1_target");
+    EXPECT_EQ(psuSiblingAttribute("/sys/bus/i2c_x/devices/name", "label"),
+              "");
+}
+
+TEST(PSULabel, Tables)
+{
+    const PSUPropertyDefaults* in = psuPropertyDefaults("in");
+    ASSERT_NE(in, nullptr);
+    EXPECT_EQ(std::string_view(in->labelTypeName), "Output Voltage");
+    EXPECT_EQ(in->maxReading, 255);
+    EXPECT_EQ(psuPropertyDefaults("voltage"), nullptr);
+
+    EXPECT_EQ(std::string_view(psuSensorUnit("curr")),
+              "xyz.openbmc_project.Sensor.Value.Unit.Amperes");
+    EXPECT_EQ(psuSensorUnit("pin"), nullptr);
+
+    EXPECT_EQ(psuScaleFactorKey("curr"), "CurrScaleFactor");
+}
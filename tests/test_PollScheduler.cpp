@@ -0,0 +1,130 @@
+#include "PollScheduler.hpp"
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(PollScheduler, CoalescesTimersDueInSameTick)
+{
+    boost::asio::io_context io;
+    std::vector<std::unique_ptr<PollTimer>> timers;
+    size_t fired = 0;
+    for (size_t ii = 0; ii < 100; ii++)
+    {
+        auto& timer = timers.emplace_back(std::make_unique<PollTimer>(io));
+        timer->expires_after(std::chrono::milliseconds(10));
+        timer->async_wait([&fired](const boost::system::error_code& ec) {
+            EXPECT_FALSE(ec);
+            fired++;
+        });
+    }
+    io.run();
+
+    const PollSchedulerStats& stats = PollScheduler::get(io).stats();
+    EXPECT_EQ(fired, 100U);
+    EXPECT_EQ(stats.fired, 100U);
+    EXPECT_LE(stats.wakeups, 2U);
+    EXPECT_EQ(PollScheduler::get(io).pending(), 0U);
+}
+
+TEST(PollScheduler, NeverFiresEarly)
+{
+    boost::asio::io_context io;
+    constexpr auto delays = std::to_array<std::chrono::milliseconds>(
+        {std::chrono::milliseconds(1), std::chrono::milliseconds(30),
+         std::chrono::milliseconds(1700), std::chrono::milliseconds(2100)});
+    std::vector<std::unique_ptr<PollTimer>> timers;
+    size_t fired = 0;
+    for (const auto& delay : delays)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto& timer = timers.emplace_back(std::make_unique<PollTimer>(io));
+        timer->expires_after(delay);
+        timer->async_wait(
+            [&fired, start, delay](const boost::system::error_code& ec) {
+            EXPECT_FALSE(ec);
+            EXPECT_GE(std::chrono::steady_clock::now() - start, delay);
+            fired++;
+        });
+    }
+    io.run();
+    EXPECT_EQ(fired, delays.size());
+}
+
+TEST(PollScheduler, CancelAbortsHandler)
+{
+    boost::asio::io_context io;
+    PollTimer timer(io);
+    bool aborted = false;
+    timer.expires_after(std::chrono::seconds(60));
+    timer.async_wait([&aborted](const boost::system::error_code& ec) {
+        aborted = (ec == boost::asio::error::operation_aborted);
+    });
+    EXPECT_EQ(timer.cancel(), 1U);
+    EXPECT_EQ(timer.cancel(), 0U);
+    io.run();
+    EXPECT_TRUE(aborted);
+    EXPECT_EQ(PollScheduler::get(io).stats().fired, 0U);
+}
+
+TEST(PollScheduler, RearmFromHandler)
+{
+    boost::asio::io_context io;
+    PollTimer timer(io);
+    size_t count = 0;
+    std::function<void(const boost::system::error_code&)> handler =
+        [&](const boost::system::error_code& ec) {
+        ASSERT_FALSE(ec);
+        if (++count < 5)
+        {
+            timer.expires_after(std::chrono::milliseconds(20));
+            timer.async_wait(
+                [&handler](const boost::system::error_code& ec) {
+                handler(ec);
+            });
+        }
+    };
+    timer.expires_after(std::chrono::milliseconds(20));
+    timer.async_wait(
+        [&handler](const boost::system::error_code& ec) { handler(ec); });
+    io.run();
+    EXPECT_EQ(count, 5U);
+}
+
+TEST(PollScheduler, BatchCallbacks)
+{
+    boost::asio::io_context io;
+    PollScheduler& scheduler = PollScheduler::get(io);
+    size_t starts = 0;
+    size_t ends = 0;
+    size_t handled = 0;
+    scheduler.addBatchStartCallback([&](size_t batchSize) {
+        EXPECT_EQ(batchSize, 3U);
+        EXPECT_EQ(handled, 0U);
+        starts++;
+    });
+    scheduler.addBatchEndCallback([&](size_t batchSize) {
+        EXPECT_EQ(batchSize, 3U);
+        EXPECT_EQ(handled, 3U);
+        ends++;
+    });
+
+    std::array<std::unique_ptr<PollTimer>, 3> timers;
+    for (auto& timer : timers)
+    {
+        timer = std::make_unique<PollTimer>(io);
+        timer->expires_after(std::chrono::milliseconds(0));
+        timer->async_wait(
+            [&handled](const boost::system::error_code&) { handled++; });
+    }
+    io.run();
+    EXPECT_EQ(starts, 1U);
+    EXPECT_EQ(ends, 1U);
+}
@@ -0,0 +1,117 @@
+#include "I2CExecutor.hpp"
+#include "SatelliteDevice.hpp"
+
+#include <boost/asio/io_context.hpp>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(SatelliteReadPlan, MergesContiguousAndOverlappingRanges)
+{
+    std::vector<SatelliteRange> blocks = planSatelliteReads(
+        {{8, 4}, {0, 4}, {4, 4}, {2, 2}, {12, 8}}, satelliteMaxBlockRead);
+    EXPECT_EQ(blocks, (std::vector<SatelliteRange>{{0, 20}}));
+}
+
+TEST(SatelliteReadPlan, BridgesGapsWithinTheBlockSize)
+{
+    std::vector<SatelliteRange> blocks =
+        planSatelliteReads({{0, 4}, {20, 4}, {40, 4}}, 32);
+    EXPECT_EQ(blocks, (std::vector<SatelliteRange>{{0, 24}, {40, 4}}));
+}
+
+TEST(SatelliteReadPlan, SplitsAtTheBlockSize)
+{
+    std::vector<SatelliteRange> ranges;
+    for (uint16_t offset = 0; offset < 64; offset += 8)
+    {
+        ranges.push_back({offset, 8});
+    }
+    std::vector<SatelliteRange> blocks = planSatelliteReads(ranges, 32);
+    EXPECT_EQ(blocks, (std::vector<SatelliteRange>{{0, 32}, {32, 32}}));
+}
+
+TEST(SatelliteReadPlan, KeepsOneAndTwoByteOffsetsApart)
+{
+    std::vector<SatelliteRange> blocks =
+        planSatelliteReads({{248, 8}, {256, 8}}, satelliteMaxBlockRead);
+    EXPECT_EQ(blocks, (std::vector<SatelliteRange>{{248, 8}, {256, 8}}));
+}
+
+TEST(SatelliteReading, SlicesTheBlock)
+{
+    // Block read at offset 16: two readings, one not updated yet and one
+    // that merely contains 0xFF bytes
+    std::vector<uint8_t> data = {0x01, 0x02, 0x03, 0x04, 0xAA, 0xBB,
+                                 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x10,
+                                 0xFF, 0x20, 0x30, 0x40};
+    std::array<uint8_t, sizeof(uint64_t)> reading{};
+
+    std::span<const uint8_t> bytes = satelliteReading(16, data, {16, 4},
+                                                      reading);
+    EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()),
+              (std::vector<uint8_t>{0x01, 0x02, 0x03, 0x04}));
+
+    bytes = satelliteReading(16, data, {20, 2}, reading);
+    EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()),
+              (std::vector<uint8_t>{0xAA, 0xBB}));
+    // Nothing of the previous reading is left behind the slice
+    EXPECT_EQ(reading[2], 0);
+
+    bytes = satelliteReading(16, data, {22, 4}, reading);
+    EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()),
+              (std::vector<uint8_t>{0, 0, 0, 0}));
+
+    bytes = satelliteReading(16, data, {26, 6}, reading);
+    EXPECT_EQ(std::vector<uint8_t>(bytes.begin(), bytes.end()),
+              (std::vector<uint8_t>{0xFF, 0x10, 0xFF, 0x20, 0x30, 0x40}));
+
+    bytes = satelliteReading(16, data, {16, 8}, reading);
+    EXPECT_EQ(bytes.size(), 8U);
+    EXPECT_EQ(bytes[7], 0xFF);
+}
+
+TEST(SatelliteDevice, CompletesEveryLiveReadOfTheBatch)
+{
+    std::string dirTemplate = "/tmp/satellite-device-XXXXXX";
+    std::filesystem::path dir = mkdtemp(dirTemplate.data());
+    // A regular file fails the I2C_RDWR, which every read then reports
+    std::ofstream(dir / "i2c-3") << "device";
+
+    boost::asio::io_context io;
+    I2CExecutor::get(io).setDevicePrefix((dir / "i2c-").string());
+    std::shared_ptr<SatelliteDevice> device = SatelliteDevice::get(io, 3, 0x42);
+    EXPECT_EQ(SatelliteDevice::get(io, 3, 0x42), device);
+    boost::asio::io_context other;
+    EXPECT_NE(SatelliteDevice::get(other, 3, 0x42), device);
+
+    auto live = std::make_shared<int>(0);
+    auto gone = std::make_shared<int>(0);
+    std::vector<int> results;
+    auto record = [&results](int rc, std::span<const uint8_t> bytes) {
+        EXPECT_TRUE(bytes.empty());
+        results.push_back(rc);
+    };
+    device->read(0, 4, live, record);
+    device->read(4, 4, live, record);
+    device->read(8, 4, gone, record);
+    device->read(12, 9, live, record);
+    EXPECT_EQ(results, std::vector<int>{-EINVAL});
+    gone.reset();
+    io.run();
+
+    ASSERT_EQ(results.size(), 3U);
+    EXPECT_LT(results[1], 0);
+    EXPECT_LT(results[2], 0);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,25 @@
+#include "StaticMap.hpp"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+TEST(StaticMapTest, SortedCaseInsensitiveLookup)
+{
+    static constexpr auto table = makeStaticMap<int, CaseInsensitiveLess>({
+        {"pmbus", 1},
+        {"ADM1272", 2},
+        {"cffps", 3},
+    });
+    static_assert(table.begin()->first == "ADM1272");
+    static_assert(table.find("CFFPS")->second == 3);
+
+    StaticMapView<int, CaseInsensitiveLess> view(table);
+    EXPECT_EQ(view.size(), 3U);
+    EXPECT_EQ(view.find(std::string("adm1272"))->second, 2);
+    EXPECT_EQ(view.find("pmbu"), view.end());
+    EXPECT_EQ(view.find("pmbus1"), view.end());
+
+    static constexpr auto exact = makeStaticMap<int>({{"in", 1}});
+    EXPECT_EQ(exact.find("In"), exact.end());
+}
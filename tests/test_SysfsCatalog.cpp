@@ -0,0 +1,197 @@
+#include "SysfsCatalog.hpp"
+#include "Utils.hpp"
+
+#include <boost/asio/io_context.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// The hwmon and PECI layouts of test_Utils.cpp, for comparing the catalog
+// with findFiles()
+class SysfsCatalogTest : public testing::Test
+{
+  protected:
+    SysfsCatalogTest()
+    {
+        auto dir = std::to_array("./testDirXXXXXX");
+        testDir = mkdtemp(dir.data());
+        if (testDir.empty())
+        {
+            throw std::bad_alloc();
+        }
+
+        hwmonDir = fs::path(testDir) / "hwmon";
+        auto hwmon10 = hwmonDir / "hwmon10";
+        fs::create_directories(hwmon10);
+        {
+            std::ofstream temp1Input{hwmon10 / "temp1_input"};
+            std::ofstream temp1Min{hwmon10 / "temp1_min"};
+            std::ofstream temp1Max{hwmon10 / "temp1_max"};
+            std::ofstream temp2Input{hwmon10 / "temp2_input"};
+        }
+
+        peciDir = fs::path(testDir) / "peci";
+        auto peci0 = peciDir /
+                     "peci-0/device/0-30/peci-cputemp.0/hwmon/hwmon25";
+        fs::create_directories(peci0);
+        {
+            std::ofstream temp0Input{peci0 / "temp0_input"};
+            std::ofstream temp1Input{peci0 / "temp1_input"};
+            std::ofstream temp2Input{peci0 / "temp2_input"};
+            std::ofstream name{peci0 / "name"};
+        }
+        auto devDir = peciDir / "peci-0/peci_dev/peci-0";
+        fs::create_directories(devDir);
+        fs::create_directory_symlink("../../../peci-0", devDir / "device");
+        fs::create_directory_symlink("device/0-30", peciDir / "peci-0/0-30");
+    }
+
+    ~SysfsCatalogTest() override
+    {
+        fs::remove_all(testDir);
+    }
+
+    SysfsCatalogTest(const SysfsCatalogTest&) = delete;
+    SysfsCatalogTest(SysfsCatalogTest&&) = delete;
+    SysfsCatalogTest& operator=(const SysfsCatalogTest&) = delete;
+    SysfsCatalogTest& operator=(SysfsCatalogTest&&) = delete;
+
+    std::string testDir;
+    fs::path hwmonDir;
+    fs::path peciDir;
+};
+
+} // namespace
+
+TEST_F(SysfsCatalogTest, findFiles_matches_findFiles)
+{
+    boost::asio::io_context io;
+    SysfsCatalog& catalog = SysfsCatalog::get(io);
+    const std::vector<std::pair<fs::path, std::string>> cases = {
+        {hwmonDir, R"(temp\d+_input)"},
+        {hwmonDir, R"(in\d+_input)"},
+        {hwmonDir.string() + "/", R"(temp\d+_input)"},
+        {hwmonDir / "hwmon10", R"(temp1_\w+$)"},
+        {peciDir, "name$"},
+        {"non-exist", ""},
+    };
+    for (int symlinkDepth : {0, 1, 6})
+    {
+        for (const auto& [dirPath, matchString] : cases)
+        {
+            std::vector<fs::path> expected;
+            bool expectedRet =
+                findFiles(dirPath, matchString, expected, symlinkDepth);
+            // Once to fill the listing, once served from it
+            for (int i = 0; i < 2; i++)
+            {
+                std::vector<fs::path> foundPaths;
+                EXPECT_EQ(catalog.findFiles(dirPath, matchString, foundPaths,
+                                            symlinkDepth),
+                          expectedRet);
+                std::ranges::sort(foundPaths);
+                std::ranges::sort(expected);
+                EXPECT_EQ(foundPaths, expected)
+                    << dirPath << " " << matchString << " " << symlinkDepth;
+            }
+        }
+    }
+}
+
+TEST_F(SysfsCatalogTest, findFiles_new_file)
+{
+    boost::asio::io_context io;
+    SysfsCatalog& catalog = SysfsCatalog::get(io);
+    std::vector<fs::path> foundPaths;
+    EXPECT_TRUE(catalog.findFiles(hwmonDir, R"(temp\d+_input)", foundPaths));
+    EXPECT_EQ(foundPaths.size(), 2U);
+    uint64_t generation = catalog.generation();
+
+    // Served from the listing, nothing dropped it
+    foundPaths.clear();
+    EXPECT_TRUE(catalog.findFiles(hwmonDir, R"(temp\d+_input)", foundPaths));
+    EXPECT_EQ(foundPaths.size(), 2U);
+    EXPECT_EQ(catalog.generation(), generation);
+
+    fs::path created = hwmonDir / "hwmon10" / "temp3_input";
+    std::ofstream{created};
+    foundPaths.clear();
+    EXPECT_TRUE(catalog.findFiles(hwmonDir, R"(temp\d+_input)", foundPaths));
+    EXPECT_EQ(foundPaths.size(), 3U);
+    EXPECT_NE(std::ranges::find(foundPaths, created), foundPaths.end());
+    if (catalog.caching())
+    {
+        // inotify reported the new file and the listing was dropped
+        EXPECT_GT(catalog.generation(), generation);
+    }
+}
+
+TEST_F(SysfsCatalogTest, findFiles_multi_level)
+{
+    boost::asio::io_context io;
+    SysfsCatalog& catalog = SysfsCatalog::get(io);
+    const std::string match =
+        R"(peci-\d+/\d+-.+/peci-.+/hwmon/hwmon\d+/temp\d+_input)";
+    std::vector<fs::path> expected;
+    EXPECT_TRUE(findFiles(peciDir, match, expected, 6));
+    std::vector<fs::path> foundPaths;
+    EXPECT_TRUE(catalog.findFiles(peciDir, match, foundPaths, 6));
+    EXPECT_EQ(foundPaths, expected);
+    EXPECT_EQ(foundPaths.size(), 3U);
+
+    // Passed through uncached, so a new file shows without invalidation
+    uint64_t generation = catalog.generation();
+    std::ofstream{peciDir / "peci-0/device/0-30/peci-cputemp.0/hwmon/hwmon25/"
+                            "temp3_input"};
+    foundPaths.clear();
+    EXPECT_TRUE(catalog.findFiles(peciDir, match, foundPaths, 6));
+    EXPECT_EQ(foundPaths.size(), 4U);
+    EXPECT_EQ(catalog.generation(), generation);
+
+    foundPaths.clear();
+    EXPECT_FALSE(catalog.findFiles("non-exist", match, foundPaths, 6));
+    EXPECT_TRUE(foundPaths.empty());
+}
+
+TEST_F(SysfsCatalogTest, ParseUevent)
+{
+    using namespace std::literals;
+    std::optional<SysfsCatalog::Uevent> event = SysfsCatalog::parseUevent(
+        "add@/devices/platform/i2c-3/3-0058/hwmon/hwmon7\0ACTION=add\0"
+        "DEVPATH=/devices/platform/i2c-3/3-0058/hwmon/hwmon7\0"
+        "SUBSYSTEM=hwmon\0SEQNUM=1234\0"sv);
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->action, "add");
+    EXPECT_EQ(event->devpath, "/devices/platform/i2c-3/3-0058/hwmon/hwmon7");
+    EXPECT_EQ(event->subsystem, "hwmon");
+
+    event = SysfsCatalog::parseUevent(
+        "unbind@/devices/platform/i2c-3/3-0058\0SUBSYSTEM=i2c"sv);
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->action, "unbind");
+    EXPECT_EQ(event->devpath, "");
+    EXPECT_EQ(event->subsystem, "i2c");
+
+    // Attribute changes and udev's own messages are of no interest
+    EXPECT_FALSE(SysfsCatalog::parseUevent(
+        "change@/devices/platform/i2c-3/3-0058\0SUBSYSTEM=i2c\0"sv));
+    EXPECT_FALSE(SysfsCatalog::parseUevent("libudev\0\xfe\xed"sv));
+    EXPECT_FALSE(SysfsCatalog::parseUevent(""sv));
+}
@@ -0,0 +1,296 @@
+#include "SensorPaths.hpp"
+#include "Thresholds.hpp"
+#include "sensor.hpp"
+
+#include <sys/socket.h>
+#include <systemd/sd-bus.h>
+#include <systemd/sd-id128.h>
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+using thresholds::Direction;
+using thresholds::Level;
+
+// A peer-to-peer bus over a socketpair, the other end a bare sd-bus server
+// in this process counting what the sensor sends it
+class ThresholdsTest : public testing::Test
+{
+  protected:
+    ThresholdsTest()
+    {
+        std::array<int, 2> fds{};
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0,
+                       fds.data()) < 0)
+        {
+            throw std::runtime_error("socketpair failed");
+        }
+
+        sd_id128_t serverId{};
+        sd_id128_randomize(&serverId);
+        sd_bus_new(&server);
+        sd_bus_set_fd(server, fds[1], fds[1]);
+        sd_bus_set_server(server, 1, serverId);
+        sd_bus_add_filter(server, nullptr, countMessage, this);
+        sd_bus_start(server);
+
+        sd_bus* client = nullptr;
+        sd_bus_new(&client);
+        sd_bus_set_fd(client, fds[0], fds[0]);
+        sd_bus_start(client);
+        while (sd_bus_is_ready(client) <= 0)
+        {
+            sd_bus_process(server, nullptr);
+            sd_bus_process(client, nullptr);
+        }
+
+        conn = std::make_shared<sdbusplus::asio::connection>(io, client);
+        objectServer = std::make_unique<sdbusplus::asio::object_server>(conn);
+    }
+
+    ~ThresholdsTest() override
+    {
+        objectServer.reset();
+        conn.reset();
+        sd_bus_flush_close_unref(server);
+    }
+
+    ThresholdsTest(const ThresholdsTest&) = delete;
+    ThresholdsTest(ThresholdsTest&&) = delete;
+    ThresholdsTest& operator=(const ThresholdsTest&) = delete;
+    ThresholdsTest& operator=(ThresholdsTest&&) = delete;
+
+    // Runs the posted work, e.g. the PropertiesChanged flush, and counts
+    // what reached the other end of the bus
+    void settle()
+    {
+        io.poll();
+        conn->flush();
+        while (sd_bus_process(server, nullptr) > 0)
+        {}
+    }
+
+    static int countMessage(sd_bus_message* msg, void* userdata,
+                            sd_bus_error* /*error*/)
+    {
+        auto* test = static_cast<ThresholdsTest*>(userdata);
+        const char* name = sd_bus_message_get_member(msg);
+        std::string_view member = name == nullptr ? "" : name;
+        if (member == "ThresholdAsserted")
+        {
+            test->asserted++;
+        }
+        else if (member == "PropertiesChanged")
+        {
+            test->propertiesChanged++;
+        }
+        return 0;
+    }
+
+    boost::asio::io_context io;
+    std::shared_ptr<sdbusplus::asio::connection> conn;
+    std::unique_ptr<sdbusplus::asio::object_server> objectServer;
+    size_t asserted = 0;
+    size_t propertiesChanged = 0;
+
+  private:
+    sd_bus* server = nullptr;
+};
+
+// Reads 0 to 100, so the default hysteresis is 1
+class TestSensor : public Sensor
+{
+  public:
+    TestSensor(sdbusplus::asio::object_server& objectServer,
+               std::shared_ptr<sdbusplus::asio::connection>& conn,
+               std::vector<thresholds::Threshold>&& thresholdData) :
+        Sensor("Test_Temp", std::move(thresholdData),
+               "/xyz/openbmc_project/inventory/system/board/Test_Board/Test",
+               "xyz.openbmc_project.Configuration.Test", false, false, 100.0,
+               0.0, conn),
+        objServer(objectServer)
+    {
+        std::string path = "/xyz/openbmc_project/sensors/temperature/" + name;
+        sensorInterface = objectServer.add_interface(path,
+                                                     sensorValueInterface);
+        for (const auto& threshold : thresholds)
+        {
+            auto& iface =
+                thresholdInterfaces[static_cast<size_t>(threshold.level)];
+            if (!iface)
+            {
+                iface = objectServer.add_interface(
+                    path, thresholds::getInterface(threshold.level));
+            }
+        }
+        association = objectServer.add_interface(path, association::interface);
+        setInitialProperties(sensor_paths::unitDegreesC);
+    }
+
+    ~TestSensor() override
+    {
+        for (const auto& iface : thresholdInterfaces)
+        {
+            objServer.remove_interface(iface);
+        }
+        objServer.remove_interface(sensorInterface);
+        objServer.remove_interface(association);
+    }
+
+    TestSensor(const TestSensor&) = delete;
+    TestSensor(TestSensor&&) = delete;
+    TestSensor& operator=(const TestSensor&) = delete;
+    TestSensor& operator=(TestSensor&&) = delete;
+
+    void checkThresholds() override
+    {
+        thresholds::checkThresholds(this);
+    }
+
+    bool alarm(Level level, Direction direction) const
+    {
+        return (thresholdAlarms & thresholds::alarmBit(level, direction)) != 0;
+    }
+
+  private:
+    sdbusplus::asio::object_server& objServer;
+};
+
+} // namespace
+
+TEST_F(ThresholdsTest, AssertAndDeassertWithHysteresis)
+{
+    auto sensor = std::make_shared<TestSensor>(
+        *objectServer, conn,
+        std::vector<thresholds::Threshold>{
+            {Level::WARNING, Direction::HIGH, 80.0},
+            {Level::WARNING, Direction::LOW, 20.0, 5.0}});
+    settle();
+    asserted = 0;
+
+    sensor->value = 80.0;
+    EXPECT_TRUE(thresholds::checkThresholds(sensor.get()));
+    EXPECT_TRUE(sensor->alarm(Level::WARNING, Direction::HIGH));
+    EXPECT_FALSE(sensor->alarm(Level::WARNING, Direction::LOW));
+
+    // Inside the band of the default hysteresis the alarm holds
+    sensor->value = 79.5;
+    thresholds::checkThresholds(sensor.get());
+    EXPECT_TRUE(sensor->alarm(Level::WARNING, Direction::HIGH));
+    sensor->value = 78.9;
+    thresholds::checkThresholds(sensor.get());
+    EXPECT_FALSE(sensor->alarm(Level::WARNING, Direction::HIGH));
+
+    // The low one has a hysteresis of its own
+    sensor->value = 19.0;
+    thresholds::checkThresholds(sensor.get());
+    EXPECT_TRUE(sensor->alarm(Level::WARNING, Direction::LOW));
+    sensor->value = 24.0;
+    thresholds::checkThresholds(sensor.get());
+    EXPECT_TRUE(sensor->alarm(Level::WARNING, Direction::LOW));
+    sensor->value = 25.5;
+    thresholds::checkThresholds(sensor.get());
+    EXPECT_FALSE(sensor->alarm(Level::WARNING, Direction::LOW));
+
+    settle();
+    EXPECT_EQ(asserted, 4U);
+}
+
+TEST_F(ThresholdsTest, CriticalStatusFollowsTheAlarm)
+{
+    auto sensor = std::make_shared<TestSensor>(
+        *objectServer, conn,
+        std::vector<thresholds::Threshold>{
+            {Level::WARNING, Direction::HIGH, 80.0},
+            {Level::CRITICAL, Direction::HIGH, 90.0, 2.0}});
+
+    sensor->value = 85.0;
+    EXPECT_TRUE(thresholds::checkThresholds(sensor.get()));
+    sensor->value = 90.0;
+    EXPECT_FALSE(thresholds::checkThresholds(sensor.get()));
+    // Still critical inside the hysteresis band
+    sensor->value = 88.5;
+    EXPECT_FALSE(thresholds::checkThresholds(sensor.get()));
+    EXPECT_TRUE(sensor->alarm(Level::CRITICAL, Direction::HIGH));
+    sensor->value = 87.5;
+    EXPECT_TRUE(thresholds::checkThresholds(sensor.get()));
+    EXPECT_FALSE(sensor->alarm(Level::CRITICAL, Direction::HIGH));
+    EXPECT_TRUE(sensor->alarm(Level::WARNING, Direction::HIGH));
+}
+
+TEST_F(ThresholdsTest, NothingSentWithoutTransition)
+{
+    auto sensor = std::make_shared<TestSensor>(
+        *objectServer, conn,
+        std::vector<thresholds::Threshold>{
+            {Level::WARNING, Direction::HIGH, 80.0}});
+    settle();
+    asserted = 0;
+    propertiesChanged = 0;
+
+    // Below the threshold from the start, nothing to clear
+    sensor->value = 50.0;
+    thresholds::checkThresholds(sensor.get());
+    settle();
+    EXPECT_EQ(asserted, 0U);
+    EXPECT_EQ(propertiesChanged, 0U);
+
+    sensor->value = 85.0;
+    thresholds::checkThresholds(sensor.get());
+    settle();
+    EXPECT_EQ(asserted, 1U);
+    EXPECT_EQ(propertiesChanged, 1U);
+
+    for (double value : {85.0, 90.0, 79.5})
+    {
+        sensor->value = value;
+        thresholds::checkThresholds(sensor.get());
+    }
+    settle();
+    EXPECT_EQ(asserted, 1U);
+    EXPECT_EQ(propertiesChanged, 1U);
+}
+
+TEST_F(ThresholdsTest, PowerDelayDropsTransientLowAssertion)
+{
+    auto sensor = std::make_shared<TestSensor>(
+        *objectServer, conn,
+        std::vector<thresholds::Threshold>{
+            {Level::WARNING, Direction::LOW, 20.0},
+            {Level::WARNING, Direction::HIGH, 80.0}});
+    thresholds::ThresholdTimer timer(io);
+    const thresholds::Threshold& low = sensor->thresholds[0];
+
+    // A low reading only starts the delay
+    sensor->value = 10.0;
+    thresholds::checkThresholdsPowerDelay(sensor, timer);
+    EXPECT_FALSE(sensor->alarm(Level::WARNING, Direction::LOW));
+    EXPECT_TRUE(timer.hasActiveTimer(low, true));
+
+    // Recovering before the delay ran out cancels the pending assertion
+    sensor->value = 30.0;
+    thresholds::checkThresholdsPowerDelay(sensor, timer);
+    settle();
+    EXPECT_FALSE(timer.hasActiveTimer(low, true));
+    EXPECT_FALSE(sensor->alarm(Level::WARNING, Direction::LOW));
+
+    // High alarms are not delayed
+    sensor->value = 85.0;
+    thresholds::checkThresholdsPowerDelay(sensor, timer);
+    EXPECT_TRUE(sensor->alarm(Level::WARNING, Direction::HIGH));
+}
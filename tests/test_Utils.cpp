@@ -1,12 +1,16 @@
 #include "Utils.hpp"
 
+#include <boost/container/flat_map.hpp>
+
 #include <array>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <new>
 #include <string>
 #include <vector>
@@ -242,3 +246,54 @@ TEST(GetDeviceBusAddrTest, AllValid)
     EXPECT_EQ(bus, 12);
     EXPECT_EQ(addr, 0xaf);
 }
+
+TEST(RemoveDeviceSensorsTest, OnlyActiveSensorsOfTheDevice)
+{
+    struct FakeSensor
+    {
+        std::string path;
+        bool active = true;
+
+        bool isActive() const
+        {
+            return active;
+        }
+        const std::string& getPath() const
+        {
+            return path;
+        }
+    };
+    const std::string hwmon = "/sys/class/hwmon/hwmon1";
+
+    boost::container::flat_map<std::string, std::shared_ptr<FakeSensor>>
+        sensors;
+    sensors["in1"] = std::make_shared<FakeSensor>(hwmon + "/in1_input");
+    sensors["curr1"] = std::make_shared<FakeSensor>(hwmon + "/curr1_input");
+    sensors["off"] = std::make_shared<FakeSensor>(hwmon + "/in2_input", false);
+    sensors["other"] =
+        std::make_shared<FakeSensor>("/sys/class/hwmon/hwmon10/in1_input");
+    sensors["none"] = nullptr;
+
+    EXPECT_EQ(removeDeviceSensors(sensors, hwmon), 2U);
+    EXPECT_FALSE(sensors.contains("in1"));
+    EXPECT_FALSE(sensors.contains("curr1"));
+    EXPECT_TRUE(sensors.contains("off"));
+    EXPECT_TRUE(sensors.contains("other"));
+    EXPECT_TRUE(sensors.contains("none"));
+
+    // A second uevent for the same device finds nothing left to remove
+    EXPECT_EQ(removeDeviceSensors(sensors, hwmon), 0U);
+}
+
+TEST(BackoffDelayTest, DoublesUpToCap)
+{
+    using std::chrono::milliseconds;
+    EXPECT_EQ(backoffDelay(1, milliseconds(500), milliseconds(16000)),
+              milliseconds(500));
+    EXPECT_EQ(backoffDelay(2, milliseconds(500), milliseconds(16000)),
+              milliseconds(1000));
+    EXPECT_EQ(backoffDelay(5, milliseconds(500), milliseconds(16000)),
+              milliseconds(8000));
+    EXPECT_EQ(backoffDelay(50, milliseconds(500), milliseconds(16000)),
+              milliseconds(16000));
+}
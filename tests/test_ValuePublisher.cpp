@@ -0,0 +1,143 @@
+#include "Utils.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+class ValuePublisherTest : public testing::Test
+{
+  public:
+    // Feeds a reading taken the given time after the first one
+    bool update(double reading, std::chrono::seconds at)
+    {
+        return publisher.update(policy, 0.01, reading, start + at);
+    }
+
+    PublishPolicy policy;
+    ValuePublisher publisher;
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+};
+
+} // namespace
+
+TEST(GetPublishPolicyTest, Defaults)
+{
+    PublishPolicy policy = getPublishPolicy(SensorBaseConfigMap{});
+    EXPECT_TRUE(std::isnan(policy.deadband));
+    EXPECT_EQ(policy.relativeDeadband, 0.0);
+    EXPECT_EQ(policy.minInterval.count(), 0);
+    EXPECT_EQ(policy.heartbeat.count(), 0);
+}
+
+TEST(GetPublishPolicyTest, AllSet)
+{
+    SensorBaseConfigMap cfg;
+    cfg["PublishDeadband"] = 0.5;
+    cfg["PublishDeadbandPercent"] = 2.0;
+    cfg["PublishMinInterval"] = 1.5;
+    cfg["PublishHeartbeat"] = uint64_t{30};
+
+    PublishPolicy policy = getPublishPolicy(cfg);
+    EXPECT_EQ(policy.deadband, 0.5);
+    EXPECT_DOUBLE_EQ(policy.relativeDeadband, 0.02);
+    EXPECT_EQ(policy.minInterval.count(), 1500);
+    EXPECT_EQ(policy.heartbeat.count(), 30000);
+}
+
+TEST(GetPublishPolicyTest, InvalidIgnored)
+{
+    SensorBaseConfigMap cfg;
+    cfg["PublishDeadband"] = -1.0;
+    cfg["PublishMinInterval"] = 10.0;
+    cfg["PublishHeartbeat"] = 5.0;
+
+    PublishPolicy policy = getPublishPolicy(cfg);
+    EXPECT_TRUE(std::isnan(policy.deadband));
+    EXPECT_EQ(policy.minInterval.count(), 10000);
+    // A heartbeat is never shorter than the rate limit
+    EXPECT_EQ(policy.heartbeat.count(), 10000);
+}
+
+TEST_F(ValuePublisherTest, DeadbandSuppresses)
+{
+    policy.deadband = 1.0;
+    EXPECT_TRUE(update(10.0, std::chrono::seconds(0)));
+    EXPECT_FALSE(update(10.5, std::chrono::seconds(1)));
+    EXPECT_FALSE(update(9.0, std::chrono::seconds(2)));
+    EXPECT_DOUBLE_EQ(publisher.published, 10.0);
+    EXPECT_TRUE(update(11.5, std::chrono::seconds(3)));
+    EXPECT_DOUBLE_EQ(publisher.published, 11.5);
+
+    // Without a deadband of its own the sensor's default applies
+    policy.deadband = std::numeric_limits<double>::quiet_NaN();
+    EXPECT_FALSE(update(11.505, std::chrono::seconds(4)));
+    EXPECT_TRUE(update(11.52, std::chrono::seconds(5)));
+
+    policy.relativeDeadband = 0.1;
+    EXPECT_TRUE(update(100.0, std::chrono::seconds(6)));
+    EXPECT_FALSE(update(109.0, std::chrono::seconds(7)));
+    EXPECT_TRUE(update(111.0, std::chrono::seconds(8)));
+}
+
+TEST_F(ValuePublisherTest, MinIntervalHoldsChange)
+{
+    policy.deadband = 1.0;
+    policy.minInterval = std::chrono::seconds(5);
+    EXPECT_TRUE(update(10.0, std::chrono::seconds(0)));
+    EXPECT_FALSE(update(12.0, std::chrono::seconds(1)));
+    EXPECT_FALSE(update(12.0, std::chrono::seconds(4)));
+    EXPECT_DOUBLE_EQ(publisher.published, 10.0);
+    EXPECT_TRUE(update(12.0, std::chrono::seconds(5)));
+    EXPECT_DOUBLE_EQ(publisher.published, 12.0);
+    // The interval restarts from that publish
+    EXPECT_FALSE(update(14.0, std::chrono::seconds(6)));
+    EXPECT_TRUE(update(14.0, std::chrono::seconds(10)));
+}
+
+TEST_F(ValuePublisherTest, ReturnIntoDeadbandNotPublished)
+{
+    policy.deadband = 1.0;
+    policy.minInterval = std::chrono::seconds(5);
+    EXPECT_TRUE(update(10.0, std::chrono::seconds(0)));
+    EXPECT_FALSE(update(12.0, std::chrono::seconds(1)));
+    // Back within the deadband by the time minInterval passed
+    EXPECT_FALSE(update(10.5, std::chrono::seconds(6)));
+    EXPECT_FALSE(update(10.5, std::chrono::seconds(7)));
+    EXPECT_DOUBLE_EQ(publisher.published, 10.0);
+}
+
+TEST_F(ValuePublisherTest, HeartbeatRepublishes)
+{
+    policy.deadband = 1.0;
+    policy.heartbeat = std::chrono::seconds(10);
+    EXPECT_TRUE(update(10.0, std::chrono::seconds(0)));
+    EXPECT_FALSE(update(10.0, std::chrono::seconds(5)));
+    EXPECT_TRUE(update(10.2, std::chrono::seconds(10)));
+    EXPECT_DOUBLE_EQ(publisher.published, 10.2);
+    EXPECT_FALSE(update(10.2, std::chrono::seconds(19)));
+    EXPECT_TRUE(update(10.2, std::chrono::seconds(20)));
+
+    // Any publish restarts the heartbeat
+    EXPECT_TRUE(update(15.0, std::chrono::seconds(25)));
+    EXPECT_FALSE(update(15.0, std::chrono::seconds(34)));
+    EXPECT_TRUE(update(15.0, std::chrono::seconds(35)));
+}
+
+TEST_F(ValuePublisherTest, NanTransitionsPublishImmediately)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    policy.deadband = 1.0;
+    policy.minInterval = std::chrono::seconds(5);
+    EXPECT_TRUE(update(10.0, std::chrono::seconds(0)));
+    EXPECT_TRUE(update(nan, std::chrono::seconds(1)));
+    EXPECT_TRUE(std::isnan(publisher.published));
+    EXPECT_FALSE(update(nan, std::chrono::seconds(7)));
+    EXPECT_TRUE(update(10.0, std::chrono::seconds(8)));
+    EXPECT_DOUBLE_EQ(publisher.published, 10.0);
+}